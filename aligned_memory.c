@@ -0,0 +1,58 @@
+/**************************************************************************************************
+* aligned_memory.c: Innehller funktionsdefinitioner som anvnds fr allokering av minnesblock
+*                   justerade mot cacheradsgrnser.
+**************************************************************************************************/
+#include "aligned_memory.h"
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+/**************************************************************************************************
+* aligned_memory_alloc: Returnerar en pekare till ett nytt minnesblock av angiven storlek, vars
+*                       startadress r justerad mot ALIGNED_MEMORY_ALIGNMENT. Storleken avrundas
+*                       uppt till en jmn multipel av justeringen. Vid misslyckad allokering
+*                       returneras null.
+*
+*                       - size: Minnesblockets storlek i byte.
+**************************************************************************************************/
+void* aligned_memory_alloc(const size_t size)
+{
+   const size_t alignment = ALIGNED_MEMORY_ALIGNMENT;
+   const size_t rounded_size = size ? (size + alignment - 1) / alignment * alignment : alignment;
+#ifdef _WIN32
+   return _aligned_malloc(rounded_size, alignment);
+#else
+   return aligned_alloc(alignment, rounded_size);
+#endif
+}
+
+/**************************************************************************************************
+* aligned_memory_free: Frigr minnesblock allokerat via aligned_memory_alloc.
+*
+*                      - block: Pekare till minnesblocket (null ignoreras).
+**************************************************************************************************/
+void aligned_memory_free(void* block)
+{
+#ifdef _WIN32
+   _aligned_free(block);
+#else
+   free(block);
+#endif
+   return;
+}
+
+/**************************************************************************************************
+* aligned_memory_stride: Returnerar angivet antal element avrundat uppt s att en rad med
+*                        motsvarande antal element fyller ett helt antal cacherader. Anvnds som
+*                        radavstnd i matriser s att varje rad brjar p en justerad adress.
+*
+*                        - num_elements: Antalet element per rad.
+*                        - element_size: Storleken p varje element i byte.
+**************************************************************************************************/
+size_t aligned_memory_stride(const size_t num_elements,
+                             const size_t element_size)
+{
+   const size_t elements_per_line = ALIGNED_MEMORY_ALIGNMENT / element_size;
+   return (num_elements + elements_per_line - 1) / elements_per_line * elements_per_line;
+}
@@ -0,0 +1,21 @@
+/**************************************************************************************************
+* aligned_memory.h: Innehller funktionalitet fr allokering av minnesblock som r justerade
+*                   mot cacheradsgrnser, vilket anvnds fr sammanhngande parameterblock i
+*                   neurala ntverk.
+**************************************************************************************************/
+#ifndef ALIGNED_MEMORY_H_
+#define ALIGNED_MEMORY_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+
+/* Makrodefinitioner: */
+#define ALIGNED_MEMORY_ALIGNMENT 64 /* Justering i byte, motsvarar en cacherad. */
+
+/* Externa funktioner: */
+void* aligned_memory_alloc(const size_t size);
+void aligned_memory_free(void* block);
+size_t aligned_memory_stride(const size_t num_elements,
+                             const size_t element_size);
+
+#endif /* ALIGNED_MEMORY_H_ */
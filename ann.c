@@ -3,16 +3,92 @@
 **************************************************************************************************/
 #include "ann.h"
 
+/**************************************************************************************************
+* ann_worker: Tillstnd fr en trd vid flertrdad trning via funktionen ann_train_threaded.
+*             Varje trd har ett eget arbetsminne samt en egen del av trningsuppsttningarnas
+*             ordningsfljd, medan ntverkets parametrar delas mellan samtliga trdar.
+**************************************************************************************************/
+struct ann_worker
+{
+   struct ann* ann;        /* Pekare till det neurala ntverket som trnas. */
+   struct ann_batch batch; /* Trdens arbetsminne. */
+   size_t position;        /* Trdens frsta position i ordningsfljden. */
+   size_t num_sets;        /* Antalet trningsuppsttningar fr trden. */
+   double learning_rate;   /* Lrhastigheten. */
+   thrd_t thread;          /* Trden som trningen genomfrs i. */
+   bool started;           /* Indikerar ifall en separat trd har startats. */
+};
+
+/**************************************************************************************************
+* ann_predict_task: Tillstnd fr en trd vid batchvis prediktion via funktionerna
+*                   ann_predict_batch samt ann_predict_matrix. Varje trd berknar utsignaler
+*                   fr ett sammanhngande intervall av rader med ett eget arbetsminne.
+*                   Indata lses antingen frn en tvdimensionell vektor eller frn en matris.
+**************************************************************************************************/
+struct ann_predict_task
+{
+   const struct ann* ann;                 /* Pekare till det neurala ntverket. */
+   const struct double_2d_vector* inputs; /* Indata lagrad som vektorer (eller null). */
+   const double* matrix;                  /* Indata lagrad radvis i en matris (eller null). */
+   double* output;                        /* Flt som utsignalerna skrivs till, radvis. */
+   size_t begin;                          /* Index fr trdens frsta rad. */
+   size_t end;                            /* Index direkt efter trdens sista rad. */
+   int error;                             /* Indikerar ifall arbetsminnet inte kunde allokeras. */
+   thrd_t thread;                         /* Trden som prediktionen genomfrs i. */
+   bool started;                          /* Indikerar ifall en separat trd har startats. */
+};
+
 /* Statiska funktioner: */
 static void ann_feedforward(struct ann* self, 
                             const struct double_vector* input);
-static void ann_backpropagate(struct ann* self, 
-                              const struct double_vector* reference);
-static void ann_optimize(struct ann* self,
-                         const double learning_rate);
+static void ann_feedforward_layers(struct ann* self);
+static void ann_backpropagate_optimize(struct ann* self,
+                                      const double learning_rate);
+static void ann_train_sparse(struct ann* self,
+                             const size_t num_epochs,
+                             const double learning_rate);
+static void ann_feedforward_sparse(struct ann* self,
+                                   const uint32_t* indices,
+                                   const double* values,
+                                   const size_t size);
+static void ann_backpropagate_optimize_sparse(struct ann* self,
+                                              const uint32_t* indices,
+                                              const double* values,
+                                              const size_t size,
+                                              const double learning_rate);
 static void print_line(const struct double_vector* self, 
                        FILE* ostream, 
                        const double threshold);
+static void print_value(const double value, 
+                        FILE* ostream, 
+                        const double threshold);
+static void ann_train_rows(struct ann* self,
+                           struct ann_batch* batch,
+                           const size_t position,
+                           const size_t num_rows,
+                           const double learning_rate);
+static int ann_worker_run(void* arg);
+static double get_time(void);
+static int ann_predict_rows(const struct ann* self,
+                            const struct double_2d_vector* inputs,
+                            const double* matrix,
+                            const size_t num_rows,
+                            double* output,
+                            const size_t num_threads);
+static int ann_predict_task_run(void* arg);
+static void load_column(ann_real* destination,
+                        const size_t stride,
+                        const double* source,
+                        const size_t source_size,
+                        const size_t num_rows);
+static void copy_row(ann_real* destination, 
+                     const struct double_vector* source, 
+                     const size_t size);
+static void copy_rows(ann_real* destination,
+                      const size_t stride,
+                      const ann_real* source,
+                      const size_t num_rows,
+                      const size_t num_columns);
 
 /**************************************************************************************************
 * ann_new: Initierar angivet neuralt ntverk. Vid start allokeras minne fr ett enda dolt lager,
@@ -31,7 +107,10 @@ void ann_new(struct ann* self,
 {
    self->num_inputs = num_inputs;
    self->num_outputs = num_outputs;
-   self->input_layer = 0;
+   self->input_layer = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * num_inputs);
+   self->reference = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * num_outputs);
+   mapped_file_new(&self->model_file);
+   embedding_layer_new(&self->embedding, 0, 0);
 
    dense_layer_new(&self->output_layer, self->num_outputs, num_hidden);
    training_data_new(&self->training_data, self->num_inputs, self->num_outputs);
@@ -50,9 +129,14 @@ void ann_delete(struct ann* self)
 {
    dense_layer_delete(&self->output_layer);
    dense_layer_vector_delete(&self->hidden_layers);
+   embedding_layer_delete(&self->embedding);
    training_data_delete(&self->training_data);
+   aligned_memory_free(self->input_layer);
+   aligned_memory_free(self->reference);
+   mapped_file_close(&self->model_file);
 
    self->input_layer = 0;
+   self->reference = 0;
    self->num_inputs = 0;
    self->num_outputs = 0;
    return;
@@ -138,6 +222,61 @@ int ann_add_hidden_layers(struct ann* self,
    }
 }
 
+/**************************************************************************************************
+* ann_set_embedding_layer: Lgger till ett inbddningslager med angiven dimension mellan
+*                          ingngslagret och det frsta dolda lagret i angivet neuralt ntverk,
+*                          dr varje insignal utgr en kategori. Ett befintligt inbddningslager
+*                          erstts. Det frsta dolda lagret fr en vikt per element i
+*                          inbddningen i stllet fr en per insignal, vilket innebr att en
+*                          kategori kostar en hmtning av en rad i stllet fr en skalrprodukt
+*                          ver samtliga insignaler per nod. Kategorierna passeras lmpligen som
+*                          gles indata med vrdet ett, via ann_predict_sparse respektive gles
+*                          trningsdata. Tt indata stds av ann_predict och ann_train, medan
+*                          batchvis trning och prediktion samt ann_save inte stder
+*                          inbddningslager och d returnerar 1. Vid misslyckad
+*                          minnesallokering eller dimensionen noll returneras 1, annars 0.
+*
+*                          - self     : Pekare till det neurala ntverket.
+*                          - dimension: Antalet element per inbddning.
+**************************************************************************************************/
+int ann_set_embedding_layer(struct ann* self,
+                            const size_t dimension)
+{
+   struct dense_layer* first = dense_layer_vector_begin(&self->hidden_layers);
+   if (!dimension) return 1;
+
+   embedding_layer_delete(&self->embedding);
+   if (embedding_layer_new(&self->embedding, self->num_inputs, dimension)) return 1;
+   dense_layer_resize(first, first->num_nodes, dimension);
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_set_weight_format: Vljer format fr vikterna som lses vid feedforward i samtliga dolda
+*                        lager samt det yttre lagret i angivet neuralt ntverk, se
+*                        dense_layer_set_format. Vid fp16 eller bf16 lser ann_predict samt
+*                        ann_train vikterna komprimerat med 16 bitar per vikt, medan vikterna av
+*                        typen ann_real behlls som huvudkopia vid trning och lagring. Formatet
+*                        gller befintliga lager, s funktionen anropas lmpligen efter att
+*                        samtliga lager har lagts till eller efter inlsning via ann_load. Vid
+*                        misslyckad minnesallokering returneras 1, annars 0.
+*
+*                        - self  : Pekare till det neurala ntverket.
+*                        - format: Format fr vikterna som lses vid feedforward.
+**************************************************************************************************/
+int ann_set_weight_format(struct ann* self,
+                          const enum dense_layer_format format)
+{
+   int error = dense_layer_set_format(&self->output_layer, format);
+
+   for (struct dense_layer* i = dense_layer_vector_begin(&self->hidden_layers);
+        i < dense_layer_vector_end(&self->hidden_layers); ++i)
+   {
+      error |= dense_layer_set_format(i, format);
+   }
+   return error;
+}
+
 /**************************************************************************************************
 * ann_load_training_data: Lser in trningsdata till angivet neuralt ntverk frn en fil.
 *               
@@ -171,9 +310,10 @@ void ann_set_training_data(struct ann* self,
 * ann_train: Trnar angivet neuralt ntverk angivet antal epoker. Infr varje epok randomiseras
 *            ordningen p trningsuppsttningarna. Drefter genomfrs en feedforward fr att 
 *            uppdatera utsignalerna i varje lager. Drefter genomfrs en backprop fr att berkna 
-*            avvikelser i hela ntverket. Slutligen sker optimering i syfte att minska uppmtta
-*            avvikelser. Drmed justeras bias samt vikter i ntverket fr att minimera avvikelser
-*            och drigenom frbttrad precision vid prediktion.
+*            avvikelser i hela ntverket, dr optimering i syfte att minska uppmtta avvikelser
+*            sker lager fr lager i samma svep. Drmed justeras bias samt vikter i ntverket fr
+*            att minimera avvikelser och drigenom frbttrad precision vid prediktion. Ifall
+*            trningsdatan lagrar gles indata trnas ntverket via ann_train_sparse.
 * 
 *            - self         : Pekare till det neurala ntverket.
 *            - num_epochs   : Antalet epoker/omgng trning som skall genomfras.
@@ -183,35 +323,367 @@ void ann_train(struct ann* self,
                const size_t num_epochs,
                const double learning_rate)
 {
+   if (training_data_is_sparse(&self->training_data))
+   {
+      ann_train_sparse(self, num_epochs, learning_rate);
+      return;
+   }
+
    for (size_t i = 0; i < num_epochs; ++i)
    {
       training_data_shuffle(&self->training_data);
       for (size_t j = 0; j < self->training_data.sets; ++j)
       {
-         const size_t k = self->training_data.order.data[j];
-         const struct double_vector* input = &self->training_data.in.data[k];
-         const struct double_vector* reference = &self->training_data.out.data[k];
-
-         ann_feedforward(self, input);
-         ann_backpropagate(self, reference);
-         ann_optimize(self, learning_rate);
+         training_data_gather(&self->training_data, j, 1, self->input_layer, self->num_inputs,
+                              self->reference, self->num_outputs);
+         ann_feedforward_layers(self);
+         ann_backpropagate_optimize(self, learning_rate);
       }
    }
    return;
 }
 
+/**************************************************************************************************
+* ann_train_batched: Trnar angivet neuralt ntverk angivet antal epoker via minibatcher.
+*                    Infr varje epok randomiseras ordningen p trningsuppsttningarna, som
+*                    sedan delas upp i batcher av angiven storlek. Varje batch kopieras till ett
+*                    sammanhngande flt och passeras genom samtliga lager som en matris, dr
+*                    avvikelser berknas fr hela batchen innan en enda justering av bias och
+*                    vikter genomfrs utifrn medelvrdet av batchens gradienter. Returnerar 0
+*                    vid lyckad trning, annars 1 (vid ogiltig batchstorlek eller ifall minne
+*                    fr arbetsminnet inte kunde allokeras).
+* 
+*                    - self         : Pekare till det neurala ntverket.
+*                    - num_epochs   : Antalet epoker/omgng trning som skall genomfras.
+*                    - learning_rate: Lrhastigheten, avgr justeringsgraden vid avvikelse.
+*                    - batch_size   : Antalet trningsuppsttningar per batch.
+**************************************************************************************************/
+int ann_train_batched(struct ann* self,
+                      const size_t num_epochs,
+                      const double learning_rate,
+                      const size_t batch_size)
+{
+   struct ann_batch batch;
+   if (!batch_size || !self->hidden_layers.size) return 1;
+
+   if (ann_batch_new(&batch, &self->hidden_layers, self->num_inputs, self->num_outputs, 
+                     batch_size))
+   {
+      return 1;
+   }
+
+   for (size_t i = 0; i < num_epochs; ++i)
+   {
+      training_data_shuffle(&self->training_data);
+
+      for (size_t j = 0; j < self->training_data.sets; j += batch_size)
+      {
+         const size_t remaining = self->training_data.sets - j;
+         const size_t num_rows = remaining < batch_size ? remaining : batch_size;
+         ann_train_rows(self, &batch, j, num_rows, learning_rate);
+      }
+   }
+
+   ann_batch_delete(&batch);
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_train_threaded: Trnar angivet neuralt ntverk angivet antal epoker via angivet antal
+*                     trdar enligt Hogwild-principen. Infr varje epok randomiseras ordningen
+*                     p trningsuppsttningarna, som sedan delas upp i lika stora delar, en per
+*                     trd. Varje trd genomfr feedforward, backpropagation samt optimering fr
+*                     en uppsttning i taget med ett eget arbetsminne fr utsignaler och
+*                     avvikelser, men samtliga trdar justerar ntverkets gemensamma bias och
+*                     vikter direkt utan ls. Enstaka uppdateringar kan drmed skrivas ver av
+*                     andra trdar, vilket i praktiken har frsumbar inverkan p trningen d
+*                     varje uppdatering r liten. Med en enda trd motsvarar trningen ann_train.
+*
+*                     Ifall en utstrm anges skrivs antalet trdar, trningstiden samt
+*                     genomstrmningen i antal trningsuppsttningar per sekund ut efter
+*                     genomfrd trning. Returnerar 0 vid lyckad trning, annars 1 (vid ogiltigt
+*                     antal trdar eller ifall minne fr arbetsminnet inte kunde allokeras).
+*
+*                     - self         : Pekare till det neurala ntverket.
+*                     - num_epochs   : Antalet epoker/omgng trning som skall genomfras.
+*                     - learning_rate: Lrhastigheten, avgr justeringsgraden vid avvikelse.
+*                     - num_threads  : Antalet trdar som trningen skall frdelas p.
+*                     - ostream      : Pekare till utstrm fr rapportering (0 = ingen utskrift).
+**************************************************************************************************/
+int ann_train_threaded(struct ann* self,
+                       const size_t num_epochs,
+                       const double learning_rate,
+                       const size_t num_threads,
+                       FILE* ostream)
+{
+   struct ann_worker* workers = 0;
+   double start_time = 0.0;
+   int error = 0;
+
+   if (!num_threads || !self->hidden_layers.size) return 1;
+   workers = (struct ann_worker*)calloc(num_threads, sizeof(struct ann_worker));
+   if (!workers) return 1;
+
+   for (size_t i = 0; i < num_threads && !error; ++i)
+   {
+      workers[i].ann = self;
+      workers[i].learning_rate = learning_rate;
+      error = ann_batch_new(&workers[i].batch, &self->hidden_layers, self->num_inputs, 
+                            self->num_outputs, 1);
+   }
+
+   start_time = get_time();
+
+   for (size_t i = 0; i < num_epochs && !error; ++i)
+   {
+      training_data_shuffle(&self->training_data);
+
+      for (size_t j = 0; j < num_threads; ++j)
+      {
+         const size_t begin = self->training_data.sets * j / num_threads;
+         const size_t end = self->training_data.sets * (j + 1) / num_threads;
+         workers[j].position = begin;
+         workers[j].num_sets = end - begin;
+         workers[j].started = j > 0 && 
+            thrd_create(&workers[j].thread, ann_worker_run, &workers[j]) == thrd_success;
+      }
+
+      for (size_t j = 0; j < num_threads; ++j)
+      {
+         if (workers[j].started)
+         {
+            thrd_join(workers[j].thread, 0);
+         }
+         else
+         {
+            ann_worker_run(&workers[j]);
+         }
+      }
+   }
+
+   if (ostream && !error)
+   {
+      const double elapsed_time = get_time() - start_time;
+      const double num_samples = (double)num_epochs * self->training_data.sets;
+      fprintf(ostream, "Threads: %zu, samples: %.0f, time: %g s, throughput: %g samples/s\n",
+              num_threads, num_samples, elapsed_time, 
+              elapsed_time > 0.0 ? num_samples / elapsed_time : 0.0);
+   }
+
+   for (size_t i = 0; i < num_threads; ++i)
+   {
+      ann_batch_delete(&workers[i].batch);
+   }
+
+   free(workers);
+   return error;
+}
+
+/**************************************************************************************************
+* ann_train_staged: Trnar angivet neuralt ntverk angivet antal epoker via minibatcher p samma
+*                   stt som ann_train_batched, men dr varje epoks trningsuppsttningar frst
+*                   kopieras i randomiserad ordning till en sammanhngande buffert. Bufferten
+*                   fr nsta epok fylls i en bakgrundstrd medan aktuell epok trnas, s att
+*                   trningen lser raderna sekventiellt i stllet fr att hmta varje rad frn
+*                   en slumpmssig position i trningsdatan. Lmpar sig fr trningsdata som r
+*                   mycket strre n cacheminnet, men krver minne fr tv extra kopior av
+*                   trningsdatan. Vid en batchstorlek p 1 motsvarar trningen ann_train.
+*                   Returnerar 0 vid lyckad trning, annars 1 (vid ogiltig batchstorlek eller
+*                   ifall minne fr buffertarna eller arbetsminnet inte kunde allokeras).
+*
+*                   - self         : Pekare till det neurala ntverket.
+*                   - num_epochs   : Antalet epoker/omgng trning som skall genomfras.
+*                   - learning_rate: Lrhastigheten, avgr justeringsgraden vid avvikelse.
+*                   - batch_size   : Antalet trningsuppsttningar per batch.
+**************************************************************************************************/
+int ann_train_staged(struct ann* self,
+                     const size_t num_epochs,
+                     const double learning_rate,
+                     const size_t batch_size)
+{
+   struct ann_batch batch;
+   struct epoch_buffer buffer;
+   const ann_real* in = 0;
+   const ann_real* out = 0;
+   if (!batch_size || !self->hidden_layers.size) return 1;
+
+   if (ann_batch_new(&batch, &self->hidden_layers, self->num_inputs, self->num_outputs, 
+                     batch_size))
+   {
+      return 1;
+   }
+   if (epoch_buffer_new(&buffer, &self->training_data, num_epochs))
+   {
+      ann_batch_delete(&batch);
+      return 1;
+   }
+
+   while (!epoch_buffer_next(&buffer, &in, &out))
+   {
+      for (size_t j = 0; j < self->training_data.sets; j += batch_size)
+      {
+         const size_t remaining = self->training_data.sets - j;
+         const size_t num_rows = remaining < batch_size ? remaining : batch_size;
+
+         copy_rows(batch.input, batch.input_stride, in + j * self->num_inputs, num_rows, 
+                   self->num_inputs);
+         copy_rows(batch.reference, batch.reference_stride, out + j * self->num_outputs, 
+                   num_rows, self->num_outputs);
+         ann_batch_train(&batch, &self->hidden_layers, &self->output_layer, num_rows, 
+                         learning_rate);
+      }
+   }
+
+   epoch_buffer_delete(&buffer);
+   ann_batch_delete(&batch);
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_train_pipelined: Trnar angivet neuralt ntverk angivet antal epoker via minibatcher p
+*                      samma stt som ann_train_batched, men dr randomisering av ordningen samt
+*                      kopiering av trningsuppsttningarna till batcher skts av en separat
+*                      producenttrd. Producenten fyller en begrnsad k med upp till
+*                      BATCH_QUEUE_NUM_SLOTS trningsklara batcher, medan trningsloopen enbart
+*                      hmtar batcher ur kn. Drmed verlappar datahanteringen med
+*                      berkningarna. Returnerar 0 vid lyckad trning, annars 1 (vid ogiltig
+*                      batchstorlek eller ifall minne fr kn eller arbetsminnet inte kunde
+*                      allokeras).
+*
+*                      - self         : Pekare till det neurala ntverket.
+*                      - num_epochs   : Antalet epoker/omgng trning som skall genomfras.
+*                      - learning_rate: Lrhastigheten, avgr justeringsgraden vid avvikelse.
+*                      - batch_size   : Antalet trningsuppsttningar per batch.
+**************************************************************************************************/
+int ann_train_pipelined(struct ann* self,
+                        const size_t num_epochs,
+                        const double learning_rate,
+                        const size_t batch_size)
+{
+   struct ann_batch batch;
+   struct batch_queue queue;
+   size_t num_rows = 0;
+   if (!batch_size || !self->hidden_layers.size) return 1;
+
+   if (ann_batch_new(&batch, &self->hidden_layers, self->num_inputs, self->num_outputs, 
+                     batch_size))
+   {
+      return 1;
+   }
+   if (batch_queue_new(&queue, &self->training_data, &batch, BATCH_QUEUE_NUM_SLOTS, 
+                       num_epochs))
+   {
+      ann_batch_delete(&batch);
+      return 1;
+   }
+
+   while (!batch_queue_pop(&queue, &batch, &num_rows))
+   {
+      ann_batch_train(&batch, &self->hidden_layers, &self->output_layer, num_rows, 
+                      learning_rate);
+   }
+
+   batch_queue_delete(&queue);
+   ann_batch_delete(&batch);
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_train_streamed: Trnar angivet neuralt ntverk angivet antal epoker via minibatcher med
+*                     trningsdata som lses strmmande frn angiven klla i stllet fr frn
+*                     ntverkets trningsdatabehllare. Drmed kan trningsdatan vara betydligt
+*                     strre n minnet. Varje epok lser hela filen en gng, dr ordningen
+*                     randomiseras via kllans blandningsbuffert. Returnerar 0 vid lyckad
+*                     trning, annars 1 (vid ogiltig batchstorlek, fel vid lsning av filen
+*                     eller ifall minne fr arbetsminnet inte kunde allokeras).
+*
+*                     - self         : Pekare till det neurala ntverket.
+*                     - stream       : Pekare till den strmmande kllan med trningsdata.
+*                     - num_epochs   : Antalet epoker/omgng trning som skall genomfras.
+*                     - learning_rate: Lrhastigheten, avgr justeringsgraden vid avvikelse.
+*                     - batch_size   : Antalet trningsuppsttningar per batch.
+**************************************************************************************************/
+int ann_train_streamed(struct ann* self,
+                       struct training_stream* stream,
+                       const size_t num_epochs,
+                       const double learning_rate,
+                       const size_t batch_size)
+{
+   struct ann_batch batch;
+   size_t num_rows = 0;
+   int error = 0;
+
+   if (!batch_size || !self->hidden_layers.size) return 1;
+   if (stream->pool.num_inputs != self->num_inputs || 
+       stream->pool.num_outputs != self->num_outputs)
+   {
+      return 1;
+   }
+   if (ann_batch_new(&batch, &self->hidden_layers, self->num_inputs, self->num_outputs, 
+                     batch_size))
+   {
+      return 1;
+   }
+
+   for (size_t i = 0; i < num_epochs && !error; ++i)
+   {
+      training_stream_rewind(stream);
+
+      while (!(error = training_stream_read(stream, batch.input, batch.input_stride, 
+                                            batch.reference, batch.reference_stride, 
+                                            batch_size, &num_rows)) && num_rows)
+      {
+         ann_batch_train(&batch, &self->hidden_layers, &self->output_layer, num_rows, 
+                         learning_rate);
+      }
+   }
+
+   ann_batch_delete(&batch);
+   return error;
+}
+
 /**************************************************************************************************
 * ann_predict: Genomfr prediktion med angivet neuralt ntverk utifrn givna insignaler och 
 *              returnerar adressen till ett flt innehllande predikterade utsignaler.
+*              Utsignalerna lagras i ntverket, vilket medfr att funktionen inte kan anropas
+*              frn flera trdar samtidigt. Vid flertrdad prediktion anvnds i stllet en
+*              kontext per trd via funktionen ann_inference_ctx_predict. Vid ett
+*              inbddningslager hmtas enbart raderna fr insignaler skilda frn noll.
 * 
 *              - self : Pekare till det neurala ntverket.
 *              - input: Pekare till vektor innehllande indata till det neurala ntverket.
 **************************************************************************************************/
-double* ann_predict(struct ann* self, 
-                    const struct double_vector* input)
+ann_real* ann_predict(struct ann* self, 
+                      const struct double_vector* input)
 {
    ann_feedforward(self, input);
-   return self->output_layer.output.data;
+   return self->output_layer.output;
+}
+
+/**************************************************************************************************
+* ann_predict_sparse: Genomfr prediktion med angivet neuralt ntverk utifrn givna glesa
+*                     insignaler, dr enbart insignaler skilda frn noll lagras, och returnerar
+*                     adressen till ett flt innehllande predikterade utsignaler. Det frsta
+*                     dolda lagret hmtar enbart de viktkolumner som motsvarar insignalerna,
+*                     vilket vid breda och glesa insignaler r betydligt snabbare n
+*                     ann_predict. Vid ett inbddningslager utgr insignalernas index
+*                     kategorier, vars rader hmtas ur inbddningslagret. I vrigt fungerar
+*                     funktionen som ann_predict. Ifall ngot index inte understiger antalet
+*                     insignaler returneras null.
+*
+*                     - self : Pekare till det neurala ntverket.
+*                     - input: Pekare till gles vektor innehllande indata till ntverket.
+**************************************************************************************************/
+ann_real* ann_predict_sparse(struct ann* self,
+                             const struct sparse_vector* input)
+{
+   for (size_t i = 0; i < input->size; ++i)
+   {
+      if (input->indices[i] >= self->num_inputs) return 0;
+   }
+
+   ann_feedforward_sparse(self, input->indices, input->values, input->size);
+   return self->output_layer.output;
 }
 
 /**************************************************************************************************
@@ -240,16 +712,69 @@ void ann_predict_range(struct ann* self,
       print_line(i, ostream, threshold);
 
       fprintf(ostream, "Predicted output: ");
-      print_line(&self->output_layer.output, ostream, threshold);
+
+      for (size_t j = 0; j < self->num_outputs; ++j)
+      {
+         print_value(self->output_layer.output[j], ostream, threshold);
+      }
+
+      fprintf(ostream, "\n");
    }
 
    fprintf(ostream, "----------------------------------------------------------------------------\n\n");
    return;
 }
 
+/**************************************************************************************************
+* ann_predict_batch: Genomfr prediktion med angivet neuralt ntverk fr samtliga kombinationer
+*                    av insignaler i angiven tvdimensionell vektor och skriver predikterade
+*                    utsignaler radvis till ett flt som gs av anroparen, dr fltet mste rymma
+*                    inputs->size * num_outputs flyttal. Raderna bearbetas i batcher via
+*                    matris-matrismultiplikationer och kan frdelas p flera trdar. Ntverket
+*                    modifieras inte. Rader med frre insignaler n ntverkets ingngslager fylls
+*                    ut med nollor. Returnerar 0 vid lyckad prediktion, annars 1 (vid ogiltigt
+*                    antal trdar, ifall ntverket har ett inbddningslager eller ifall
+*                    arbetsminne inte kunde allokeras).
+*
+*                    - self       : Pekare till det neurala ntverket.
+*                    - inputs     : Pekare till tvdimensionell vektor innehllande indata.
+*                    - output     : Pekare till fltet som utsignalerna skall skrivas till.
+*                    - num_threads: Maximalt antal trdar som prediktionen frdelas p.
+**************************************************************************************************/
+int ann_predict_batch(const struct ann* self,
+                      const struct double_2d_vector* inputs,
+                      double* output,
+                      const size_t num_threads)
+{
+   return ann_predict_rows(self, inputs, 0, inputs->size, output, num_threads);
+}
+
+/**************************************************************************************************
+* ann_predict_matrix: Genomfr prediktion med angivet neuralt ntverk fr samtliga rader i en
+*                     matris med indata, lagrad radvis med num_inputs kolumner per rad, och
+*                     skriver predikterade utsignaler radvis till ett flt som gs av anroparen,
+*                     dr fltet mste rymma num_rows * num_outputs flyttal. I vrigt fungerar
+*                     funktionen som ann_predict_batch.
+*
+*                     - self       : Pekare till det neurala ntverket.
+*                     - inputs     : Pekare till matrisen innehllande indata.
+*                     - num_rows   : Antalet rader i matrisen.
+*                     - output     : Pekare till fltet som utsignalerna skall skrivas till.
+*                     - num_threads: Maximalt antal trdar som prediktionen frdelas p.
+**************************************************************************************************/
+int ann_predict_matrix(const struct ann* self,
+                       const double* inputs,
+                       const size_t num_rows,
+                       double* output,
+                       const size_t num_threads)
+{
+   return ann_predict_rows(self, 0, inputs, num_rows, output, num_threads);
+}
+
 /**************************************************************************************************
 * ann_feedforward: Berknar nya utsignaler fr samtliga noder i angivet neuralt ntverk via ny
-*                  indata till ntverkets ingngslager.
+*                  indata till ntverkets ingngslager. Indatan kopieras frst till
+*                  ingngslagret, dr den lagras med ntverkets flyttalstyp ann_real.
 * 
 *                  - self : Pekare till det neurala ntverket.
 *                  - input: Pekare till vektor innehllande indata till det neurala ntverket.
@@ -257,43 +782,430 @@ void ann_predict_range(struct ann* self,
 static void ann_feedforward(struct ann* self, 
                             const struct double_vector* input)
 {
-   const struct double_vector* hidden_output = &dense_layer_vector_last(&self->hidden_layers)->output;
    if (input->size < self->num_inputs) return;
+   copy_row(self->input_layer, input, self->num_inputs);
+   ann_feedforward_layers(self);
+   return;
+}
+
+/**************************************************************************************************
+* ann_feedforward_layers: Berknar nya utsignaler fr samtliga noder i angivet neuralt ntverk
+*                         utifrn den indata som redan finns lagrad i ingngslagret.
+* 
+*                         - self: Pekare till det neurala ntverket.
+**************************************************************************************************/
+static void ann_feedforward_layers(struct ann* self)
+{
+   const ann_real* hidden_output = dense_layer_vector_last(&self->hidden_layers)->output;
+
+   if (self->embedding.num_categories)
+   {
+      embedding_layer_feedforward_dense(&self->embedding, self->input_layer);
+      dense_layer_vector_feedforward(&self->hidden_layers, self->embedding.output);
+   }
+   else
+   {
+      dense_layer_vector_feedforward(&self->hidden_layers, self->input_layer);
+   }
 
-   self->input_layer = input;
-   dense_layer_vector_feedforward(&self->hidden_layers, self->input_layer);
    dense_layer_feedforward(&self->output_layer, hidden_output);
    return;
 }
 
 /**************************************************************************************************
-* ann_backpropagate: Berknar avvikelser fr samtliga noder i aktuellt neuralt ntverk utefter
-*                    angivna referensvrden frn trningsdatan.
-* 
-*                    - self     : Pekare till det neurala ntverket.
-*                    - reference: Referensvrden frn trningsdatan.
+* ann_feedforward_sparse: Berknar nya utsignaler fr samtliga noder i angivet neuralt ntverk
+*                         via gles indata, som passeras till inbddningslagret om ett sdant
+*                         finns, annars direkt till det frsta dolda lagret.
+*
+*                         - self   : Pekare till det neurala ntverket.
+*                         - indices: Pekare till den glesa indatans index.
+*                         - values : Pekare till den glesa indatans vrden.
+*                         - size   : Antalet element i den glesa indatan.
 **************************************************************************************************/
-static void ann_backpropagate(struct ann* self, 
-                              const struct double_vector* reference)
+static void ann_feedforward_sparse(struct ann* self,
+                                   const uint32_t* indices,
+                                   const double* values,
+                                   const size_t size)
 {
-   dense_layer_compare_with_reference(&self->output_layer, reference);
-   dense_layer_vector_backpropagate(&self->hidden_layers, &self->output_layer);
+   const ann_real* hidden_output = dense_layer_vector_last(&self->hidden_layers)->output;
+
+   if (self->embedding.num_categories)
+   {
+      embedding_layer_feedforward(&self->embedding, indices, values, size);
+      dense_layer_vector_feedforward(&self->hidden_layers, self->embedding.output);
+   }
+   else
+   {
+      dense_layer_vector_feedforward_sparse(&self->hidden_layers, indices, values, size);
+   }
+
+   dense_layer_feedforward(&self->output_layer, hidden_output);
    return;
 }
 
 /**************************************************************************************************
-* ann_optimize: Minimerar avvikelser i angivet neuralt ntverk genom att justera bias samt vikter
-*               fr samtliga noder. Angiven lrhastighet avgr justeringsgraden vid avvikelse.
+* ann_backpropagate_optimize: Berknar avvikelser fr samtliga noder i angivet neuralt ntverk
+*                             utefter referensvrdena frn trningsdatan, som redan finns
+*                             lagrade i fltet reference, och justerar samtidigt bias samt
+*                             vikter i syfte att minska avvikelserna. Varje lager berknar
+*                             fregende lagers avvikelser med sina vikter fre justeringen och
+*                             justerar sedan vikterna direkt, s att varje viktmatris enbart
+*                             lses en gng per trningsuppsttning.
 * 
-*               - self         : Pekare till det neurala ntverket.
-*               - learning_rate: Lrhastigheten, avgr justeringsgraden vid avvikelse.
+*                             - self         : Pekare till det neurala ntverket.
+*                             - learning_rate: Lrhastigheten, avgr justeringsgraden vid
+*                                              avvikelse.
+**************************************************************************************************/
+static void ann_backpropagate_optimize(struct ann* self,
+                                       const double learning_rate)
+{
+   dense_layer_compare_with_reference(&self->output_layer, self->reference);
+
+   if (self->embedding.num_categories)
+   {
+      dense_layer_vector_backpropagate_optimize_input(&self->hidden_layers, &self->output_layer,
+                                                      self->embedding.output,
+                                                      self->embedding.error, learning_rate);
+      embedding_layer_optimize_dense(&self->embedding, self->input_layer, learning_rate);
+   }
+   else
+   {
+      dense_layer_vector_backpropagate_optimize(&self->hidden_layers, &self->output_layer,
+                                                self->input_layer, learning_rate);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* ann_backpropagate_optimize_sparse: Motsvarar ann_backpropagate_optimize fr gles indata, dr
+*                                    enbart de vikter eller rader i inbddningslagret som
+*                                    motsvarar indatans element skilda frn noll justeras.
+*
+*                                    - self         : Pekare till det neurala ntverket.
+*                                    - indices      : Pekare till den glesa indatans index.
+*                                    - values       : Pekare till den glesa indatans vrden.
+*                                    - size         : Antalet element i den glesa indatan.
+*                                    - learning_rate: Lrhastigheten, avgr justeringsgraden
+*                                                     vid avvikelse.
 **************************************************************************************************/
-static void ann_optimize(struct ann* self,
-                         const double learning_rate)
+static void ann_backpropagate_optimize_sparse(struct ann* self,
+                                              const uint32_t* indices,
+                                              const double* values,
+                                              const size_t size,
+                                              const double learning_rate)
 {
-   const struct double_vector* hidden_output = &dense_layer_vector_last(&self->hidden_layers)->output;
-   dense_layer_optimize(&self->output_layer, hidden_output, learning_rate);
-   dense_layer_vector_optimize(&self->hidden_layers, self->input_layer, learning_rate);
+   dense_layer_compare_with_reference(&self->output_layer, self->reference);
+
+   if (self->embedding.num_categories)
+   {
+      dense_layer_vector_backpropagate_optimize_input(&self->hidden_layers, &self->output_layer,
+                                                      self->embedding.output,
+                                                      self->embedding.error, learning_rate);
+      embedding_layer_optimize(&self->embedding, indices, values, size, learning_rate);
+   }
+   else
+   {
+      dense_layer_vector_backpropagate_optimize_sparse(&self->hidden_layers, 
+                                                       &self->output_layer, indices, values,
+                                                       size, learning_rate);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* ann_train_sparse: Trnar angivet neuralt ntverk angivet antal epoker med gles indata p samma
+*                   stt som ann_train. Varje trningsuppsttnings glesa indata passeras direkt
+*                   till inbddningslagret eller det frsta dolda lagret, som enbart hmtar och
+*                   justerar de rader eller viktkolumner som motsvarar insignaler skilda frn
+*                   noll, i stllet fr att indatan skrivs ut till ingngslagret.
+*
+*                   - self         : Pekare till det neurala ntverket.
+*                   - num_epochs   : Antalet epoker/omgng trning som skall genomfras.
+*                   - learning_rate: Lrhastigheten, avgr justeringsgraden vid avvikelse.
+**************************************************************************************************/
+static void ann_train_sparse(struct ann* self,
+                             const size_t num_epochs,
+                             const double learning_rate)
+{
+   for (size_t i = 0; i < num_epochs; ++i)
+   {
+      training_data_shuffle(&self->training_data);
+      for (size_t j = 0; j < self->training_data.sets; ++j)
+      {
+         const uint32_t* indices = 0;
+         const double* values = 0;
+         size_t size = 0;
+
+         training_data_gather_sparse(&self->training_data, j, &indices, &values, &size,
+                                     self->reference);
+         ann_feedforward_sparse(self, indices, values, size);
+         ann_backpropagate_optimize_sparse(self, indices, values, size, learning_rate);
+      }
+   }
+   return;
+}
+
+/**************************************************************************************************
+* ann_train_rows: Genomfr ett trningssteg fr angivna trningsuppsttningar, som frst kopieras
+*                 till angivet arbetsminne.
+*
+*                 - self         : Pekare till det neurala ntverket.
+*                 - batch        : Pekare till arbetsminnet.
+*                 - position     : Position fr den frsta uppsttningen i ordningsfljden.
+*                 - num_rows     : Antalet trningsuppsttningar.
+*                 - learning_rate: Lrhastigheten, avgr justeringsgraden vid avvikelse.
+**************************************************************************************************/
+static void ann_train_rows(struct ann* self,
+                           struct ann_batch* batch,
+                           const size_t position,
+                           const size_t num_rows,
+                           const double learning_rate)
+{
+   training_data_gather(&self->training_data, position, num_rows, batch->input, 
+                        batch->input_stride, batch->reference, batch->reference_stride);
+   ann_batch_train(batch, &self->hidden_layers, &self->output_layer, num_rows, learning_rate);
+   return;
+}
+
+/**************************************************************************************************
+* ann_worker_run: Trnar det neurala ntverket med trdens trningsuppsttningar, en i taget.
+*                 Funktionen utgr startfunktion fr trdarna i ann_train_threaded och
+*                 returnerar alltid 0.
+*
+*                 - arg: Pekare till trdens tillstnd (struct ann_worker).
+**************************************************************************************************/
+static int ann_worker_run(void* arg)
+{
+   struct ann_worker* self = (struct ann_worker*)arg;
+
+   for (size_t i = 0; i < self->num_sets; ++i)
+   {
+      ann_train_rows(self->ann, &self->batch, self->position + i, 1, self->learning_rate);
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_predict_rows: Frdelar angivna rader med indata p angivet antal trdar, dr varje trd
+*                   bearbetar minst en hel batch. Den anropande trden bearbetar sjlv den
+*                   frsta delen. Ifall en trd inte kan startas bearbetas motsvarande del av
+*                   den anropande trden. Returnerar 0 vid lyckad prediktion, annars 1.
+*
+*                   - self       : Pekare till det neurala ntverket.
+*                   - inputs     : Indata lagrad som vektorer (eller null).
+*                   - matrix     : Indata lagrad radvis i en matris (eller null).
+*                   - num_rows   : Antalet rader med indata.
+*                   - output     : Pekare till fltet som utsignalerna skall skrivas till.
+*                   - num_threads: Maximalt antal trdar som prediktionen frdelas p.
+**************************************************************************************************/
+static int ann_predict_rows(const struct ann* self,
+                            const struct double_2d_vector* inputs,
+                            const double* matrix,
+                            const size_t num_rows,
+                            double* output,
+                            const size_t num_threads)
+{
+   const size_t num_batches = (num_rows + ANN_PREDICT_BATCH_SIZE - 1) / ANN_PREDICT_BATCH_SIZE;
+   const size_t num_tasks = num_threads < num_batches ? num_threads : num_batches;
+   struct ann_predict_task* tasks = 0;
+   int error = 0;
+
+   if (!num_threads || !self->hidden_layers.size || self->embedding.num_categories) return 1;
+   if (!num_rows) return 0;
+   tasks = (struct ann_predict_task*)calloc(num_tasks, sizeof(struct ann_predict_task));
+   if (!tasks) return 1;
+
+   for (size_t i = 0; i < num_tasks; ++i)
+   {
+      tasks[i].ann = self;
+      tasks[i].inputs = inputs;
+      tasks[i].matrix = matrix;
+      tasks[i].output = output;
+      tasks[i].begin = num_rows * i / num_tasks;
+      tasks[i].end = num_rows * (i + 1) / num_tasks;
+      tasks[i].started = i > 0 &&
+         thrd_create(&tasks[i].thread, ann_predict_task_run, &tasks[i]) == thrd_success;
+   }
+
+   for (size_t i = 0; i < num_tasks; ++i)
+   {
+      if (tasks[i].started)
+      {
+         thrd_join(tasks[i].thread, 0);
+      }
+      else
+      {
+         ann_predict_task_run(&tasks[i]);
+      }
+      error |= tasks[i].error;
+   }
+
+   free(tasks);
+   return error;
+}
+
+/**************************************************************************************************
+* ann_predict_task_run: Berknar utsignaler fr trdens rader, en batch i taget, och kopierar
+*                       dem till utsignalfltet. Inom varje batch lagras varje uppsttning som
+*                       en kolumn, s att samtliga lager kan berknas som matrisprodukter utan
+*                       horisontella summeringar. Utsignalerna frn varje lager skrivs vxelvis
+*                       till tv flt, vilket medfr att arbetsminnet r oberoende av antalet
+*                       lager. Funktionen utgr startfunktion fr trdarna i ann_predict_rows och
+*                       returnerar 0 vid lyckad prediktion, annars 1.
+*
+*                       - arg: Pekare till trdens tillstnd (struct ann_predict_task).
+**************************************************************************************************/
+static int ann_predict_task_run(void* arg)
+{
+   struct ann_predict_task* self = (struct ann_predict_task*)arg;
+   const struct ann* ann = self->ann;
+   const struct dense_layer_vector* hidden_layers = &ann->hidden_layers;
+   const size_t stride = aligned_memory_stride(ANN_PREDICT_BATCH_SIZE, sizeof(ann_real));
+   const ann_real* result = 0;
+   ann_real* input = 0;
+   ann_real* buffers[2] = { 0, 0 };
+   size_t max_nodes = ann->num_outputs;
+
+   for (size_t i = 0; i < hidden_layers->size; ++i)
+   {
+      if (hidden_layers->data[i].num_nodes > max_nodes)
+      {
+         max_nodes = hidden_layers->data[i].num_nodes;
+      }
+   }
+
+   input = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * ann->num_inputs * stride);
+   buffers[0] = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * max_nodes * stride);
+   buffers[1] = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * max_nodes * stride);
+   self->error = !input || !buffers[0] || !buffers[1];
+
+   for (size_t i = self->begin; i < self->end && !self->error; i += ANN_PREDICT_BATCH_SIZE)
+   {
+      const size_t remaining = self->end - i;
+      const size_t num_rows = 
+         remaining < ANN_PREDICT_BATCH_SIZE ? remaining : ANN_PREDICT_BATCH_SIZE;
+      const ann_real* layer_input = input;
+
+      for (size_t j = 0; j < num_rows; ++j)
+      {
+         if (self->inputs)
+         {
+            const struct double_vector* row = &self->inputs->data[i + j];
+            load_column(input + j, stride, row->data, row->size, ann->num_inputs);
+         }
+         else
+         {
+            const double* row = self->matrix + (i + j) * ann->num_inputs;
+            load_column(input + j, stride, row, ann->num_inputs, ann->num_inputs);
+         }
+      }
+
+      for (size_t j = 0; j < hidden_layers->size; ++j)
+      {
+         dense_layer_feedforward_columns(&hidden_layers->data[j], layer_input, stride, 
+                                         buffers[j % 2], stride, num_rows);
+         layer_input = buffers[j % 2];
+      }
+
+      result = buffers[hidden_layers->size % 2];
+      dense_layer_feedforward_columns(&ann->output_layer, layer_input, stride, 
+                                      buffers[hidden_layers->size % 2], stride, num_rows);
+
+      for (size_t j = 0; j < num_rows; ++j)
+      {
+         double* destination = self->output + (i + j) * ann->num_outputs;
+
+         for (size_t k = 0; k < ann->num_outputs; ++k)
+         {
+            destination[k] = result[k * stride + j];
+         }
+      }
+   }
+
+   aligned_memory_free(buffers[1]);
+   aligned_memory_free(buffers[0]);
+   aligned_memory_free(input);
+   return self->error;
+}
+
+/**************************************************************************************************
+* load_column: Kopierar en rad med indata till en kolumn i ett flt av typen ann_real. Ifall
+*              kllan innehller frre element n angivet antal rader fylls resterande element
+*              i kolumnen ut med nollor.
+*
+*              - destination: Pekare till kolumnens frsta element.
+*              - stride     : Avstndet mellan tv rader i destinationsfltet.
+*              - source     : Pekare till raden som skall kopieras.
+*              - source_size: Antalet element i kllraden.
+*              - num_rows   : Antalet rader som skall fyllas i destinationsfltet.
+**************************************************************************************************/
+static void load_column(ann_real* destination,
+                        const size_t stride,
+                        const double* source,
+                        const size_t source_size,
+                        const size_t num_rows)
+{
+   const size_t num_copied = source_size < num_rows ? source_size : num_rows;
+
+   for (size_t i = 0; i < num_copied; ++i)
+   {
+      destination[i * stride] = (ann_real)source[i];
+   }
+   for (size_t i = num_copied; i < num_rows; ++i)
+   {
+      destination[i * stride] = 0;
+   }
+   return;
+}
+
+/**************************************************************************************************
+* get_time: Returnerar aktuell tid i sekunder, anvnds fr mtning av trningstid.
+**************************************************************************************************/
+static double get_time(void)
+{
+   struct timespec time;
+   timespec_get(&time, TIME_UTC);
+   return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/**************************************************************************************************
+* copy_row: Kopierar angivet antal flyttal frn en vektor till ett flt av typen ann_real.
+*
+*           - destination: Pekare till fltet som flyttalen skall kopieras till.
+*           - source     : Pekare till vektorn som flyttalen skall kopieras frn.
+*           - size       : Antalet flyttal som skall kopieras.
+**************************************************************************************************/
+static void copy_row(ann_real* destination, 
+                     const struct double_vector* source, 
+                     const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      destination[i] = (ann_real)source->data[i];
+   }
+   return;
+}
+
+/**************************************************************************************************
+* copy_rows: Kopierar angivet antal rader frn en matris lagrad radvis utan utfyllnad till ett
+*            flt lagrat radvis med angivet radavstnd.
+*
+*            - destination: Pekare till fltet som raderna skall kopieras till.
+*            - stride     : Avstndet mellan tv rader i destinationsfltet.
+*            - source     : Pekare till den frsta raden som skall kopieras.
+*            - num_rows   : Antalet rader som skall kopieras.
+*            - num_columns: Antalet kolumner per rad.
+**************************************************************************************************/
+static void copy_rows(ann_real* destination,
+                      const size_t stride,
+                      const ann_real* source,
+                      const size_t num_rows,
+                      const size_t num_columns)
+{
+   for (size_t i = 0; i < num_rows; ++i)
+   {
+      memcpy(destination + i * stride, source + i * num_columns, sizeof(ann_real) * num_columns);
+   }
    return;
 }
 
@@ -309,16 +1221,32 @@ static void print_line(const struct double_vector* self,
 {
    for (const double* i = self->data; i < self->data + self->size; ++i)
    {
-      if (*i > -threshold && *i < threshold)
-      {
-         fprintf(ostream, "0 ");
-      }
-      else
-      {
-         fprintf(ostream, "%g ", *i);
-      }
+      print_value(*i, ostream, threshold);
    }
 
    fprintf(ostream, "\n");
    return;
 }
+
+/**************************************************************************************************
+* print_value: Skriver ut ett flyttal via angiven utstrm. Flyttal vars belopp understiger
+*              angivet trskelvrde skrivs ut som 0.
+*
+*              - value    : Flyttalet som skall skrivas ut.
+*              - ostream  : Pekare till angiven utstrm.
+*              - threshold: Trskelvrde, under vilket flyttalet skrivs ut som 0.
+**************************************************************************************************/
+static void print_value(const double value, 
+                        FILE* ostream, 
+                        const double threshold)
+{
+   if (value > -threshold && value < threshold)
+   {
+      fprintf(ostream, "0 ");
+   }
+   else
+   {
+      fprintf(ostream, "%g ", value);
+   }
+   return;
+}
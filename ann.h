@@ -10,20 +10,37 @@
 #include "double_vector.h"
 #include "dense_layer.h"
 #include "dense_layer_vector.h"
+#include "embedding_layer.h"
 #include "training_data.h"
+#include "sparse_vector.h"
+#include "epoch_buffer.h"
+#include "batch_queue.h"
+#include "training_stream.h"
+#include "ann_batch.h"
+#include "mapped_file.h"
+#include <threads.h>
+#include <time.h>
+
+/* Makrodefinitioner: */
+#define ANN_PREDICT_BATCH_SIZE 64 /* Antalet rader per batch vid batchvis prediktion. */
 
 /**************************************************************************************************
 * ann: Implementering av ett neuralt nätverk innehållande ett ingångslager, valfritt antal
-*      dolda lager samt ett yttre lager. Antalet noder i respektive lager är valbart.
+*      dolda lager samt ett yttre lager. Antalet noder i respektive lager är valbart. Mellan
+*      ingångslagret och de dolda lagren kan ett inbäddningslager läggas till för kategoriska
+*      insignaler, där varje insignal motsvarar en kategori.
 **************************************************************************************************/
 struct ann
 { 
    struct dense_layer output_layer;         /* Yttre lager. */
    struct dense_layer_vector hidden_layers; /* Fält innehållande dolda lager. */
+   struct embedding_layer embedding;        /* Inbäddningslager (saknar kategorier om inget). */
    struct training_data training_data;      /* Behållare för träningsdata. */
-   const struct double_vector* input_layer; /* Pekare till insignaler i ingångslagret. */
+   ann_real* input_layer;                   /* Insignaler i ingångslagret. */
+   ann_real* reference;                     /* Referensvärden vid träning. */
    size_t num_inputs;                       /* Antalet insignaler. */
    size_t num_outputs;                      /* Antalet utsignaler. */
+   struct mapped_file model_file;           /* Modellfil som parametrarna mappas från. */
 };
 
 /* Externa funktioner: */
@@ -41,6 +58,10 @@ int ann_add_hidden_layer(struct ann* self,
 int ann_add_hidden_layers(struct ann* self, 
                           const size_t num_layers, 
                           const size_t num_nodes);
+int ann_set_embedding_layer(struct ann* self,
+                            const size_t dimension);
+int ann_set_weight_format(struct ann* self,
+                          const enum dense_layer_format format);
 void ann_load_training_data(struct ann* self, 
                             const char* filepath);
 void ann_set_training_data(struct ann* self, 
@@ -49,10 +70,43 @@ void ann_set_training_data(struct ann* self,
 void ann_train(struct ann* self,
                const size_t num_epochs,
                const double learning_rate);
-double* ann_predict(struct ann* self, 
-                    const struct double_vector* input);
+int ann_train_batched(struct ann* self,
+                      const size_t num_epochs,
+                      const double learning_rate,
+                      const size_t batch_size);
+int ann_train_staged(struct ann* self,
+                     const size_t num_epochs,
+                     const double learning_rate,
+                     const size_t batch_size);
+int ann_train_pipelined(struct ann* self,
+                        const size_t num_epochs,
+                        const double learning_rate,
+                        const size_t batch_size);
+int ann_train_streamed(struct ann* self,
+                       struct training_stream* stream,
+                       const size_t num_epochs,
+                       const double learning_rate,
+                       const size_t batch_size);
+int ann_train_threaded(struct ann* self,
+                       const size_t num_epochs,
+                       const double learning_rate,
+                       const size_t num_threads,
+                       FILE* ostream);
+ann_real* ann_predict(struct ann* self, 
+                      const struct double_vector* input);
+ann_real* ann_predict_sparse(struct ann* self,
+                             const struct sparse_vector* input);
 void ann_predict_range(struct ann* self, 
                        const struct double_2d_vector* inputs, 
                        FILE* ostream);
+int ann_predict_batch(const struct ann* self,
+                      const struct double_2d_vector* inputs,
+                      double* output,
+                      const size_t num_threads);
+int ann_predict_matrix(const struct ann* self,
+                       const double* inputs,
+                       const size_t num_rows,
+                       double* output,
+                       const size_t num_threads);
 
 #endif /* ANN_H_ */
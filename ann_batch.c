@@ -0,0 +1,138 @@
+/**************************************************************************************************
+* ann_batch.c: Innehller funktionsdefinitioner som anvnds fr arbetsminne vid batchvis
+*              bearbetning av neurala ntverk.
+**************************************************************************************************/
+#include "ann_batch.h"
+
+/**************************************************************************************************
+* ann_batch_new: Initierar arbetsminne fr batchvis bearbetning av ett neuralt ntverk med
+*                angivna dolda lager samt angivet antal in- och utsignaler. Vid misslyckad
+*                minnesallokering, eller ifall det frsta dolda lagret inte har en vikt per
+*                insignal (exempelvis efter ett inbddningslager), returneras 1, annars 0.
+*
+*                - self         : Pekare till arbetsminnet.
+*                - hidden_layers: Pekare till ntverkets dolda lager.
+*                - num_inputs   : Antalet insignaler.
+*                - num_outputs  : Antalet utsignaler.
+*                - batch_size   : Maximalt antal uppsttningar per batch.
+**************************************************************************************************/
+int ann_batch_new(struct ann_batch* self,
+                  const struct dense_layer_vector* hidden_layers,
+                  const size_t num_inputs,
+                  const size_t num_outputs,
+                  const size_t batch_size)
+{
+   int error = 0;
+   self->num_hidden = hidden_layers->size;
+   self->batch_size = batch_size;
+   self->input_stride = aligned_memory_stride(num_inputs, sizeof(ann_real));
+   self->reference_stride = aligned_memory_stride(num_outputs, sizeof(ann_real));
+   self->output.output = 0;
+   self->output.error = 0;
+
+   self->hidden = (struct dense_layer_batch*)calloc(self->num_hidden, 
+                                                    sizeof(struct dense_layer_batch));
+   self->input = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * batch_size * 
+                                                 self->input_stride);
+   self->reference = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * batch_size * 
+                                                     self->reference_stride);
+   error = !self->hidden || !self->input || !self->reference ||
+      (hidden_layers->size && hidden_layers->data[0].num_weights != num_inputs) ||
+      dense_layer_batch_new(&self->output, num_outputs, batch_size);
+
+   for (size_t i = 0; i < self->num_hidden && !error; ++i)
+   {
+      error = dense_layer_batch_new(&self->hidden[i], hidden_layers->data[i].num_nodes, 
+                                    batch_size);
+   }
+
+   if (error)
+   {
+      ann_batch_delete(self);
+      return 1;
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_batch_delete: Frigr angivet arbetsminne.
+*
+*                   - self: Pekare till arbetsminnet.
+**************************************************************************************************/
+void ann_batch_delete(struct ann_batch* self)
+{
+   for (size_t i = 0; self->hidden && i < self->num_hidden; ++i)
+   {
+      dense_layer_batch_delete(&self->hidden[i]);
+   }
+
+   dense_layer_batch_delete(&self->output);
+   aligned_memory_free(self->reference);
+   aligned_memory_free(self->input);
+   free(self->hidden);
+
+   self->hidden = 0;
+   self->input = 0;
+   self->reference = 0;
+   self->num_hidden = 0;
+   self->batch_size = 0;
+   return;
+}
+
+/**************************************************************************************************
+* ann_batch_feedforward: Berknar utsignaler i samtliga lager fr de rader som har lagrats i
+*                        arbetsminnets indata. Ntverkets parametrar lses men modifieras inte,
+*                        vilket medfr att flera trdar kan anvnda samma ntverk samtidigt s
+*                        lnge varje trd har ett eget arbetsminne. Utsignalerna frn
+*                        utgngslagret lagras radvis i self->output.output.
+*
+*                        - self         : Pekare till arbetsminnet.
+*                        - hidden_layers: Pekare till ntverkets dolda lager.
+*                        - output_layer : Pekare till ntverkets utgngslager.
+*                        - num_rows     : Antalet rader i batchen.
+**************************************************************************************************/
+void ann_batch_feedforward(struct ann_batch* self,
+                           const struct dense_layer_vector* hidden_layers,
+                           const struct dense_layer* output_layer,
+                           const size_t num_rows)
+{
+   const struct dense_layer_batch* hidden_output = &self->hidden[self->num_hidden - 1];
+   dense_layer_vector_feedforward_batch(hidden_layers, self->hidden, self->input, 
+                                        self->input_stride, num_rows);
+   dense_layer_batch_feedforward(&self->output, output_layer, hidden_output->output,
+                                 hidden_output->stride, num_rows);
+   return;
+}
+
+/**************************************************************************************************
+* ann_batch_train: Genomfr ett trningssteg fr de rader som har lagrats i arbetsminnets in- och
+*                  referensdata. En feedforward genomfrs frst, fljt av berkning av
+*                  avvikelser i samtliga lager. Slutligen justeras bias samt vikter utifrn
+*                  medelvrdet av batchens gradienter.
+*
+*                  - self         : Pekare till arbetsminnet.
+*                  - hidden_layers: Pekare till ntverkets dolda lager.
+*                  - output_layer : Pekare till ntverkets utgngslager.
+*                  - num_rows     : Antalet rader i batchen.
+*                  - learning_rate: Lrhastigheten, avgr justeringsgraden vid avvikelse.
+**************************************************************************************************/
+void ann_batch_train(struct ann_batch* self,
+                     struct dense_layer_vector* hidden_layers,
+                     struct dense_layer* output_layer,
+                     const size_t num_rows,
+                     const double learning_rate)
+{
+   const struct dense_layer_batch* hidden_output = &self->hidden[self->num_hidden - 1];
+   ann_batch_feedforward(self, hidden_layers, output_layer, num_rows);
+
+   dense_layer_batch_compare_with_reference(&self->output, self->reference, 
+                                            self->reference_stride, num_rows);
+   dense_layer_vector_backpropagate_batch(hidden_layers, self->hidden, output_layer, 
+                                          &self->output, num_rows);
+
+   dense_layer_batch_optimize(&self->output, output_layer, hidden_output->output, 
+                              hidden_output->stride, num_rows, learning_rate);
+   dense_layer_vector_optimize_batch(hidden_layers, self->hidden, self->input, 
+                                     self->input_stride, num_rows, learning_rate);
+   return;
+}
@@ -0,0 +1,51 @@
+/**************************************************************************************************
+* ann_batch.h: Innehller funktionalitet fr arbetsminne vid batchvis bearbetning av ett helt
+*              neuralt ntverk via strukten ann_batch samt motsvarande externa funktioner.
+*              Arbetsminnet innehller utsignaler och avvikelser fr samtliga lager samt in- och
+*              referensdata fr en batch, medan ntverkets parametrar lagras separat. Drmed kan
+*              flera trdar bearbeta samma ntverk samtidigt, med ett eget arbetsminne per trd.
+**************************************************************************************************/
+#ifndef ANN_BATCH_H_
+#define ANN_BATCH_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "aligned_memory.h"
+#include "dense_layer.h"
+#include "dense_layer_batch.h"
+#include "dense_layer_vector.h"
+
+/**************************************************************************************************
+* ann_batch: Arbetsminne fr ett neuralt ntverk vid batchvis bearbetning. Indata samt
+*            referensvrden lagras radvis, en rad per uppsttning i batchen.
+**************************************************************************************************/
+struct ann_batch
+{
+   struct dense_layer_batch* hidden; /* Arbetsminne fr respektive dolt lager. */
+   struct dense_layer_batch output;  /* Arbetsminne fr utgngslagret. */
+   ann_real* input;                  /* Insignaler (batch_size x input_stride). */
+   ann_real* reference;              /* Referensvrden (batch_size x reference_stride). */
+   size_t num_hidden;                /* Antalet dolda lager. */
+   size_t batch_size;                /* Maximalt antal uppsttningar per batch. */
+   size_t input_stride;              /* Avstndet mellan tv rader i input. */
+   size_t reference_stride;          /* Avstndet mellan tv rader i reference. */
+};
+
+/* Externa funktioner: */
+int ann_batch_new(struct ann_batch* self,
+                  const struct dense_layer_vector* hidden_layers,
+                  const size_t num_inputs,
+                  const size_t num_outputs,
+                  const size_t batch_size);
+void ann_batch_delete(struct ann_batch* self);
+void ann_batch_feedforward(struct ann_batch* self,
+                           const struct dense_layer_vector* hidden_layers,
+                           const struct dense_layer* output_layer,
+                           const size_t num_rows);
+void ann_batch_train(struct ann_batch* self,
+                     struct dense_layer_vector* hidden_layers,
+                     struct dense_layer* output_layer,
+                     const size_t num_rows,
+                     const double learning_rate);
+
+#endif /* ANN_BATCH_H_ */
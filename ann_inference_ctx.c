@@ -0,0 +1,94 @@
+/**************************************************************************************************
+* ann_inference_ctx.c: Innehller funktionsdefinitioner som anvnds fr trdsker prediktion
+*                      med delade neurala ntverk.
+**************************************************************************************************/
+#include "ann_inference_ctx.h"
+
+/**************************************************************************************************
+* ann_inference_ctx_new: Initierar en kontext fr prediktion med angivet neuralt ntverk, dr
+*                        arbetsminne allokeras fr utsignaler i samtliga lager. Vid misslyckad
+*                        minnesallokering eller ifall ntverket saknar dolda lager returneras 1,
+*                        annars 0.
+*
+*                        - self: Pekare till kontexten.
+*                        - ann : Pekare till det delade neurala ntverket.
+**************************************************************************************************/
+int ann_inference_ctx_new(struct ann_inference_ctx* self,
+                          const struct ann* ann)
+{
+   self->ann = ann;
+   if (!ann->hidden_layers.size) return 1;
+   return ann_batch_new(&self->batch, &ann->hidden_layers, ann->num_inputs, ann->num_outputs, 1);
+}
+
+/**************************************************************************************************
+* ann_inference_ctx_delete: Frigr arbetsminnet i angiven kontext. Det delade neurala ntverket
+*                           pverkas inte.
+*
+*                           - self: Pekare till kontexten.
+**************************************************************************************************/
+void ann_inference_ctx_delete(struct ann_inference_ctx* self)
+{
+   ann_batch_delete(&self->batch);
+   self->ann = 0;
+   return;
+}
+
+/**************************************************************************************************
+* ann_inference_ctx_ptr_new: Returnerar en pekare till en ny heapallokerad kontext fr prediktion
+*                            med angivet neuralt ntverk. Vid misslyckad minnesallokering
+*                            returneras null.
+*
+*                            - ann: Pekare till det delade neurala ntverket.
+**************************************************************************************************/
+struct ann_inference_ctx* ann_inference_ctx_ptr_new(const struct ann* ann)
+{
+   struct ann_inference_ctx* self = 
+      (struct ann_inference_ctx*)malloc(sizeof(struct ann_inference_ctx));
+   if (!self) return 0;
+
+   if (ann_inference_ctx_new(self, ann))
+   {
+      free(self);
+      return 0;
+   }
+   return self;
+}
+
+/**************************************************************************************************
+* ann_inference_ctx_ptr_delete: Raderar heapallokerad kontext samt stter motsvarande pekare
+*                               till null.
+*
+*                               - self: Adressen till pekaren som pekar p kontexten.
+**************************************************************************************************/
+void ann_inference_ctx_ptr_delete(struct ann_inference_ctx** self)
+{
+   ann_inference_ctx_delete(*self);
+   free(*self);
+   *self = 0;
+   return;
+}
+
+/**************************************************************************************************
+* ann_inference_ctx_predict: Genomfr prediktion med kontextens neurala ntverk utifrn givna
+*                            insignaler och returnerar adressen till ett flt innehllande
+*                            predikterade utsignaler. Fltet tillhr kontexten och skrivs ver
+*                            vid nsta anrop. Ifall antalet insignaler r fr litet returneras
+*                            null.
+*
+*                            - self : Pekare till kontexten.
+*                            - input: Pekare till vektor innehllande indata till ntverket.
+**************************************************************************************************/
+const ann_real* ann_inference_ctx_predict(struct ann_inference_ctx* self,
+                                          const struct double_vector* input)
+{
+   if (input->size < self->ann->num_inputs) return 0;
+
+   for (size_t i = 0; i < self->ann->num_inputs; ++i)
+   {
+      self->batch.input[i] = (ann_real)input->data[i];
+   }
+
+   ann_batch_feedforward(&self->batch, &self->ann->hidden_layers, &self->ann->output_layer, 1);
+   return self->batch.output.output;
+}
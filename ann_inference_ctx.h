@@ -0,0 +1,37 @@
+/**************************************************************************************************
+* ann_inference_ctx.h: Innehller funktionalitet fr trdsker prediktion via strukten
+*                      ann_inference_ctx samt motsvarande externa funktioner. En kontext ger
+*                      enbart arbetsminnet fr utsignaler vid prediktion, medan vikter och bias
+*                      lses frn ett delat neuralt ntverk som inte modifieras. Drmed kan
+*                      godtyckligt antal trdar genomfra prediktion samtidigt mot samma
+*                      ntverk, med en egen kontext per trd.
+**************************************************************************************************/
+#ifndef ANN_INFERENCE_CTX_H_
+#define ANN_INFERENCE_CTX_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "ann.h"
+#include "ann_batch.h"
+#include "double_vector.h"
+
+/**************************************************************************************************
+* ann_inference_ctx: Kontext fr prediktion med ett delat neuralt ntverk. Ntverkets lager fr
+*                    inte lggas till eller ndras i storlek s lnge kontexten anvnds.
+**************************************************************************************************/
+struct ann_inference_ctx
+{
+   const struct ann* ann;  /* Pekare till det delade neurala ntverket. */
+   struct ann_batch batch; /* Arbetsminne fr utsignaler i samtliga lager. */
+};
+
+/* Externa funktioner: */
+int ann_inference_ctx_new(struct ann_inference_ctx* self,
+                          const struct ann* ann);
+void ann_inference_ctx_delete(struct ann_inference_ctx* self);
+struct ann_inference_ctx* ann_inference_ctx_ptr_new(const struct ann* ann);
+void ann_inference_ctx_ptr_delete(struct ann_inference_ctx** self);
+const ann_real* ann_inference_ctx_predict(struct ann_inference_ctx* self,
+                                          const struct double_vector* input);
+
+#endif /* ANN_INFERENCE_CTX_H_ */
@@ -0,0 +1,274 @@
+/**************************************************************************************************
+* ann_model.c: Innehller funktionsdefinitioner som anvnds fr att spara och lsa in neurala
+*              ntverk i binrt format.
+**************************************************************************************************/
+#include "ann_model.h"
+
+/* Statiska funktioner: */
+static const struct dense_layer* ann_model_get_layer(const struct ann* self,
+                                                     const size_t index);
+static int ann_model_write(const struct ann* self,
+                           FILE* ostream);
+static int ann_model_validate(const struct mapped_file* file);
+static size_t round_up(const size_t value,
+                       const size_t alignment);
+
+/**************************************************************************************************
+* ann_save: Sparar topologi samt parametrar fr angivet neuralt ntverk till angiven fil. Filen
+*           skrivs frst till en temporr fil, som sedan erstter angiven fil, s att processer
+*           som har mappat en tidigare version av modellen inte pverkas av en halvfrdig fil.
+*           Trningsdata sparas inte. Filformatet saknar std fr inbddningslager, s ett
+*           ntverk med ett sdant sparas inte. Returnerar 0 vid lyckad skrivning, annars 1.
+*
+*           - self    : Pekare till det neurala ntverket.
+*           - filepath: Pekare till filskvgen som modellen skall sparas till.
+**************************************************************************************************/
+int ann_save(const struct ann* self,
+             const char* filepath)
+{
+   const size_t length = strlen(filepath);
+   char* temporary_path = (char*)malloc(length + 5);
+   FILE* ostream = 0;
+   int error = 0;
+
+   if (self->embedding.num_categories || !temporary_path)
+   {
+      free(temporary_path);
+      return 1;
+   }
+
+   memcpy(temporary_path, filepath, length);
+   memcpy(temporary_path + length, ".tmp", 5);
+
+   ostream = fopen(temporary_path, "wb");
+   error = !ostream || ann_model_write(self, ostream);
+   if (ostream && fclose(ostream)) error = 1;
+
+   if (!error)
+   {
+#ifdef _WIN32
+      remove(filepath);
+#endif
+      error = rename(temporary_path, filepath) != 0;
+   }
+   if (error)
+   {
+      remove(temporary_path);
+   }
+
+   free(temporary_path);
+   return error;
+}
+
+/**************************************************************************************************
+* ann_load: Lser in ett neuralt ntverk frn angiven modellfil, som minnesmappas. Lagrens vikter
+*           och bias pekar direkt p de mappade sidorna och kopieras endast ifall de ndras,
+*           exempelvis vid fortsatt trning, och d enbart i aktuell process. Mappningen tas bort
+*           nr ntverket raderas via ann_delete. Angivet ntverk fr inte vara initierat sedan
+*           tidigare. Vid misslyckad inlsning, exempelvis ifall filen saknas, r skadad eller har
+*           sparats med en annan flyttalstyp, returneras 1 och ntverket lmnas oinitierat,
+*           annars returneras 0.
+*
+*           - self    : Pekare till det neurala ntverket.
+*           - filepath: Pekare till filskvgen som modellen skall lsas frn.
+**************************************************************************************************/
+int ann_load(struct ann* self,
+             const char* filepath)
+{
+   struct mapped_file file;
+   const struct ann_model_header* header = 0;
+   const struct ann_model_layer* layers = 0;
+   unsigned char* data = 0;
+   int error = 0;
+
+   if (mapped_file_open(&file, filepath)) return 1;
+
+   if (ann_model_validate(&file))
+   {
+      mapped_file_close(&file);
+      return 1;
+   }
+
+   data = (unsigned char*)file.data;
+   header = (const struct ann_model_header*)data;
+   layers = (const struct ann_model_layer*)(data + sizeof(struct ann_model_header));
+
+   self->num_inputs = (size_t)header->num_inputs;
+   self->num_outputs = (size_t)header->num_outputs;
+   self->input_layer = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * self->num_inputs);
+   self->reference = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * self->num_outputs);
+   self->model_file = file;
+   embedding_layer_new(&self->embedding, 0, 0);
+   training_data_new(&self->training_data, self->num_inputs, self->num_outputs);
+   dense_layer_vector_new(&self->hidden_layers);
+
+   for (size_t i = 0; i < header->num_layers; ++i)
+   {
+      const struct ann_model_layer* layer = &layers[i];
+      ann_real* parameters = (ann_real*)(data + layer->offset);
+
+      if (i + 1 < header->num_layers)
+      {
+         struct dense_layer hidden_layer;
+         dense_layer_new_external(&hidden_layer, (size_t)layer->num_nodes, 
+                                  (size_t)layer->num_weights, parameters);
+         if (dense_layer_vector_push(&self->hidden_layers, &hidden_layer))
+         {
+            dense_layer_delete(&hidden_layer);
+            error = 1;
+         }
+      }
+      else
+      {
+         dense_layer_new_external(&self->output_layer, (size_t)layer->num_nodes, 
+                                  (size_t)layer->num_weights, parameters);
+      }
+   }
+
+   if (error)
+   {
+      ann_delete(self);
+      return 1;
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_model_get_layer: Returnerar adressen till lagret med angivet index, dr de dolda lagren
+*                      numreras frst och utgngslagret sist.
+*
+*                      - self : Pekare till det neurala ntverket.
+*                      - index: Lagrets index.
+**************************************************************************************************/
+static const struct dense_layer* ann_model_get_layer(const struct ann* self,
+                                                     const size_t index)
+{
+   if (index < self->hidden_layers.size) return &self->hidden_layers.data[index];
+   return &self->output_layer;
+}
+
+/**************************************************************************************************
+* ann_model_write: Skriver huvud, lagertabell samt samtliga parameterblock via angiven utstrm.
+*                  Varje parameterblock brjar p en position som r justerad mot
+*                  ALIGNED_MEMORY_ALIGNMENT, s att blocket kan anvndas direkt efter mappning.
+*                  Returnerar 0 vid lyckad skrivning, annars 1.
+*
+*                  - self   : Pekare till det neurala ntverket.
+*                  - ostream: Pekare till utstrmmen som modellen skrivs till.
+**************************************************************************************************/
+static int ann_model_write(const struct ann* self,
+                           FILE* ostream)
+{
+   const size_t num_layers = self->hidden_layers.size + 1;
+   const size_t table_end = sizeof(struct ann_model_header) + 
+      num_layers * sizeof(struct ann_model_layer);
+   const unsigned char padding[ALIGNED_MEMORY_ALIGNMENT] = { 0 };
+   struct ann_model_header header;
+   size_t offset = round_up(table_end, ALIGNED_MEMORY_ALIGNMENT);
+   int error = 0;
+
+   memcpy(header.magic, ANN_MODEL_MAGIC, sizeof(header.magic));
+   header.version = ANN_MODEL_VERSION;
+   header.byte_order = ANN_MODEL_BYTE_ORDER;
+   header.real_size = sizeof(ann_real);
+   header.alignment = ALIGNED_MEMORY_ALIGNMENT;
+   header.num_inputs = self->num_inputs;
+   header.num_outputs = self->num_outputs;
+   header.num_layers = num_layers;
+   error = fwrite(&header, sizeof(header), 1, ostream) != 1;
+
+   for (size_t i = 0; i < num_layers && !error; ++i)
+   {
+      const struct dense_layer* layer = ann_model_get_layer(self, i);
+      struct ann_model_layer entry;
+      entry.num_nodes = layer->num_nodes;
+      entry.num_weights = layer->num_weights;
+      entry.stride = layer->stride;
+      entry.offset = offset;
+      offset += sizeof(ann_real) * dense_layer_parameter_size(layer->num_nodes, 
+                                                              layer->num_weights);
+      error = fwrite(&entry, sizeof(entry), 1, ostream) != 1;
+   }
+
+   if (!error && round_up(table_end, ALIGNED_MEMORY_ALIGNMENT) > table_end)
+   {
+      const size_t num_padding = round_up(table_end, ALIGNED_MEMORY_ALIGNMENT) - table_end;
+      error = fwrite(padding, 1, num_padding, ostream) != num_padding;
+   }
+
+   for (size_t i = 0; i < num_layers && !error; ++i)
+   {
+      const struct dense_layer* layer = ann_model_get_layer(self, i);
+      const size_t size = dense_layer_parameter_size(layer->num_nodes, layer->num_weights);
+      error = fwrite(layer->weights, sizeof(ann_real), size, ostream) != size;
+   }
+   return error;
+}
+
+/**************************************************************************************************
+* ann_model_validate: Kontrollerar att angiven mappad fil innehller en giltig modell som kan
+*                     anvndas direkt av aktuellt program, allts att huvudet r korrekt, att
+*                     flyttalstyp, byteordning och justering verensstmmer, att lagrens
+*                     dimensioner hnger ihop samt att samtliga parameterblock ryms i filen.
+*                     Returnerar 0 fr en giltig modell, annars 1.
+*
+*                     - file: Pekare till den mappade modellfilen.
+**************************************************************************************************/
+static int ann_model_validate(const struct mapped_file* file)
+{
+   const struct ann_model_header* header = (const struct ann_model_header*)file->data;
+   const struct ann_model_layer* layers = 0;
+   uint64_t num_weights = 0;
+
+   if (file->size < sizeof(struct ann_model_header)) return 1;
+   if (memcmp(header->magic, ANN_MODEL_MAGIC, sizeof(header->magic))) return 1;
+   if (header->version != ANN_MODEL_VERSION) return 1;
+   if (header->byte_order != ANN_MODEL_BYTE_ORDER) return 1;
+   if (header->real_size != sizeof(ann_real)) return 1;
+   if (header->alignment != ALIGNED_MEMORY_ALIGNMENT) return 1;
+   if (header->num_layers < 2) return 1;
+   if (header->num_layers > (file->size - sizeof(struct ann_model_header)) / 
+       sizeof(struct ann_model_layer))
+   {
+      return 1;
+   }
+
+   layers = (const struct ann_model_layer*)((const unsigned char*)file->data + 
+                                            sizeof(struct ann_model_header));
+   num_weights = header->num_inputs;
+
+   for (uint64_t i = 0; i < header->num_layers; ++i)
+   {
+      const struct ann_model_layer* layer = &layers[i];
+      const uint64_t max_nodes = file->size / sizeof(ann_real);
+      uint64_t size = 0;
+
+      if (!layer->num_nodes || layer->num_nodes > max_nodes) return 1;
+      if (layer->num_weights != num_weights || layer->num_weights > max_nodes) return 1;
+      if (layer->stride != aligned_memory_stride((size_t)layer->num_weights, sizeof(ann_real)))
+      {
+         return 1;
+      }
+      if (layer->num_nodes > max_nodes / (layer->stride + 1)) return 1;
+
+      size = sizeof(ann_real) * dense_layer_parameter_size((size_t)layer->num_nodes, 
+                                                           (size_t)layer->num_weights);
+      if (layer->offset % ALIGNED_MEMORY_ALIGNMENT) return 1;
+      if (layer->offset > file->size || size > file->size - layer->offset) return 1;
+      num_weights = layer->num_nodes;
+   }
+
+   return num_weights != header->num_outputs;
+}
+
+/**************************************************************************************************
+* round_up: Returnerar angivet vrde avrundat uppt till en jmn multipel av angiven justering.
+*
+*           - value    : Vrdet som skall avrundas.
+*           - alignment: Justeringen som vrdet skall avrundas till.
+**************************************************************************************************/
+static size_t round_up(const size_t value,
+                       const size_t alignment)
+{
+   return (value + alignment - 1) / alignment * alignment;
+}
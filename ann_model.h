@@ -0,0 +1,57 @@
+/**************************************************************************************************
+* ann_model.h: Innehller funktionalitet fr att spara och lsa in trnade neurala ntverk i ett
+*              versionshanterat binrt filformat. Filen bestr av ett huvud, en tabell med ett
+*              element per lager samt lagrens parameterblock, som lagras med exakt samma layout
+*              som i minnet och justeras mot cacheradsgrnser. Vid inlsning minnesmappas filen
+*              och lagrens vikter och bias pekar direkt p de mappade sidorna, vilket medfr att
+*              ingen data behver kopieras eller tolkas och att flera processer som lser samma
+*              modell delar en enda fysisk kopia av parametrarna.
+**************************************************************************************************/
+#ifndef ANN_MODEL_H_
+#define ANN_MODEL_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "ann.h"
+#include "mapped_file.h"
+#include <string.h>
+
+/* Makrodefinitioner: */
+#define ANN_MODEL_MAGIC      "ANNMODEL" /* Identifierar filformatet (tta tecken). */
+#define ANN_MODEL_VERSION    1          /* Aktuell version av filformatet. */
+#define ANN_MODEL_BYTE_ORDER 0x01020304 /* Anvnds fr att upptcka avvikande byteordning. */
+
+/**************************************************************************************************
+* ann_model_header: Huvud i brjan av en modellfil. Samtliga heltal lagras med skrivande vrds
+*                   byteordning, vilket kontrolleras via fltet byte_order vid inlsning.
+**************************************************************************************************/
+struct ann_model_header
+{
+   char magic[8];        /* Identifierar filformatet, ANN_MODEL_MAGIC utan nolltecken. */
+   uint32_t version;     /* Filformatets version. */
+   uint32_t byte_order;  /* ANN_MODEL_BYTE_ORDER. */
+   uint32_t real_size;   /* Storleken p flyttalstypen ann_real i byte. */
+   uint32_t alignment;   /* Justering av parameterblocken i byte. */
+   uint64_t num_inputs;  /* Antalet insignaler. */
+   uint64_t num_outputs; /* Antalet utsignaler. */
+   uint64_t num_layers;  /* Antalet lager, allts dolda lager fljda av utgngslagret. */
+};
+
+/**************************************************************************************************
+* ann_model_layer: Element i lagertabellen, som fljer direkt efter huvudet i en modellfil.
+**************************************************************************************************/
+struct ann_model_layer
+{
+   uint64_t num_nodes;   /* Antalet noder i lagret. */
+   uint64_t num_weights; /* Antalet vikter per nod. */
+   uint64_t stride;      /* Avstndet mellan tv noders vikter i viktmatrisen. */
+   uint64_t offset;      /* Parameterblockets position i filen, rknat i byte. */
+};
+
+/* Externa funktioner: */
+int ann_save(const struct ann* self,
+             const char* filepath);
+int ann_load(struct ann* self,
+             const char* filepath);
+
+#endif /* ANN_MODEL_H_ */
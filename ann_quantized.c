@@ -0,0 +1,459 @@
+/**************************************************************************************************
+* ann_quantized.c: Innehller funktionsdefinitioner som anvnds fr kvantiserad inferens med
+*                  trnade neurala ntverk.
+**************************************************************************************************/
+#include "ann_quantized.h"
+
+/* Makrodefinitioner: */
+#define ANN_QUANTIZED_MAX_WEIGHTS \
+   (INT32_MAX / (ANN_QUANTIZED_WEIGHT_MAX * ANN_QUANTIZED_INPUT_MAX)) /* Ryms i 32 bitar. */
+
+/* Statiska funktioner: */
+static int ann_quantized_layer_new(struct ann_quantized_layer* self,
+                                   const struct dense_layer* layer);
+static void ann_quantized_layer_delete(struct ann_quantized_layer* self);
+static void ann_quantized_layer_feedforward(struct ann_quantized_layer* self,
+                                            const ann_real* input,
+                                            uint8_t* quantized_input);
+static void quantize_input(const ann_real* input,
+                           const size_t size,
+                           uint8_t* output,
+                           double* scale,
+                           int32_t* zero_point);
+static inline long round_nearest(const double value);
+static double get_time(void);
+
+/**************************************************************************************************
+* ann_quantized_new: Konverterar angivet trnat neuralt ntverk till en kvantiserad modell. Varje
+*                    nods vikter skalas symmetriskt, s att radens strsta vikt i absolutbelopp
+*                    motsvarar 127, och avrundas till nrmaste heltal. Biasvrdena lagras
+*                    ofrndrade. Ifall ntverket saknar dolda lager, innehller ett
+*                    inbddningslager eller har ett lager med fler vikter per nod n vad som
+*                    ryms i 32-bitars ackumulatorer returneras 1, liksom vid misslyckad
+*                    minnesallokering. Annars returneras 0.
+*
+*                    - self: Pekare till den kvantiserade modellen.
+*                    - ann : Pekare till det trnade neurala ntverket, som inte modifieras.
+**************************************************************************************************/
+int ann_quantized_new(struct ann_quantized* self,
+                      const struct ann* ann)
+{
+   size_t max_width = ann->num_inputs;
+   self->layers = 0;
+   self->num_layers = 0;
+   self->input = 0;
+   self->input_layer = 0;
+   self->num_inputs = ann->num_inputs;
+   self->num_outputs = ann->num_outputs;
+   if (!ann->hidden_layers.size || ann->embedding.num_categories) return 1;
+
+   self->layers = (struct ann_quantized_layer*)calloc(ann->hidden_layers.size + 1,
+                                                      sizeof(struct ann_quantized_layer));
+   if (!self->layers) return 1;
+
+   for (size_t i = 0; i <= ann->hidden_layers.size; ++i)
+   {
+      const struct dense_layer* layer = i < ann->hidden_layers.size ?
+         &ann->hidden_layers.data[i] : &ann->output_layer;
+
+      if (layer->num_weights > ANN_QUANTIZED_MAX_WEIGHTS ||
+          ann_quantized_layer_new(&self->layers[i], layer))
+      {
+         ann_quantized_delete(self);
+         return 1;
+      }
+
+      self->num_layers++;
+      if (layer->num_weights > max_width) max_width = layer->num_weights;
+   }
+
+   self->input = (uint8_t*)aligned_memory_alloc(aligned_memory_stride(max_width, 1));
+   self->input_layer = (ann_real*)aligned_memory_alloc(
+      sizeof(ann_real) * aligned_memory_stride(self->num_inputs, sizeof(ann_real)));
+
+   if (!self->input || !self->input_layer)
+   {
+      ann_quantized_delete(self);
+      return 1;
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_quantized_delete: Frigr minnet fr angiven kvantiserad modell.
+*
+*                       - self: Pekare till den kvantiserade modellen.
+**************************************************************************************************/
+void ann_quantized_delete(struct ann_quantized* self)
+{
+   for (size_t i = 0; i < self->num_layers; ++i)
+   {
+      ann_quantized_layer_delete(&self->layers[i]);
+   }
+
+   free(self->layers);
+   aligned_memory_free(self->input);
+   aligned_memory_free(self->input_layer);
+   self->layers = 0;
+   self->num_layers = 0;
+   self->input = 0;
+   self->input_layer = 0;
+   self->num_inputs = 0;
+   self->num_outputs = 0;
+   return;
+}
+
+/**************************************************************************************************
+* ann_quantized_ptr_new: Returnerar en pekare till en ny heapallokerad kvantiserad modell av
+*                        angivet trnat neuralt ntverk. Vid misslyckad konvertering returneras
+*                        null.
+*
+*                        - ann: Pekare till det trnade neurala ntverket.
+**************************************************************************************************/
+struct ann_quantized* ann_quantized_ptr_new(const struct ann* ann)
+{
+   struct ann_quantized* self = (struct ann_quantized*)malloc(sizeof(struct ann_quantized));
+   if (!self) return 0;
+
+   if (ann_quantized_new(self, ann))
+   {
+      free(self);
+      return 0;
+   }
+   return self;
+}
+
+/**************************************************************************************************
+* ann_quantized_ptr_delete: Raderar heapallokerad kvantiserad modell samt stter motsvarande
+*                           pekare till null.
+*
+*                           - self: Adressen till pekaren som pekar p den kvantiserade modellen.
+**************************************************************************************************/
+void ann_quantized_ptr_delete(struct ann_quantized** self)
+{
+   ann_quantized_delete(*self);
+   free(*self);
+   *self = 0;
+   return;
+}
+
+/**************************************************************************************************
+* ann_quantized_predict: Genomfr prediktion med angiven kvantiserad modell utifrn givna
+*                        insignaler och returnerar adressen till ett flt innehllande
+*                        predikterade utsignaler. Fltet tillhr modellen och skrivs ver vid
+*                        nsta anrop. Ifall antalet insignaler r fr litet returneras null.
+*
+*                        - self : Pekare till den kvantiserade modellen.
+*                        - input: Pekare till vektor innehllande indata till modellen.
+**************************************************************************************************/
+ann_real* ann_quantized_predict(struct ann_quantized* self,
+                                const struct double_vector* input)
+{
+   const ann_real* layer_input = self->input_layer;
+   if (input->size < self->num_inputs) return 0;
+
+   for (size_t i = 0; i < self->num_inputs; ++i)
+   {
+      self->input_layer[i] = (ann_real)input->data[i];
+   }
+
+   for (size_t i = 0; i < self->num_layers; ++i)
+   {
+      ann_quantized_layer_feedforward(&self->layers[i], layer_input, self->input);
+      layer_input = self->layers[i].output;
+   }
+   return self->layers[self->num_layers - 1].output;
+}
+
+/**************************************************************************************************
+* ann_quantized_size: Returnerar antalet byte som angiven kvantiserad modells parametrar upptar,
+*                     allts kvantiserade vikter, skalfaktorer, viktsummor samt biasvrden.
+*
+*                     - self: Pekare till den kvantiserade modellen.
+**************************************************************************************************/
+size_t ann_quantized_size(const struct ann_quantized* self)
+{
+   size_t size = 0;
+
+   for (size_t i = 0; i < self->num_layers; ++i)
+   {
+      const struct ann_quantized_layer* layer = &self->layers[i];
+      size += layer->num_nodes * (layer->stride + sizeof(float) + sizeof(int32_t) +
+                                  sizeof(ann_real));
+   }
+   return size;
+}
+
+/**************************************************************************************************
+* ann_quantized_report: Jmfr angiven kvantiserad modell med det neurala ntverk som den har
+*                       konverterats frn genom prediktion med bda modellerna fr samtliga
+*                       kombinationer av insignaler i angiven tvdimensionell vektor. Strsta
+*                       samt genomsnittlig absolut avvikelse mellan utsignalerna skrivs ut via
+*                       angiven utstrm, tillsammans med modellernas storlek och genomstrmning.
+*                       Fr ntverk med flera utsignaler skrivs ven andelen kombinationer dr
+*                       bda modellerna har strst utsignal fr samma nod ut. Ifall vektorn r
+*                       tom, ngon kombination innehller fr f insignaler eller ntverkets
+*                       dimensioner inte verensstmmer med modellen returneras 1, annars 0.
+*
+*                       - self   : Pekare till den kvantiserade modellen.
+*                       - ann    : Pekare till det neurala ntverk som modellen konverterats frn.
+*                       - inputs : Pekare till vektor innehllande kombinationer av insignaler.
+*                       - ostream: Pekare till angiven utstrm (default = stdout).
+**************************************************************************************************/
+int ann_quantized_report(struct ann_quantized* self,
+                         struct ann* ann,
+                         const struct double_2d_vector* inputs,
+                         FILE* ostream)
+{
+   const size_t num_outputs = self->num_outputs;
+   size_t float_size = 0, num_matches = 0;
+   double max_error = 0, total_error = 0, float_time = 0, quantized_time = 0;
+
+   if (!inputs->size || ann->num_inputs != self->num_inputs ||
+       ann->num_outputs != num_outputs || ann->hidden_layers.size + 1 != self->num_layers)
+   {
+      return 1;
+   }
+
+   for (size_t i = 0; i < inputs->size; ++i)
+   {
+      if (inputs->data[i].size < self->num_inputs) return 1;
+   }
+
+   for (size_t i = 0; i < inputs->size; ++i)
+   {
+      const double start_time = get_time();
+      const ann_real* expected = ann_predict(ann, &inputs->data[i]);
+      const double middle_time = get_time();
+      const ann_real* predicted = ann_quantized_predict(self, &inputs->data[i]);
+      size_t expected_max = 0, predicted_max = 0;
+
+      float_time += middle_time - start_time;
+      quantized_time += get_time() - middle_time;
+
+      for (size_t j = 0; j < num_outputs; ++j)
+      {
+         const double difference = (double)predicted[j] - (double)expected[j];
+         const double error = difference < 0 ? -difference : difference;
+         if (error > max_error) max_error = error;
+         total_error += error;
+         if (expected[j] > expected[expected_max]) expected_max = j;
+         if (predicted[j] > predicted[predicted_max]) predicted_max = j;
+      }
+
+      if (expected_max == predicted_max) num_matches++;
+   }
+
+   for (size_t i = 0; i < ann->hidden_layers.size; ++i)
+   {
+      const struct dense_layer* layer = &ann->hidden_layers.data[i];
+      float_size += dense_layer_parameter_size(layer->num_nodes, layer->num_weights);
+   }
+
+   float_size += dense_layer_parameter_size(ann->output_layer.num_nodes,
+                                            ann->output_layer.num_weights);
+   float_size *= sizeof(ann_real);
+
+   if (!ostream) ostream = stdout;
+   fprintf(ostream, "----------------------------------------------------------------------------\n");
+   fprintf(ostream, "Rows: %zu, outputs: %zu\n", inputs->size, num_outputs);
+   fprintf(ostream, "Max absolute error: %g\n", max_error);
+   fprintf(ostream, "Mean absolute error: %g\n", total_error / (inputs->size * num_outputs));
+
+   if (num_outputs > 1)
+   {
+      fprintf(ostream, "Top-1 agreement: %g %%\n", 100.0 * num_matches / inputs->size);
+   }
+
+   fprintf(ostream, "Model size: %zu bytes (float), %zu bytes (int8)\n",
+           float_size, ann_quantized_size(self));
+   fprintf(ostream, "Throughput: %g rows/s (float), %g rows/s (int8)\n",
+           float_time > 0.0 ? inputs->size / float_time : 0.0,
+           quantized_time > 0.0 ? inputs->size / quantized_time : 0.0);
+   fprintf(ostream, "----------------------------------------------------------------------------\n\n");
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_quantized_layer_new: Kvantiserar vikterna i angivet dense-lager till angivet kvantiserat
+*                          lager, dr varje nods vikter skalas med en egen skalfaktor. Eventuell
+*                          utfyllnad i slutet av varje rad nollstlls. Vid misslyckad
+*                          minnesallokering returneras 1, annars 0.
+*
+*                          - self : Pekare till det kvantiserade lagret.
+*                          - layer: Pekare till dense-lagret som skall kvantiseras.
+**************************************************************************************************/
+static int ann_quantized_layer_new(struct ann_quantized_layer* self,
+                                   const struct dense_layer* layer)
+{
+   self->num_nodes = layer->num_nodes;
+   self->num_weights = layer->num_weights;
+   self->stride = aligned_memory_stride(layer->num_weights, sizeof(int8_t));
+   self->weights = (int8_t*)aligned_memory_alloc(self->num_nodes * self->stride);
+   self->scales = (float*)malloc(sizeof(float) * self->num_nodes);
+   self->sums = (int32_t*)malloc(sizeof(int32_t) * self->num_nodes);
+   self->bias = (ann_real*)malloc(sizeof(ann_real) * self->num_nodes);
+   self->output = (ann_real*)aligned_memory_alloc(
+      sizeof(ann_real) * aligned_memory_stride(self->num_nodes, sizeof(ann_real)));
+
+   if (!self->weights || !self->scales || !self->sums || !self->bias || !self->output)
+   {
+      ann_quantized_layer_delete(self);
+      return 1;
+   }
+
+   memset(self->weights, 0, self->num_nodes * self->stride);
+   memset(self->output, 0, sizeof(ann_real) * self->num_nodes);
+
+   for (size_t i = 0; i < self->num_nodes; ++i)
+   {
+      const ann_real* weights = layer->weights + i * layer->stride;
+      int8_t* quantized = self->weights + i * self->stride;
+      double max = 0;
+      int32_t sum = 0;
+
+      for (size_t j = 0; j < self->num_weights; ++j)
+      {
+         if (weights[j] > max) max = weights[j];
+         if (-weights[j] > max) max = -weights[j];
+      }
+
+      self->scales[i] = (float)(max / ANN_QUANTIZED_WEIGHT_MAX);
+
+      for (size_t j = 0; j < self->num_weights && max > 0; ++j)
+      {
+         quantized[j] = (int8_t)round_nearest(weights[j] * ANN_QUANTIZED_WEIGHT_MAX / max);
+         sum += quantized[j];
+      }
+
+      self->sums[i] = sum;
+      self->bias[i] = layer->bias[i];
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* ann_quantized_layer_delete: Frigr minnet fr angivet kvantiserat lager.
+*
+*                             - self: Pekare till det kvantiserade lagret.
+**************************************************************************************************/
+static void ann_quantized_layer_delete(struct ann_quantized_layer* self)
+{
+   aligned_memory_free(self->weights);
+   free(self->scales);
+   free(self->sums);
+   free(self->bias);
+   aligned_memory_free(self->output);
+   self->weights = 0;
+   self->scales = 0;
+   self->sums = 0;
+   self->bias = 0;
+   self->output = 0;
+   self->num_nodes = 0;
+   self->num_weights = 0;
+   self->stride = 0;
+   return;
+}
+
+/**************************************************************************************************
+* ann_quantized_layer_feedforward: Berknar ny utdata fr angivet kvantiserat lager. Indatan
+*                                  kvantiseras frst till sju bitar, varefter varje nods
+*                                  skalrprodukt berknas med heltal. Indatans nollpunkt
+*                                  kompenseras via nodens viktsumma, varefter summan skalas
+*                                  tillbaka till flyttal, adderas till nodens bias och
+*                                  passerar ReLU.
+*
+*                                  - self           : Pekare till det kvantiserade lagret.
+*                                  - input          : Pekare till lagrets indata.
+*                                  - quantized_input: Arbetsminne fr kvantiserad indata.
+**************************************************************************************************/
+static void ann_quantized_layer_feedforward(struct ann_quantized_layer* self,
+                                            const ann_real* input,
+                                            uint8_t* quantized_input)
+{
+   double input_scale = 0;
+   int32_t zero_point = 0;
+   quantize_input(input, self->num_weights, quantized_input, &input_scale, &zero_point);
+
+   for (size_t i = 0; i < self->num_nodes; ++i)
+   {
+      const int8_t* weights = self->weights + i * self->stride;
+      const int64_t product = (int64_t)simd_dot_u8s8(quantized_input, weights,
+                                                     self->num_weights) -
+         (int64_t)zero_point * self->sums[i];
+      const ann_real sum = self->bias[i] +
+         (ann_real)(self->scales[i] * input_scale * (double)product);
+      self->output[i] = sum > 0 ? sum : 0;
+   }
+   return;
+}
+
+/**************************************************************************************************
+* quantize_input: Kvantiserar angiven indata asymmetriskt till heltal i intervallet [0, 127],
+*                 dr intervallet mellan indatans minsta och strsta vrde (inklusive noll)
+*                 delas upp i 127 steg. Det verkliga vrdet motsvarar (q - zero_point) * scale,
+*                 vilket fr indata utan negativa vrden, exempelvis utsignaler efter ReLU,
+*                 innebr att nollpunkten r noll. Ifall samtliga vrden r noll stts
+*                 skalfaktorn till noll.
+*
+*                 - input     : Pekare till indatan.
+*                 - size      : Antalet element i indatan.
+*                 - output    : Pekare till flt dr kvantiserad indata lagras.
+*                 - scale     : Pekare till variabel dr skalfaktorn lagras.
+*                 - zero_point: Pekare till variabel dr nollpunkten lagras.
+**************************************************************************************************/
+static void quantize_input(const ann_real* input,
+                           const size_t size,
+                           uint8_t* output,
+                           double* scale,
+                           int32_t* zero_point)
+{
+   double min = 0, max = 0, inverse = 0;
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      if (input[i] < min) min = input[i];
+      if (input[i] > max) max = input[i];
+   }
+
+   if (max == min)
+   {
+      memset(output, 0, size);
+      *scale = 0;
+      *zero_point = 0;
+      return;
+   }
+
+   *scale = (max - min) / ANN_QUANTIZED_INPUT_MAX;
+   *zero_point = (int32_t)round_nearest(-min / *scale);
+   inverse = 1.0 / *scale;
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      const long value = round_nearest(input[i] * inverse) + *zero_point;
+      output[i] = (uint8_t)(value < 0 ? 0 : value > ANN_QUANTIZED_INPUT_MAX ?
+                            ANN_QUANTIZED_INPUT_MAX : value);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* round_nearest: Returnerar angivet vrde avrundat till nrmaste heltal, dr vrden mitt emellan
+*                tv heltal avrundas bort frn noll.
+*
+*                - value: Vrdet som skall avrundas.
+**************************************************************************************************/
+static inline long round_nearest(const double value)
+{
+   return value < 0 ? -(long)(0.5 - value) : (long)(value + 0.5);
+}
+
+/**************************************************************************************************
+* get_time: Returnerar aktuell tid i sekunder, anvnds fr att mta genomstrmning.
+**************************************************************************************************/
+static double get_time(void)
+{
+   struct timespec time;
+   timespec_get(&time, TIME_UTC);
+   return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
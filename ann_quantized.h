@@ -0,0 +1,72 @@
+/**************************************************************************************************
+* ann_quantized.h: Innehller funktionalitet fr kvantiserad inferens via strukten ann_quantized
+*                  samt motsvarande externa funktioner. Ett trnat neuralt ntverk konverteras
+*                  i efterhand till en modell dr vikterna lagras som 8-bitars heltal med en
+*                  skalfaktor per nod, vilket minskar viktmatrisernas storlek till en fjrdedel
+*                  (enkel precision) eller en ttondel (dubbel precision). Vid feedforward
+*                  kvantiseras ven varje lagers indata till 8-bitars heltal, varefter
+*                  skalrprodukterna berknas med heltalsinstruktioner och ackumuleras i 32 bitar.
+**************************************************************************************************/
+#ifndef ANN_QUANTIZED_H_
+#define ANN_QUANTIZED_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "ann.h"
+#include "aligned_memory.h"
+#include "simd.h"
+#include "double_2d_vector.h"
+#include <string.h>
+
+/* Makrodefinitioner: */
+#define ANN_QUANTIZED_WEIGHT_MAX 127 /* Strsta kvantiserade vikt i absolutbelopp. */
+#define ANN_QUANTIZED_INPUT_MAX  127 /* Strsta kvantiserade indata (sju bitar utan tecken). */
+
+/**************************************************************************************************
+* ann_quantized_layer: Kvantiserat dense-lager. Nod i:s vikter lagras som heltal i intervallet
+*                      [-127, 127] med start p index i * stride, dr den verkliga vikten r
+*                      heltalet multiplicerat med nodens skalfaktor. Summan av varje nods
+*                      kvantiserade vikter lagras fr att kompensera fr indatans nollpunkt.
+**************************************************************************************************/
+struct ann_quantized_layer
+{
+   int8_t* weights;    /* Kvantiserad viktmatris (num_nodes x stride), lagrad radvis. */
+   float* scales;      /* Skalfaktor fr respektive nods vikter. */
+   int32_t* sums;      /* Summan av respektive nods kvantiserade vikter. */
+   ann_real* bias;     /* Biasvrden fr respektive nod (ej kvantiserade). */
+   ann_real* output;   /* Utsignaler frn respektive nod. */
+   size_t num_nodes;   /* Antalet noder i lagret. */
+   size_t num_weights; /* Antalet vikter per nod. */
+   size_t stride;      /* Avstndet mellan tv noders vikter i viktmatrisen. */
+};
+
+/**************************************************************************************************
+* ann_quantized: Kvantiserad modell fr inferens, innehllande ett kvantiserat lager fr varje
+*                dolt lager samt utgngslagret i det ursprungliga ntverket. Modellen r
+*                fristende, s att det ursprungliga ntverket kan raderas efter konvertering.
+**************************************************************************************************/
+struct ann_quantized
+{
+   struct ann_quantized_layer* layers; /* Kvantiserade lager, dolda lager fljda av det yttre. */
+   size_t num_layers;                  /* Antalet lager. */
+   uint8_t* input;                     /* Arbetsminne fr aktuellt lagers kvantiserade indata. */
+   ann_real* input_layer;              /* Insignaler i ingngslagret. */
+   size_t num_inputs;                  /* Antalet insignaler. */
+   size_t num_outputs;                 /* Antalet utsignaler. */
+};
+
+/* Externa funktioner: */
+int ann_quantized_new(struct ann_quantized* self,
+                      const struct ann* ann);
+void ann_quantized_delete(struct ann_quantized* self);
+struct ann_quantized* ann_quantized_ptr_new(const struct ann* ann);
+void ann_quantized_ptr_delete(struct ann_quantized** self);
+ann_real* ann_quantized_predict(struct ann_quantized* self,
+                                const struct double_vector* input);
+size_t ann_quantized_size(const struct ann_quantized* self);
+int ann_quantized_report(struct ann_quantized* self,
+                         struct ann* ann,
+                         const struct double_2d_vector* inputs,
+                         FILE* ostream);
+
+#endif /* ANN_QUANTIZED_H_ */
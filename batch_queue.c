@@ -0,0 +1,198 @@
+/**************************************************************************************************
+* batch_queue.c: Innehller funktionsdefinitioner som anvnds fr en lsfri k av trningsklara
+*                batcher med en producent och en konsument.
+**************************************************************************************************/
+#include "batch_queue.h"
+
+/* Statiska funktioner: */
+static int batch_queue_run(void* arg);
+static void batch_queue_produce(struct batch_queue* self);
+
+/**************************************************************************************************
+* batch_queue_new: Initierar en k av trningsklara batcher frn angiven trningsdata fr
+*                  angivet antal epoker, dr varje plats dimensioneras efter angivet
+*                  arbetsminne. Minne allokeras fr samtliga platser, varefter producenttrden
+*                  startas. Ifall trden inte kan startas produceras batcherna i stllet vid
+*                  behov av den konsumerande trden. Vid misslyckad minnesallokering eller
+*                  ifall antalet platser eller batchstorleken r noll returneras 1, annars 0.
+*
+*                  - self      : Pekare till kn.
+*                  - data      : Pekare till trningsdatan som batcherna hmtas frn.
+*                  - batch     : Pekare till arbetsminnet som batcherna skall trnas med.
+*                  - num_slots : Antalet platser i kn.
+*                  - num_epochs: Antalet epoker som skall produceras.
+**************************************************************************************************/
+int batch_queue_new(struct batch_queue* self,
+                    struct training_data* data,
+                    const struct ann_batch* batch,
+                    const size_t num_slots,
+                    const size_t num_epochs)
+{
+   const size_t input_size = sizeof(ann_real) * batch->batch_size * batch->input_stride;
+   const size_t reference_size = sizeof(ann_real) * batch->batch_size * batch->reference_stride;
+
+   self->data = data;
+   self->slots = 0;
+   self->num_slots = num_slots;
+   self->batch_size = batch->batch_size;
+   self->input_stride = batch->input_stride;
+   self->reference_stride = batch->reference_stride;
+   self->batches_per_epoch = 0;
+   self->num_batches = 0;
+   self->produced = 0;
+   self->started = false;
+   atomic_init(&self->head, 0);
+   atomic_init(&self->tail, 0);
+   atomic_init(&self->stop, false);
+
+   if (!num_slots || !self->batch_size) return 1;
+   self->batches_per_epoch = (data->sets + self->batch_size - 1) / self->batch_size;
+   self->num_batches = num_epochs * self->batches_per_epoch;
+   self->slots = (struct batch_queue_slot*)calloc(num_slots, sizeof(struct batch_queue_slot));
+   if (!self->slots) return 1;
+
+   for (size_t i = 0; i < num_slots; ++i)
+   {
+      struct batch_queue_slot* slot = &self->slots[i];
+      slot->input = (ann_real*)aligned_memory_alloc(input_size);
+      slot->reference = (ann_real*)aligned_memory_alloc(reference_size);
+
+      if (!slot->input || !slot->reference)
+      {
+         batch_queue_delete(self);
+         return 1;
+      }
+
+      memset(slot->input, 0, input_size);
+      memset(slot->reference, 0, reference_size);
+   }
+
+   self->started = thrd_create(&self->thread, batch_queue_run, self) == thrd_success;
+   return 0;
+}
+
+/**************************************************************************************************
+* batch_queue_delete: Avbryter producenttrden, ifall den fortfarande r aktiv, och frigr
+*                     minnet fr samtliga platser i angiven k.
+*
+*                     - self: Pekare till kn.
+**************************************************************************************************/
+void batch_queue_delete(struct batch_queue* self)
+{
+   atomic_store(&self->stop, true);
+
+   if (self->started)
+   {
+      thrd_join(self->thread, 0);
+      self->started = false;
+   }
+
+   for (size_t i = 0; self->slots && i < self->num_slots; ++i)
+   {
+      aligned_memory_free(self->slots[i].input);
+      aligned_memory_free(self->slots[i].reference);
+   }
+
+   free(self->slots);
+   self->slots = 0;
+   self->num_slots = 0;
+   self->data = 0;
+   return;
+}
+
+/**************************************************************************************************
+* batch_queue_pop: Hmtar nsta batch ur angiven k till angivet arbetsminne, vilket mste vara
+*                  samma arbetsminne som kn initierades med. Vid behov vntar funktionen tills
+*                  producenten har publicerat batchen. Batchen kopieras inte, utan arbetsminnets
+*                  flt fr in- och referensdata byter plats med platsens flt, varefter
+*                  platsen lmnas tillbaka till producenten. Ifall samtliga batcher redan har
+*                  hmtats returneras 1, annars 0.
+*
+*                  - self    : Pekare till kn.
+*                  - batch   : Pekare till arbetsminnet som batchen skall hmtas till.
+*                  - num_rows: Pekare till variabeln som antalet uppsttningar lagras i.
+**************************************************************************************************/
+int batch_queue_pop(struct batch_queue* self,
+                    struct ann_batch* batch,
+                    size_t* num_rows)
+{
+   const size_t tail = atomic_load_explicit(&self->tail, memory_order_relaxed);
+   struct batch_queue_slot* slot = 0;
+   ann_real* input = 0;
+   ann_real* reference = 0;
+   if (tail == self->num_batches) return 1;
+
+   while (atomic_load_explicit(&self->head, memory_order_acquire) == tail)
+   {
+      if (self->started)
+      {
+         thrd_yield();
+      }
+      else
+      {
+         batch_queue_produce(self);
+      }
+   }
+
+   slot = &self->slots[tail % self->num_slots];
+   input = batch->input;
+   reference = batch->reference;
+   batch->input = slot->input;
+   batch->reference = slot->reference;
+   slot->input = input;
+   slot->reference = reference;
+   *num_rows = slot->num_rows;
+
+   atomic_store_explicit(&self->tail, tail + 1, memory_order_release);
+   return 0;
+}
+
+/**************************************************************************************************
+* batch_queue_run: Producerar samtliga batcher i angiven k, dr producenten vntar s lnge
+*                  samtliga platser r upptagna. Utgr startfunktion fr producenttrden och
+*                  returnerar alltid 0.
+*
+*                  - arg: Pekare till kn (struct batch_queue).
+**************************************************************************************************/
+static int batch_queue_run(void* arg)
+{
+   struct batch_queue* self = (struct batch_queue*)arg;
+
+   while (self->produced < self->num_batches && !atomic_load(&self->stop))
+   {
+      const size_t tail = atomic_load_explicit(&self->tail, memory_order_acquire);
+
+      if (self->produced - tail == self->num_slots)
+      {
+         thrd_yield();
+      }
+      else
+      {
+         batch_queue_produce(self);
+      }
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* batch_queue_produce: Kopierar nsta batch till nsta lediga plats i angiven k och publicerar
+*                      platsen. Infr varje epoks frsta batch randomiseras ordningen p
+*                      trningsuppsttningarna. Anroparen ansvarar fr att en ledig plats finns.
+*
+*                      - self: Pekare till kn.
+**************************************************************************************************/
+static void batch_queue_produce(struct batch_queue* self)
+{
+   const size_t position = self->produced % self->batches_per_epoch * self->batch_size;
+   const size_t remaining = self->data->sets - position;
+   struct batch_queue_slot* slot = &self->slots[self->produced % self->num_slots];
+
+   if (!position) training_data_shuffle(self->data);
+   slot->num_rows = remaining < self->batch_size ? remaining : self->batch_size;
+   training_data_gather(self->data, position, slot->num_rows, slot->input, self->input_stride,
+                        slot->reference, self->reference_stride);
+
+   self->produced++;
+   atomic_store_explicit(&self->head, self->produced, memory_order_release);
+   return;
+}
@@ -0,0 +1,70 @@
+/**************************************************************************************************
+* batch_queue.h: Innehller funktionalitet fr en begrnsad k av trningsklara batcher via
+*                strukten batch_queue samt motsvarande externa funktioner. En producenttrd
+*                randomiserar ordningen p trningsuppsttningarna infr varje epok och kopierar
+*                uppsttningarna batch fr batch till kns platser, medan den trnande trden
+*                enbart hmtar frdiga batcher ur kn. Drmed verlappar datahanteringen med
+*                berkningarna. Kn har exakt en producent och en konsument och r lsfri, dr
+*                platsernas garskap verlmnas via tv atomiska rknare.
+**************************************************************************************************/
+#ifndef BATCH_QUEUE_H_
+#define BATCH_QUEUE_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "aligned_memory.h"
+#include "ann_batch.h"
+#include "training_data.h"
+#include <stdatomic.h>
+#include <threads.h>
+
+/* Makrodefinitioner: */
+#define BATCH_QUEUE_NUM_SLOTS 8 /* Standardantal platser i kn. */
+
+/**************************************************************************************************
+* batch_queue_slot: Plats i kn, som rymmer in- och referensdata fr en batch lagrade radvis med
+*                   samma radavstnd som i arbetsminnet fr en batch (struct ann_batch).
+**************************************************************************************************/
+struct batch_queue_slot
+{
+   ann_real* input;     /* Insignaler (batch_size x input_stride). */
+   ann_real* reference; /* Referensvrden (batch_size x reference_stride). */
+   size_t num_rows;     /* Antalet uppsttningar i batchen. */
+};
+
+/**************************************************************************************************
+* batch_queue: Begrnsad k av trningsklara batcher med en producent och en konsument.
+*              Producenten ger platserna frn tail till head, medan konsumenten ger platsen
+*              vid tail s lnge den r publicerad. Trningsdatans ordningsfljd ndras av
+*              producenten och fr drfr inte anvndas s lnge kn anvnds.
+**************************************************************************************************/
+struct batch_queue
+{
+   struct training_data* data;     /* Trningsdatan som batcherna hmtas frn. */
+   struct batch_queue_slot* slots; /* Kns platser. */
+   size_t num_slots;               /* Antalet platser i kn. */
+   size_t batch_size;              /* Maximalt antal uppsttningar per batch. */
+   size_t input_stride;            /* Avstndet mellan tv rader med insignaler. */
+   size_t reference_stride;        /* Avstndet mellan tv rader med referensvrden. */
+   size_t num_batches;             /* Totalt antal batcher som skall produceras. */
+   size_t batches_per_epoch;       /* Antalet batcher per epok. */
+   size_t produced;                /* Antalet producerade batcher (enbart producenten). */
+   atomic_size_t head;             /* Antalet publicerade batcher. */
+   atomic_size_t tail;             /* Antalet batcher som konsumenten har lmnat tillbaka. */
+   atomic_bool stop;               /* Indikerar att producenten skall avbrytas i frtid. */
+   thrd_t thread;                  /* Producenttrden. */
+   bool started;                   /* Indikerar ifall producenttrden r startad. */
+};
+
+/* Externa funktioner: */
+int batch_queue_new(struct batch_queue* self,
+                    struct training_data* data,
+                    const struct ann_batch* batch,
+                    const size_t num_slots,
+                    const size_t num_epochs);
+void batch_queue_delete(struct batch_queue* self);
+int batch_queue_pop(struct batch_queue* self,
+                    struct ann_batch* batch,
+                    size_t* num_rows);
+
+#endif /* BATCH_QUEUE_H_ */
@@ -10,4 +10,18 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+/**************************************************************************************************
+* ann_real: Flyttalstyp fr ntverkens parametrar, utsignaler och avvikelser samt fr inlst
+*           trningsdata, inklusive dess binra filformat. Som default anvnds dubbel precision.
+*           Vid kompilering med ANN_SINGLE_PRECISION definierat anvnds i stllet enkel precision
+*           (float), vilket halverar minnestgngen fr bde ntverk och trningsdata och
+*           dubblerar antalet flyttal per vektorregister, exempelvis via fljande kommando:
+*           $ gcc *.c -o main -Wall -DANN_SINGLE_PRECISION
+**************************************************************************************************/
+#ifdef ANN_SINGLE_PRECISION
+typedef float ann_real;
+#else
+typedef double ann_real;
+#endif
+
 #endif /* DEF_H_ */
\ No newline at end of file
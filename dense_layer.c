@@ -10,15 +10,39 @@ static void dense_layer_set_nodes(struct dense_layer* self,
                                   const size_t num_nodes);
 static void dense_layer_set_weights(struct dense_layer* self, 
                                     const size_t num_weights);
+static ann_real* dense_layer_alloc(const size_t num_nodes, 
+                                   const size_t stride);
+static void dense_layer_free_parameters(struct dense_layer* self);
+static ann_real* alloc_zeroed(const size_t size);
+static void update_active_inputs(ann_real* input_error,
+                                 const ann_real error,
+                                 ann_real* weights,
+                                 const ann_real change_rate,
+                                 const ann_real* input,
+                                 const size_t* active,
+                                 const size_t num_active);
+static void dense_layer_init_node(ann_real* weights, 
+                                  ann_real* bias, 
+                                  const size_t num_weights);
+static inline ann_real dense_layer_dot(const struct dense_layer* self,
+                                       const size_t node,
+                                       const ann_real* input);
+static void store_columns(struct dense_layer* self,
+                          const size_t node,
+                          const uint32_t* indices,
+                          const size_t* columns,
+                          const size_t size);
+static inline uint16_t encode_weight(const enum dense_layer_format format,
+                                     const ann_real value);
 static inline double get_random_start_val(void);
-static inline double relu(const double x);
-static inline double delta_relu(const double x);
-static void print_line(const struct double_vector* self, 
+static void print_line(const ann_real* data, 
+                       const size_t size,
                        FILE* ostream);
 
 /**************************************************************************************************
 * dense_layer_new: Initierar angivet dense-lager. Minne allokeras fr lagrets noder och samtliga 
-*                  parametrar tilldelas startvrden.
+*                  parametrar tilldelas startvrden. Berkningskrnorna vljs via simd_init,
+*                  ifall detta inte redan har skett.
 * 
 *                  - self       : Pekare till dense-lagret.
 *                  - num_nodes  : Antalet noder som skall tillfras i dense-lagret.
@@ -28,16 +52,61 @@ void dense_layer_new(struct dense_layer* self,
                      const size_t num_nodes, 
                      const size_t num_weights)
 {
-   double_vector_new(&self->output);
-   double_vector_new(&self->bias);
-   double_vector_new(&self->error);
-   double_2d_vector_new(&self->weights);
+   simd_init();
+   self->output = 0;
+   self->error = 0;
+   self->weights = 0;
+   self->bias = 0;
+   self->active = 0;
    self->num_nodes = num_nodes;
    self->num_weights = num_weights;
+   self->stride = aligned_memory_stride(num_weights, sizeof(ann_real));
+   self->num_active = 0;
+   self->external = false;
+   self->half_weights = 0;
+   self->half_stride = 0;
+   self->format = DENSE_LAYER_FORMAT_REAL;
    dense_layer_init(self);
    return;
 }
 
+/**************************************************************************************************
+* dense_layer_new_external: Initierar angivet dense-lager med ett befintligt parameterblock,
+*                           exempelvis ett block i en minnesmappad modellfil. Blocket mste vara
+*                           cachejusterat och ha samma layout som lagrets egna parameterblock,
+*                           allts rymma dense_layer_parameter_size(num_nodes, num_weights)
+*                           flyttal. Parametrarna kopieras inte och blocket frigrs inte nr
+*                           lagret raderas. Ifall lagret ndras i storlek kopieras parametrarna
+*                           till ett nytt block som gs av lagret. Berkningskrnorna vljs
+*                           via simd_init, ifall detta inte redan har skett.
+*
+*                           - self       : Pekare till dense-lagret.
+*                           - num_nodes  : Antalet noder i dense-lagret.
+*                           - num_weights: Antalet vikter per nod.
+*                           - parameters : Pekare till parameterblocket.
+**************************************************************************************************/
+void dense_layer_new_external(struct dense_layer* self,
+                              const size_t num_nodes,
+                              const size_t num_weights,
+                              ann_real* parameters)
+{
+   simd_init();
+   self->num_nodes = num_nodes;
+   self->num_weights = num_weights;
+   self->stride = aligned_memory_stride(num_weights, sizeof(ann_real));
+   self->external = true;
+   self->output = alloc_zeroed(num_nodes);
+   self->error = alloc_zeroed(num_nodes);
+   self->active = (size_t*)malloc(sizeof(size_t) * (num_nodes ? num_nodes : 1));
+   self->num_active = 0;
+   self->weights = parameters;
+   self->bias = parameters + num_nodes * self->stride;
+   self->half_weights = 0;
+   self->half_stride = 0;
+   self->format = DENSE_LAYER_FORMAT_REAL;
+   return;
+}
+
 /**************************************************************************************************
 * dense_layer_delete: Nollstller angivet dense-lager.
 * 
@@ -45,12 +114,10 @@ void dense_layer_new(struct dense_layer* self,
 **************************************************************************************************/
 void dense_layer_delete(struct dense_layer* self)
 {
-   double_vector_delete(&self->output);
-   double_vector_delete(&self->bias);
-   double_vector_delete(&self->error);
-   double_2d_vector_delete(&self->weights);
+   dense_layer_clear(self);
    self->num_nodes = 0;
    self->num_weights = 0;
+   self->stride = 0;
    return;
 }
 
@@ -84,16 +151,27 @@ void dense_layer_ptr_delete(struct dense_layer** self)
 }
 
 /**************************************************************************************************
-* dense_layer_clear: Nollstller parametrar i angivet dense-lager.
+* dense_layer_clear: Nollstller parametrar i angivet dense-lager. Eventuell komprimerad kopia
+*                    av vikterna frigrs, varefter vikterna lses i formatet ann_real.
 * 
 *                    - self: Pekare till dense-lagret.
 **************************************************************************************************/
 void dense_layer_clear(struct dense_layer* self)
 {
-   double_vector_delete(&self->output);
-   double_vector_delete(&self->bias);
-   double_vector_delete(&self->error);
-   double_2d_vector_delete(&self->weights);
+   aligned_memory_free(self->output);
+   aligned_memory_free(self->error);
+   free(self->active);
+   dense_layer_free_parameters(self);
+   aligned_memory_free(self->half_weights);
+   self->output = 0;
+   self->error = 0;
+   self->weights = 0;
+   self->bias = 0;
+   self->active = 0;
+   self->num_active = 0;
+   self->half_weights = 0;
+   self->half_stride = 0;
+   self->format = DENSE_LAYER_FORMAT_REAL;
    return;
 }
 
@@ -109,7 +187,8 @@ void dense_layer_reset(struct dense_layer* self)
    return;
 }
 /**************************************************************************************************
-* dense_layer_resize: ndrar antalet noder och/eller vikter i angivet dense-lager.
+* dense_layer_resize: ndrar antalet noder och/eller vikter i angivet dense-lager. Eventuell
+*                     komprimerad kopia av vikterna skapas p nytt med samma format.
 * 
 *                     - self       : Pekare till dense-lagret.
 *                     - num_nodes  : Nytt antal noder i dense-lagret.
@@ -127,29 +206,199 @@ void dense_layer_resize(struct dense_layer* self,
    {
       dense_layer_set_weights(self, num_weights);
    }
+   if (self->format != DENSE_LAYER_FORMAT_REAL)
+   {
+      dense_layer_set_format(self, self->format);
+   }
    return;
 }
 
 /**************************************************************************************************
-* dense_layer_feedforward: Berknar ny utdata fr angivet dense-lager via ny indata.
+* dense_layer_set_format: Vljer format fr vikterna som lses vid feedforward i angivet
+*                         dense-lager. Vid fp16 eller bf16 skapas en komprimerad kopia av
+*                         viktmatrisen med 16 bitar per vikt, som lses av dense_layer_feedforward
+*                         och breddas till ann_real vid laddning, s att summeringen sker med
+*                         full precision. Viktmatrisen av typen ann_real behlls som huvudkopia,
+*                         vilken lses vid backpropagation, batchvis berkning samt lagring och
+*                         justeras vid trning, varefter justerade rader skrivs till den
+*                         komprimerade kopian. Trning med komprimerat format motsvarar drmed
+*                         trning med blandad precision. Vid formatet DENSE_LAYER_FORMAT_REAL
+*                         frigrs den komprimerade kopian. Vid misslyckad minnesallokering
+*                         returneras 1 och vikterna lses i formatet ann_real, annars 0.
+*
+*                         - self  : Pekare till dense-lagret.
+*                         - format: Format fr vikterna som lses vid feedforward.
+**************************************************************************************************/
+int dense_layer_set_format(struct dense_layer* self,
+                           const enum dense_layer_format format)
+{
+   aligned_memory_free(self->half_weights);
+   self->half_weights = 0;
+   self->half_stride = 0;
+   self->format = DENSE_LAYER_FORMAT_REAL;
+   if (format == DENSE_LAYER_FORMAT_REAL) return 0;
+   if (!self->weights) return 1;
+
+   self->half_stride = aligned_memory_stride(self->num_weights, sizeof(uint16_t));
+   self->half_weights = (uint16_t*)aligned_memory_alloc(sizeof(uint16_t) * self->num_nodes * 
+                                                        self->half_stride);
+   if (!self->half_weights)
+   {
+      self->half_stride = 0;
+      return 1;
+   }
+
+   memset(self->half_weights, 0, sizeof(uint16_t) * self->num_nodes * self->half_stride);
+   self->format = format;
+
+   for (size_t i = 0; i < self->num_nodes; ++i)
+   {
+      dense_layer_store_row(self, i);
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* dense_layer_store_row: Skriver angiven nods vikter frn huvudkopian till den komprimerade
+*                        kopian i angivet dense-lager, vilket skall gras efter att nodens
+*                        vikter har justerats utanfr lagrets egna funktioner, exempelvis vid
+*                        batchvis trning. Ifall lagret saknar komprimerad kopia grs ingenting.
+*
+*                        - self: Pekare till dense-lagret.
+*                        - node: Index fr noden vars vikter skall skrivas.
+**************************************************************************************************/
+void dense_layer_store_row(struct dense_layer* self,
+                           const size_t node)
+{
+   const ann_real* weights = 0;
+   uint16_t* half_weights = 0;
+   if (self->format == DENSE_LAYER_FORMAT_REAL) return;
+
+   weights = self->weights + node * self->stride;
+   half_weights = self->half_weights + node * self->half_stride;
+
+   if (self->format == DENSE_LAYER_FORMAT_FP16)
+   {
+      simd_encode_fp16(half_weights, weights, self->num_weights);
+   }
+   else
+   {
+      simd_encode_bf16(half_weights, weights, self->num_weights);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_feedforward: Berknar ny utdata fr angivet dense-lager via ny indata. Index fr
+*                          noder vars utsignal r positiv efter ReLU lagras i lagrets lista
+*                          ver aktiva noder. Vikterna lses i det format som har valts via
+*                          dense_layer_set_format.
 * 
 *                          - self : Pekare till dense-lagret.
-*                          - input: Pekare till vektor innehllande ny indata.
+*                          - input: Pekare till flt innehllande ny indata, en per vikt.
 **************************************************************************************************/
 void dense_layer_feedforward(struct dense_layer* self, 
-                             const struct double_vector* input)
+                             const ann_real* input)
 {
+   self->num_active = 0;
+
    for (size_t i = 0; i < self->num_nodes; ++i)
    {
-      double sum = self->bias.data[i];
-      struct double_vector* weights = &self->weights.data[i];
+      const ann_real sum = self->bias[i] + dense_layer_dot(self, i, input);
 
-      for (size_t j = 0; j < self->num_weights && j < input->size; ++j)
+      if (sum > 0)
+      {
+         self->output[i] = sum;
+         self->active[self->num_active++] = i;
+      }
+      else
       {
-         sum += input->data[j] * weights->data[j];
+         self->output[i] = 0;
       }
-      
-      self->output.data[i] = relu(sum);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_feedforward_sparse: Berknar ny utdata fr angivet dense-lager via ny gles indata,
+*                                 dr enbart indatans element skilda frn noll lagras. Varje
+*                                 nod hmtar enbart de vikter vars kolumner motsvarar dessa
+*                                 element, s att berkningen r proportionell mot antalet
+*                                 element i stllet fr antalet vikter. Index fr noder vars
+*                                 utsignal r positiv efter ReLU lagras i listan ver aktiva
+*                                 noder. Samtliga index mste understiga antalet vikter per nod.
+*
+*                                 - self   : Pekare till dense-lagret.
+*                                 - indices: Pekare till flt innehllande elementens index.
+*                                 - values : Pekare till flt innehllande elementens vrden.
+*                                 - size   : Antalet element i den glesa indatan.
+**************************************************************************************************/
+void dense_layer_feedforward_sparse(struct dense_layer* self,
+                                    const uint32_t* indices,
+                                    const double* values,
+                                    const size_t size)
+{
+   self->num_active = 0;
+
+   for (size_t i = 0; i < self->num_nodes; ++i)
+   {
+      const ann_real* weights = self->weights + i * self->stride;
+      ann_real sum = self->bias[i];
+
+      for (size_t k = 0; k < size; ++k)
+      {
+         sum += weights[indices[k]] * (ann_real)values[k];
+      }
+
+      if (sum > 0)
+      {
+         self->output[i] = sum;
+         self->active[self->num_active++] = i;
+      }
+      else
+      {
+         self->output[i] = 0;
+      }
+   }
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_feedforward_columns: Berknar utdata fr angivet dense-lager fr en hel batch, dr
+*                                  varje uppsttning lagras som en kolumn i stllet fr en rad.
+*                                  Indatan har en rad per vikt och utdatan en rad per nod, med
+*                                  en kolumn per uppsttning. Drmed kan samtliga uppsttningar
+*                                  i batchen berknas samtidigt via en matrisprodukt, dr varje
+*                                  vikt multipliceras med en hel rad indata. Lagret modifieras
+*                                  inte, vilket medfr att flera trdar kan anvnda det samtidigt.
+*
+*                                  - self         : Pekare till dense-lagret.
+*                                  - input        : Pekare till indata, en rad per vikt.
+*                                  - input_stride : Avstndet mellan tv rader i indatan.
+*                                  - output       : Pekare till fltet som utdatan skrivs till.
+*                                  - output_stride: Avstndet mellan tv rader i utdatan.
+*                                  - num_columns  : Antalet uppsttningar (kolumner) i batchen.
+**************************************************************************************************/
+void dense_layer_feedforward_columns(const struct dense_layer* self,
+                                     const ann_real* input,
+                                     const size_t input_stride,
+                                     ann_real* output,
+                                     const size_t output_stride,
+                                     const size_t num_columns)
+{
+   simd_matrix_product(output, output_stride, self->weights, self->stride, input, input_stride,
+                       self->num_nodes, self->num_weights, num_columns);
+
+   for (size_t i = 0; i < self->num_nodes; ++i)
+   {
+      ann_real* row = output + i * output_stride;
+
+      for (size_t j = 0; j < num_columns; ++j)
+      {
+         row[j] += self->bias[i];
+      }
+
+      simd_relu(row, num_columns);
    }
    return;
 }
@@ -159,17 +408,18 @@ void dense_layer_feedforward(struct dense_layer* self,
 *                                     med referensvrden frn trningsdatan. 
 * 
 *                                     - self     : Pekare till dense-lagret.
-*                                     - reference: Pekare till vektor innehllande referensvrden
-*                                                  frn trningsdata.
+*                                     - reference: Pekare till flt innehllande referensvrden
+*                                                  frn trningsdata, ett per nod.
 **************************************************************************************************/
 void dense_layer_compare_with_reference(struct dense_layer* self, 
-                                        const struct double_vector* reference)
+                                        const ann_real* reference)
 {
-   for (size_t i = 0; i < self->num_nodes && i < reference->size; ++i)
+   for (size_t i = 0; i < self->num_nodes; ++i)
    {
-      const double error = reference->data[i] - self->output.data[i];
-      self->error.data[i] = error * delta_relu(self->output.data[i]);
+      self->error[i] = reference[i] - self->output[i];
    }
+
+   simd_delta_relu(self->error, self->output, self->num_nodes);
    return;
 }
 
@@ -184,50 +434,204 @@ void dense_layer_compare_with_reference(struct dense_layer* self,
 void dense_layer_backpropagate(struct dense_layer* self, 
                                const struct dense_layer* next_layer)
 {
-   for (size_t i = 0; i < self->num_nodes; ++i)
-   {
-      double deviation = 0;
-
-      for (size_t j = 0; j < next_layer->num_nodes; ++j)
-      {
-         const struct double_vector* weights = &next_layer->weights.data[j];
-         deviation += next_layer->error.data[j] * weights->data[i];
-      }
-
-      self->error.data[i] = deviation * delta_relu(self->output.data[i]);
-   }
+   simd_transpose_product(self->error, next_layer->weights, next_layer->stride, 
+                          next_layer->error, next_layer->num_nodes, self->num_nodes);
+   simd_delta_relu(self->error, self->output, self->num_nodes);
    return;
 }
 
 /**************************************************************************************************
 * dense_layer_optimize: Justerar bias samt vikter fr angivet dense-lager med angiven 
 *                       lrhastighet fr att minska fel. Utdatan frn fregende lager, som utgr
-*                       indata p angivet lager, anvnds fr att justera vikterna.
+*                       indata p angivet lager, anvnds fr att justera vikterna. Enbart noder
+*                       som var aktiva vid senaste feedforward justeras, d vriga noders
+*                       avvikelser r noll.
 *                       
 *                       - self         : Pekare till angivet dense-lager.
-*                       - input        : Pekare till vektor innehllande utdata frn fregende 
+*                       - input        : Pekare till flt innehllande utdata frn fregende 
 *                                        dense-lager, vilket utgr indata till angivet lager.
 *                       - learning_rate: Lrhastigheten, avgr graden av justering vid avvikelse.
 **************************************************************************************************/
 void dense_layer_optimize(struct dense_layer* self, 
-                          const struct double_vector* input,
+                          const ann_real* input,
                           const double learning_rate)
 {
-   for (size_t i = 0; i < self->num_nodes; ++i)
+   for (size_t k = 0; k < self->num_active; ++k)
+   {
+      const size_t i = self->active[k];
+      const ann_real change_rate = (ann_real)(self->error[i] * learning_rate);
+      ann_real* weights = self->weights + i * self->stride;
+      self->bias[i] += change_rate;
+      simd_axpy(weights, change_rate, input, self->num_weights);
+      dense_layer_store_row(self, i);
+   }
+
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_optimize_sparse: Justerar bias samt vikter fr angivet dense-lager med angiven
+*                              lrhastighet utifrn gles indata. Vikter vars indata r noll
+*                              pverkas inte av justeringen, s enbart kolumnerna fr indatans
+*                              element skilda frn noll justeras. Enbart noder som var aktiva
+*                              vid senaste feedforward justeras, d vriga noders avvikelser r
+*                              noll.
+*
+*                              - self         : Pekare till dense-lagret.
+*                              - indices      : Pekare till flt innehllande elementens index.
+*                              - values       : Pekare till flt innehllande elementens vrden.
+*                              - size         : Antalet element i den glesa indatan.
+*                              - learning_rate: Lrhastigheten, avgr graden av justering vid
+*                                               avvikelse.
+**************************************************************************************************/
+void dense_layer_optimize_sparse(struct dense_layer* self,
+                                 const uint32_t* indices,
+                                 const double* values,
+                                 const size_t size,
+                                 const double learning_rate)
+{
+   for (size_t k = 0; k < self->num_active; ++k)
    {
-      const double change_rate = self->error.data[i] * learning_rate;
-      struct double_vector* weights = &self->weights.data[i];
-      self->bias.data[i] += change_rate;
+      const size_t i = self->active[k];
+      const ann_real change_rate = (ann_real)(self->error[i] * learning_rate);
+      ann_real* weights = self->weights + i * self->stride;
+      self->bias[i] += change_rate;
 
-      for (size_t j = 0; j < self->num_weights && j < input->size; ++j)
+      for (size_t j = 0; j < size; ++j)
       {
-         weights->data[j] += change_rate * input->data[j];
+         weights[indices[j]] += change_rate * (ann_real)values[j];
       }
+
+      store_columns(self, i, indices, 0, size);
    }
+   return;
+}
 
+/**************************************************************************************************
+* dense_layer_backpropagate_optimize: Berknar avvikelser i fregende dense-lager och justerar
+*                                     samtidigt bias samt vikter fr angivet dense-lager, vars
+*                                     avvikelser redan r berknade. Varje nods viktrad lses
+*                                     drmed en enda gng, dr radens bidrag till fregende
+*                                     lagers avvikelser berknas med vikternas vrden fre
+*                                     justeringen, direkt fljt av justeringen medan raden
+*                                     fortfarande ligger i cacheminnet. Resultatet blir drmed
+*                                     detsamma som vid anrop av dense_layer_backpropagate fr
+*                                     fregende lager fljt av dense_layer_optimize fr
+*                                     angivet lager. Ifall fregende lager saknas, vilket r
+*                                     fallet fr det frsta dolda lagret, justeras enbart
+*                                     parametrarna. Enbart noder som var aktiva vid senaste
+*                                     feedforward behandlas, d vriga noders avvikelser r
+*                                     noll. Ifall hgst var DENSE_LAYER_SPARSE_LIMIT:e nod i
+*                                     fregende lager r aktiv behandlas dessutom enbart de
+*                                     vikter som hr till aktiva indata, d vriga indata r
+*                                     noll och varken pverkar vikterna eller avvikelserna.
+*
+*                                     - self          : Pekare till angivet dense-lager.
+*                                     - input         : Pekare till flt innehllande indata
+*                                                       till angivet lager, allts utdata frn
+*                                                       fregende lager.
+*                                     - previous_layer: Pekare till fregende dense-lager, vars
+*                                                       avvikelser skall berknas (eller null).
+*                                     - learning_rate : Lrhastigheten, avgr graden av
+*                                                       justering vid avvikelse.
+**************************************************************************************************/
+void dense_layer_backpropagate_optimize(struct dense_layer* self,
+                                        const ann_real* input,
+                                        struct dense_layer* previous_layer,
+                                        const double learning_rate)
+{
+   const bool sparse = previous_layer && 
+      previous_layer->num_active * DENSE_LAYER_SPARSE_LIMIT <= previous_layer->num_nodes;
+
+   if (previous_layer)
+   {
+      memset(previous_layer->error, 0, sizeof(ann_real) * previous_layer->num_nodes);
+   }
+
+   for (size_t k = 0; k < self->num_active; ++k)
+   {
+      const size_t i = self->active[k];
+      const ann_real change_rate = (ann_real)(self->error[i] * learning_rate);
+      ann_real* weights = self->weights + i * self->stride;
+      self->bias[i] += change_rate;
+
+      if (sparse)
+      {
+         update_active_inputs(previous_layer->error, self->error[i], weights, change_rate, input,
+                              previous_layer->active, previous_layer->num_active);
+         store_columns(self, i, 0, previous_layer->active, previous_layer->num_active);
+      }
+      else if (previous_layer)
+      {
+         simd_axpy_update(previous_layer->error, self->error[i], weights, change_rate, input,
+                          self->num_weights);
+         dense_layer_store_row(self, i);
+      }
+      else
+      {
+         simd_axpy(weights, change_rate, input, self->num_weights);
+         dense_layer_store_row(self, i);
+      }
+   }
+
+   if (previous_layer && !sparse)
+   {
+      simd_delta_relu(previous_layer->error, previous_layer->output, previous_layer->num_nodes);
+   }
    return;
 }
 
+/**************************************************************************************************
+* dense_layer_backpropagate_optimize_input: Motsvarar dense_layer_backpropagate_optimize utan
+*                                           fregende dense-lager, men berknar i stllet
+*                                           avvikelserna fr lagrets indata och lagrar dem i
+*                                           angivet flt. Indatan antas komma frn ett linjrt
+*                                           steg, exempelvis ett inbddningslager, s ingen
+*                                           derivata fr ReLU tillmpas p avvikelserna.
+*
+*                                           - self         : Pekare till dense-lagret.
+*                                           - input        : Pekare till lagrets indata.
+*                                           - input_error  : Pekare till fltet som
+*                                                            indatans avvikelser skrivs till,
+*                                                            ett per vikt.
+*                                           - learning_rate: Lrhastigheten, avgr graden av
+*                                                            justering vid avvikelse.
+**************************************************************************************************/
+void dense_layer_backpropagate_optimize_input(struct dense_layer* self,
+                                              const ann_real* input,
+                                              ann_real* input_error,
+                                              const double learning_rate)
+{
+   memset(input_error, 0, sizeof(ann_real) * self->num_weights);
+
+   for (size_t k = 0; k < self->num_active; ++k)
+   {
+      const size_t i = self->active[k];
+      const ann_real change_rate = (ann_real)(self->error[i] * learning_rate);
+      ann_real* weights = self->weights + i * self->stride;
+      self->bias[i] += change_rate;
+      simd_axpy_update(input_error, self->error[i], weights, change_rate, input,
+                       self->num_weights);
+      dense_layer_store_row(self, i);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_parameter_size: Returnerar antalet flyttal i parameterblocket fr ett dense-lager
+*                             med angivet antal noder och vikter per nod, allts viktmatrisen
+*                             fljd av biasvrdena, dr bda fyller ett helt antal cacherader.
+* 
+*                             - num_nodes  : Antalet noder i dense-lagret.
+*                             - num_weights: Antalet vikter per nod.
+**************************************************************************************************/
+size_t dense_layer_parameter_size(const size_t num_nodes,
+                                  const size_t num_weights)
+{
+   return num_nodes * aligned_memory_stride(num_weights, sizeof(ann_real)) + 
+      aligned_memory_stride(num_nodes, sizeof(ann_real));
+}
+
 /**************************************************************************************************
 * dense_layer_print: Skriver ut information gllande givet dense-lager via angiven utstrm, dr
 *                    standardutenheten stdout anvnds som default fr utskrift i terminalen.
@@ -246,21 +650,20 @@ void dense_layer_print(const struct dense_layer* self,
    fprintf(ostream, "----------------------------------------------------------------------------\n");
 
    fprintf(ostream, "Outputs: ");
-   print_line(&self->output, ostream);
+   print_line(self->output, self->num_nodes, ostream);
 
    fprintf(ostream, "Bias: ");
-   print_line(&self->bias, ostream);
+   print_line(self->bias, self->num_nodes, ostream);
 
    fprintf(ostream, "Error: ");
-   print_line(&self->error, ostream);
+   print_line(self->error, self->num_nodes, ostream);
 
    fprintf(ostream, "\nWeights:\n");
 
    for (size_t i = 0; i < self->num_nodes; ++i)
    {
       fprintf(ostream, "\tNode %zu: ", i + 1);
-      struct double_vector* weights = &self->weights.data[i];
-      print_line(weights, ostream);
+      print_line(self->weights + i * self->stride, self->num_weights, ostream);
    }
 
    fprintf(ostream, "----------------------------------------------------------------------------\n\n");
@@ -270,31 +673,25 @@ void dense_layer_print(const struct dense_layer* self,
 /**************************************************************************************************
 * dense_layer_init: Allokerar minne och stter startvrden p parametrar i angivet dense-lager.
 *                   Bias och vikter tilldelas randomiserade startvrden mellan 0.0 - 1.0, vriga
-*                   parametrar tilldelas 0.0 som startvrde.
+*                   parametrar tilldelas 0.0 som startvrde. Vikter och bias allokeras som ett
+*                   enda sammanhngande block, dr eventuell utfyllnad i slutet av varje rad
+*                   nollstlls.
 * 
 *                   - self: Pekare till dense-lagret.
 **************************************************************************************************/
 static void dense_layer_init(struct dense_layer* self)
 {
-   double_vector_resize(&self->output, self->num_nodes);
-   double_vector_resize(&self->bias, self->num_nodes);
-   double_vector_resize(&self->error, self->num_nodes);
-   double_2d_vector_resize(&self->weights, self->num_nodes);
+   self->output = alloc_zeroed(self->num_nodes);
+   self->error = alloc_zeroed(self->num_nodes);
+   self->active = (size_t*)malloc(sizeof(size_t) * (self->num_nodes ? self->num_nodes : 1));
+   self->num_active = 0;
+   self->weights = dense_layer_alloc(self->num_nodes, self->stride);
+   if (!self->weights) return;
+   self->bias = self->weights + self->num_nodes * self->stride;
 
    for (size_t i = 0; i < self->num_nodes; ++i)
    {
-      struct double_vector weights = { .data = 0, .size = 0 };
-      double_vector_resize(&weights, self->num_weights);
-
-      for (size_t j = 0; j < self->num_weights; ++j)
-      {
-         weights.data[j] = get_random_start_val();
-      }
-
-      self->output.data[i] = 0;
-      self->bias.data[i] = get_random_start_val();
-      self->error.data[i] = 0;
-      self->weights.data[i] = weights;
+      dense_layer_init_node(self->weights + i * self->stride, self->bias + i, self->num_weights);
    }
 
    return;
@@ -302,7 +699,8 @@ static void dense_layer_init(struct dense_layer* self)
 
 /**************************************************************************************************
 * dense_layer_set_nodes: Justerar antalet noder i angivet dense-lager. Ifall nya noder lggs till
-*                        s tilldelas startvrden till samtliga parametrar.
+*                        s tilldelas startvrden till samtliga parametrar. Befintliga vikter och
+*                        bias kopieras ver till ett nytt parameterblock av rtt storlek.
 * 
 *                        - self     : Pekare till dense-lagret.
 *                        - num_nodes: Nytt antal noder i dense-lagret.
@@ -310,30 +708,39 @@ static void dense_layer_init(struct dense_layer* self)
 static void dense_layer_set_nodes(struct dense_layer* self, 
                                   const size_t num_nodes)
 {
-   double_vector_resize(&self->output, num_nodes);
-   double_vector_resize(&self->bias, num_nodes);
-   double_vector_resize(&self->error, num_nodes);
-   double_2d_vector_resize(&self->weights, num_nodes);
+   const size_t num_kept = num_nodes < self->num_nodes ? num_nodes : self->num_nodes;
+   ann_real* weights = dense_layer_alloc(num_nodes, self->stride);
+   if (!weights) return;
+   ann_real* bias = weights + num_nodes * self->stride;
 
-   if (num_nodes > self->num_nodes)
+   for (size_t i = 0; i < num_kept; ++i)
    {
-      for (size_t i = self->num_nodes; i < num_nodes; ++i)
+      const ann_real* old_weights = self->weights + i * self->stride;
+      ann_real* new_weights = weights + i * self->stride;
+
+      for (size_t j = 0; j < self->stride; ++j)
       {
-         struct double_vector weights = { .data = 0, .size = 0 };
-         double_vector_resize(&weights, self->num_weights);
-
-         for (size_t j = 0; j < self->num_weights; ++j)
-         {
-            weights.data[j] = get_random_start_val();
-         }
-
-         self->output.data[i] = 0;
-         self->bias.data[i] = get_random_start_val(); 
-         self->error.data[i] = 0;
-         self->weights.data[i] = weights;
+         new_weights[j] = old_weights[j];
       }
+
+      bias[i] = self->bias[i];
+   }
+
+   for (size_t i = num_kept; i < num_nodes; ++i)
+   {
+      dense_layer_init_node(weights + i * self->stride, bias + i, self->num_weights);
    }
 
+   aligned_memory_free(self->output);
+   aligned_memory_free(self->error);
+   free(self->active);
+   dense_layer_free_parameters(self);
+   self->output = alloc_zeroed(num_nodes);
+   self->error = alloc_zeroed(num_nodes);
+   self->active = (size_t*)malloc(sizeof(size_t) * (num_nodes ? num_nodes : 1));
+   self->num_active = 0;
+   self->weights = weights;
+   self->bias = bias;
    self->num_nodes = num_nodes;
    return;
 }
@@ -341,6 +748,8 @@ static void dense_layer_set_nodes(struct dense_layer* self,
 /**************************************************************************************************
 * dense_layer_set_weights: Justerar antalet vikter fr varje nod i angivet dense-lager. Ifall
 *                          nya vikter lggs till initieras dessa med randomiserade startvrden.
+*                          Eftersom radavstndet kan ndras kopieras vikterna rad fr rad till
+*                          ett nytt parameterblock.
 * 
 *                          - self: Pekare till dense-lagret.
 *                          - num_weights: Nytt antal vikter per nod i dense-lagret.
@@ -348,69 +757,230 @@ static void dense_layer_set_nodes(struct dense_layer* self,
 static void dense_layer_set_weights(struct dense_layer* self, 
                                     const size_t num_weights)
 {
+   const size_t stride = aligned_memory_stride(num_weights, sizeof(ann_real));
+   const size_t num_kept = num_weights < self->num_weights ? num_weights : self->num_weights;
+   ann_real* weights = dense_layer_alloc(self->num_nodes, stride);
+   if (!weights) return;
+   ann_real* bias = weights + self->num_nodes * stride;
+
    for (size_t i = 0; i < self->num_nodes; ++i)
    {
-      double_vector_resize(&self->weights.data[i], num_weights);
-   }
+      const ann_real* old_weights = self->weights + i * self->stride;
+      ann_real* new_weights = weights + i * stride;
 
-   if (num_weights > self->num_weights)
-   {
-      for (size_t i = 0; i < self->num_nodes; ++i)
+      for (size_t j = 0; j < num_kept; ++j)
+      {
+         new_weights[j] = old_weights[j];
+      }
+      for (size_t j = num_kept; j < num_weights; ++j)
       {
-         struct double_vector* weights = &self->weights.data[i];
-         for (size_t j = self->num_weights; j < num_weights; ++j)
-         {
-            weights->data[j] = get_random_start_val();
-         }
+         new_weights[j] = (ann_real)get_random_start_val();
       }
+
+      bias[i] = self->bias[i];
    }
 
+   dense_layer_free_parameters(self);
+   self->weights = weights;
+   self->bias = bias;
    self->num_weights = num_weights;
+   self->stride = stride;
    return;
 }
 
 /**************************************************************************************************
-* get_random_start_val: Returnerar ett randomiserat flyttal mellan 0.0 - 1.0.
+* dense_layer_alloc: Allokerar ett nollstllt, cachejusterat parameterblock rymmande en
+*                    viktmatris med angivet antal rader och radavstnd, fljt av ett biasvrde
+*                    per rad. Vid misslyckad allokering returneras null.
+* 
+*                    - num_nodes: Antalet noder (rader i viktmatrisen).
+*                    - stride   : Radavstndet i viktmatrisen.
 **************************************************************************************************/
-static inline double get_random_start_val(void)
+static ann_real* dense_layer_alloc(const size_t num_nodes, 
+                                   const size_t stride)
+{
+   return alloc_zeroed(num_nodes * stride + aligned_memory_stride(num_nodes, sizeof(ann_real)));
+}
+
+/**************************************************************************************************
+* dense_layer_free_parameters: Frigr parameterblocket i angivet dense-lager, frutsatt att
+*                              blocket gs av lagret. Drefter gs nsta tilldelade block av
+*                              lagret.
+* 
+*                              - self: Pekare till dense-lagret.
+**************************************************************************************************/
+static void dense_layer_free_parameters(struct dense_layer* self)
 {
-   return rand() / (double)RAND_MAX;
+   if (!self->external)
+   {
+      aligned_memory_free(self->weights);
+   }
+   self->external = false;
+   return;
 }
 
 /**************************************************************************************************
-* relu: Returnerar ReLU (Rectified Linear Unit) ur angiven insignal x:
-*       x > 0.0  => ReLU(x) = x
-*       x <= 0.0 => ReLU(x) = 0.0
+* alloc_zeroed: Allokerar ett nollstllt, cachejusterat flt rymmande angivet antal flyttal.
+*               Vid misslyckad allokering returneras null.
 * 
-*       - x: Aktuell insignal.
+*               - size: Antalet flyttal som fltet skall rymma.
 **************************************************************************************************/
-static inline double relu(const double x)
+static ann_real* alloc_zeroed(const size_t size)
 {
-   return x > 0.0 ? x : 0.0;
+   ann_real* block = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * size);
+   if (!block) return 0;
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      block[i] = 0;
+   }
+   return block;
+}
+
+/**************************************************************************************************
+* update_active_inputs: Motsvarar simd_axpy_update fr en nods viktrad, men enbart fr de vikter
+*                       vars indata r aktiv, allts skild frn noll. vriga vikter pverkas
+*                       inte av justeringen och bidrar inte till fregende lagers avvikelser
+*                       efter ReLU, s de hoppas ver.
+*
+*                       - input_error: Pekare till fregende lagers avvikelser.
+*                       - error      : Nodens avvikelse.
+*                       - weights    : Pekare till nodens viktrad.
+*                       - change_rate: Justeringen per enhet indata.
+*                       - input      : Pekare till lagrets indata.
+*                       - active     : Pekare till index fr aktiva indata.
+*                       - num_active : Antalet aktiva indata.
+**************************************************************************************************/
+static void update_active_inputs(ann_real* input_error,
+                                 const ann_real error,
+                                 ann_real* weights,
+                                 const ann_real change_rate,
+                                 const ann_real* input,
+                                 const size_t* active,
+                                 const size_t num_active)
+{
+   for (size_t k = 0; k < num_active; ++k)
+   {
+      const size_t j = active[k];
+      input_error[j] += error * weights[j];
+      weights[j] += change_rate * input[j];
+   }
+   return;
 }
 
 /**************************************************************************************************
-* delta_relu: Returnerar derivatan av angiven insignal x:
-*             x > 0.0  => ReLU(x) = x   => ReLU'(x) = 1.0
-*             x <= 0.0 => ReLU(x) = 0.0 => ReLU'(x) = 0.0
+* dense_layer_init_node: Tilldelar randomiserade startvrden till en nods vikter samt bias.
 * 
-*             - x: Aktuell insignal.
+*                        - weights    : Pekare till nodens rad i viktmatrisen.
+*                        - bias       : Pekare till nodens biasvrde.
+*                        - num_weights: Antalet vikter per nod.
+**************************************************************************************************/
+static void dense_layer_init_node(ann_real* weights, 
+                                  ann_real* bias, 
+                                  const size_t num_weights)
+{
+   for (size_t j = 0; j < num_weights; ++j)
+   {
+      weights[j] = (ann_real)get_random_start_val();
+   }
+
+   *bias = (ann_real)get_random_start_val();
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_dot: Returnerar skalrprodukten mellan angiven nods vikter och angiven indata, dr
+*                  vikterna lses i det format som har valts fr dense-lagret.
+*
+*                  - self : Pekare till dense-lagret.
+*                  - node : Index fr noden.
+*                  - input: Pekare till lagrets indata.
+**************************************************************************************************/
+static inline ann_real dense_layer_dot(const struct dense_layer* self,
+                                       const size_t node,
+                                       const ann_real* input)
+{
+   if (self->format == DENSE_LAYER_FORMAT_FP16)
+   {
+      return simd_dot_fp16(self->half_weights + node * self->half_stride, input, 
+                           self->num_weights);
+   }
+   else if (self->format == DENSE_LAYER_FORMAT_BF16)
+   {
+      return simd_dot_bf16(self->half_weights + node * self->half_stride, input, 
+                           self->num_weights);
+   }
+   return simd_dot(self->weights + node * self->stride, input, self->num_weights);
+}
+
+/**************************************************************************************************
+* store_columns: Skriver angivna kolumner i angiven nods vikter frn huvudkopian till den
+*                komprimerade kopian, vilket anvnds efter glesa justeringar dr enbart vissa
+*                kolumner har ndrats. Kolumnernas index anges antingen via fltet indices
+*                eller fltet columns, dr det andra fltet stts till null. Ifall lagret saknar
+*                komprimerad kopia grs ingenting.
+*
+*                - self   : Pekare till dense-lagret.
+*                - node   : Index fr noden.
+*                - indices: Pekare till flt med kolumnernas index som uint32_t (eller null).
+*                - columns: Pekare till flt med kolumnernas index som size_t (eller null).
+*                - size   : Antalet kolumner.
+**************************************************************************************************/
+static void store_columns(struct dense_layer* self,
+                          const size_t node,
+                          const uint32_t* indices,
+                          const size_t* columns,
+                          const size_t size)
+{
+   const ann_real* weights = 0;
+   uint16_t* half_weights = 0;
+   if (self->format == DENSE_LAYER_FORMAT_REAL) return;
+
+   weights = self->weights + node * self->stride;
+   half_weights = self->half_weights + node * self->half_stride;
+
+   for (size_t k = 0; k < size; ++k)
+   {
+      const size_t j = indices ? (size_t)indices[k] : columns[k];
+      half_weights[j] = encode_weight(self->format, weights[j]);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* encode_weight: Returnerar angiven vikt konverterad till angivet komprimerat format.
+*
+*                - format: Det komprimerade formatet (fp16 eller bf16).
+*                - value : Vikten som skall konverteras.
 **************************************************************************************************/
-static inline double delta_relu(const double x)
+static inline uint16_t encode_weight(const enum dense_layer_format format,
+                                     const ann_real value)
+{
+   return format == DENSE_LAYER_FORMAT_FP16 ? 
+      half_float_fp16_from_real(value) : half_float_bf16_from_real(value);
+}
+
+/**************************************************************************************************
+* get_random_start_val: Returnerar ett randomiserat flyttal mellan 0.0 - 1.0 frn den anropande
+*                       trdens slumptalsgenerator.
+**************************************************************************************************/
+static inline double get_random_start_val(void)
 {
-   return x > 0.0 ? 1.0 : 0.0;
+   return random_generator_real(random_generator_local());
 }
 
 /**************************************************************************************************
-* print_line: Skriver ut flyttal lagrat i angiven vektor p en enda rad via angiven utstrm.
+* print_line: Skriver ut flyttal lagrade i angivet flt p en enda rad via angiven utstrm.
 * 
-*             - self   : Pekare till vektorn innehllande flyttalen som skall skrivas ut.
+*             - data   : Pekare till fltet innehllande flyttalen som skall skrivas ut.
+*             - size   : Antalet flyttal som skall skrivas ut.
 *             - ostream: Pekare till angiven utstrm.
 **************************************************************************************************/
-static void print_line(const struct double_vector* self, 
+static void print_line(const ann_real* data, 
+                       const size_t size,
                        FILE* ostream)
 {
-   for (const double* i = self->data; i < self->data + self->size; ++i)
+   for (const ann_real* i = data; i < data + size; ++i)
    {
       fprintf(ostream, "%g ", *i);
    }
@@ -7,27 +7,66 @@
 
 /* Inkluderingsdirektiv: */
 #include "def.h"
-#include "double_vector.h"
-#include "double_2d_vector.h"
+#include "aligned_memory.h"
+#include "simd.h"
+#include "random_generator.h"
+#include "half_float.h"
+#include <string.h>
+
+/* Makrodefinitioner: */
+#define DENSE_LAYER_SPARSE_LIMIT 4 /* Glesa uppdateringar nr hgst var fjrde indata r aktiv. */
+
+/**************************************************************************************************
+* dense_layer_format: Format fr vikterna som lses vid feedforward. Vid format skilda frn
+*                     DENSE_LAYER_FORMAT_REAL lagras en komprimerad kopia av vikterna som flyttal
+*                     p 16 bitar, vilket halverar (enkel precision) eller kvarttar (dubbel
+*                     precision) mngden viktdata som lses per nod.
+**************************************************************************************************/
+enum dense_layer_format
+{
+   DENSE_LAYER_FORMAT_REAL, /* Vikterna lses direkt som ann_real. */
+   DENSE_LAYER_FORMAT_FP16, /* Komprimerad kopia i halv precision (IEEE 754 fp16). */
+   DENSE_LAYER_FORMAT_BF16  /* Komprimerad kopia i formatet bfloat16. */
+};
 
 /**************************************************************************************************
 * dense_layer: Implementering av ett dense-lager i ett neuralt ntverk, kan anvnda fr dolda
-*              lager samt det yttre lagret i ett reguljrt neuralt ntverk.
+*              lager samt det yttre lagret i ett reguljrt neuralt ntverk. Vikterna lagras
+*              radvis i ett enda cachejusterat minnesblock, dr nod i:s vikter brjar p index
+*              i * stride. Biasvrdena lagras direkt efter viktmatrisen i samma block. Blocket
+*              kan ven gas externt, exempelvis d det ligger i en minnesmappad modellfil.
+*              Vid feedforward lagras ven index fr de noder vars utsignal r positiv, allts
+*              de noder som inte har nollstllts av ReLU. Enbart dessa noder har avvikelser
+*              skilda frn noll, vilket utnyttjas vid backpropagation och optimering.
+*              Vikterna kan ven lagras komprimerat p 16 bitar per vikt, dr viktmatrisen av
+*              typen ann_real utgr huvudkopia som justeras vid trning och den komprimerade
+*              kopian uppdateras rad fr rad efter varje justering.
 **************************************************************************************************/
 struct dense_layer
 {
-   struct double_vector output;     /* Utsignaler frn respektive nod.. */
-   struct double_vector bias;       /* Biasvrden / vilovrden fr respektive nod. */
-   struct double_vector error;      /* Aktuell fel fr respektive nod. */
-   struct double_2d_vector weights; /* Vikter fr respektive nod. */
-   size_t num_nodes;                /* Antalet noder i lagret. */
-   size_t num_weights;              /* Antalet vikter per nod. */
+   ann_real* output;               /* Utsignaler frn respektive nod.. */
+   ann_real* error;                /* Aktuell fel fr respektive nod. */
+   ann_real* weights;              /* Viktmatris (num_nodes x stride), lagrad radvis. */
+   ann_real* bias;                 /* Biasvrden / vilovrden fr respektive nod. */
+   size_t num_nodes;               /* Antalet noder i lagret. */
+   size_t num_weights;             /* Antalet vikter per nod. */
+   size_t stride;                  /* Avstndet mellan tv noders vikter i viktmatrisen. */
+   size_t* active;                 /* Index fr noder med positiv utsignal vid feedforward. */
+   size_t num_active;              /* Antalet noder med positiv utsignal vid senaste feedforward. */
+   bool external;                  /* Parameterblocket gs externt och skall inte frigras. */
+   uint16_t* half_weights;         /* Komprimerad viktmatris (num_nodes x half_stride). */
+   size_t half_stride;             /* Radavstndet i den komprimerade viktmatrisen. */
+   enum dense_layer_format format; /* Format fr vikterna som lses vid feedforward. */
 };
 
 /* Externa funktioner: */
 void dense_layer_new(struct dense_layer* self, 
                      const size_t num_nodes, 
                      const size_t num_weights);
+void dense_layer_new_external(struct dense_layer* self,
+                              const size_t num_nodes,
+                              const size_t num_weights,
+                              ann_real* parameters);
 void dense_layer_delete(struct dense_layer* self);
 struct dense_layer* dense_layer_ptr_new(const size_t num_nodes, 
                                         const size_t num_weights);
@@ -37,15 +76,44 @@ void dense_layer_reset(struct dense_layer* self);
 void dense_layer_resize(struct dense_layer* self, 
                         const size_t num_nodes, 
                         const size_t num_weights);
+int dense_layer_set_format(struct dense_layer* self,
+                           const enum dense_layer_format format);
+void dense_layer_store_row(struct dense_layer* self,
+                           const size_t node);
 void dense_layer_feedforward(struct dense_layer* self, 
-                             const struct double_vector* input);
+                             const ann_real* input);
+void dense_layer_feedforward_sparse(struct dense_layer* self,
+                                    const uint32_t* indices,
+                                    const double* values,
+                                    const size_t size);
+void dense_layer_feedforward_columns(const struct dense_layer* self,
+                                     const ann_real* input,
+                                     const size_t input_stride,
+                                     ann_real* output,
+                                     const size_t output_stride,
+                                     const size_t num_columns);
 void dense_layer_compare_with_reference(struct dense_layer* self, 
-                                        const struct double_vector* reference);
+                                        const ann_real* reference);
 void dense_layer_backpropagate(struct dense_layer* self, 
                                const struct dense_layer* next_layer);
 void dense_layer_optimize(struct dense_layer* self, 
-                          const struct double_vector* input,
+                          const ann_real* input,
                           const double learning_rate);
+void dense_layer_optimize_sparse(struct dense_layer* self,
+                                 const uint32_t* indices,
+                                 const double* values,
+                                 const size_t size,
+                                 const double learning_rate);
+void dense_layer_backpropagate_optimize(struct dense_layer* self,
+                                        const ann_real* input,
+                                        struct dense_layer* previous_layer,
+                                        const double learning_rate);
+void dense_layer_backpropagate_optimize_input(struct dense_layer* self,
+                                              const ann_real* input,
+                                              ann_real* input_error,
+                                              const double learning_rate);
+size_t dense_layer_parameter_size(const size_t num_nodes,
+                                  const size_t num_weights);
 void dense_layer_print(const struct dense_layer* self, 
                        FILE* ostream);
 
@@ -0,0 +1,227 @@
+/**************************************************************************************************
+* dense_layer_batch.c: Innehller funktionsdefinitioner som anvnds fr batchvis feedforward,
+*                      backpropagation samt optimering av enskilda dense-lager.
+**************************************************************************************************/
+#include "dense_layer_batch.h"
+
+/**************************************************************************************************
+* dense_layer_batch_new: Initierar arbetsminne fr batchvis bearbetning av ett dense-lager med
+*                        angivet antal noder. Vid misslyckad minnesallokering returneras 1,
+*                        annars 0.
+*
+*                        - self      : Pekare till arbetsminnet.
+*                        - num_nodes : Antalet noder i tillhrande dense-lager.
+*                        - batch_size: Maximalt antal trningsuppsttningar per batch.
+**************************************************************************************************/
+int dense_layer_batch_new(struct dense_layer_batch* self,
+                          const size_t num_nodes,
+                          const size_t batch_size)
+{
+   self->batch_size = batch_size;
+   self->num_nodes = num_nodes;
+   self->stride = aligned_memory_stride(num_nodes, sizeof(ann_real));
+   self->output = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * batch_size * self->stride);
+   self->error = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * batch_size * self->stride);
+
+   if (!self->output || !self->error)
+   {
+      dense_layer_batch_delete(self);
+      return 1;
+   }
+
+   for (size_t i = 0; i < batch_size * self->stride; ++i)
+   {
+      self->output[i] = 0;
+      self->error[i] = 0;
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* dense_layer_batch_delete: Frigr angivet arbetsminne.
+*
+*                           - self: Pekare till arbetsminnet.
+**************************************************************************************************/
+void dense_layer_batch_delete(struct dense_layer_batch* self)
+{
+   aligned_memory_free(self->output);
+   aligned_memory_free(self->error);
+   self->output = 0;
+   self->error = 0;
+   self->batch_size = 0;
+   self->num_nodes = 0;
+   self->stride = 0;
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_batch_feedforward: Berknar utsignaler fr samtliga trningsuppsttningar i en
+*                                batch. Varje rad i viktmatrisen anvnds fr fyra uppsttningar
+*                                t gngen, s att vikterna hlls i register/L1-cache medan
+*                                flera skalrprodukter ackumuleras.
+*
+*                                - self        : Pekare till arbetsminnet.
+*                                - layer       : Pekare till tillhrande dense-lager.
+*                                - input       : Pekare till indata, lagrad radvis.
+*                                - input_stride: Avstndet mellan tv rader i indatan.
+*                                - num_rows    : Antalet trningsuppsttningar i batchen.
+**************************************************************************************************/
+void dense_layer_batch_feedforward(struct dense_layer_batch* self,
+                                   const struct dense_layer* layer,
+                                   const ann_real* input,
+                                   const size_t input_stride,
+                                   const size_t num_rows)
+{
+   const size_t num_inputs = layer->num_weights;
+
+   for (size_t i = 0; i < layer->num_nodes; ++i)
+   {
+      const ann_real* weights = layer->weights + i * layer->stride;
+      size_t b = 0;
+
+      for (; b + 4 <= num_rows; b += 4)
+      {
+         ann_real sums[4];
+         simd_dot_4(weights, input + b * input_stride, input_stride, num_inputs, sums);
+
+         for (size_t k = 0; k < 4; ++k)
+         {
+            self->output[(b + k) * self->stride + i] = layer->bias[i] + sums[k];
+         }
+      }
+
+      for (; b < num_rows; ++b)
+      {
+         const ann_real* x = input + b * input_stride;
+         self->output[b * self->stride + i] = layer->bias[i] + simd_dot(weights, x, num_inputs);
+      }
+   }
+
+   for (size_t b = 0; b < num_rows; ++b)
+   {
+      simd_relu(self->output + b * self->stride, self->num_nodes);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_batch_compare_with_reference: Berknar avvikelser i ett utgngslager fr samtliga
+*                                           trningsuppsttningar i en batch via jmfrelse med
+*                                           motsvarande referensvrden.
+*
+*                                           - self            : Pekare till arbetsminnet.
+*                                           - reference       : Pekare till referensvrden,
+*                                                               lagrade radvis.
+*                                           - reference_stride: Avstndet mellan tv rader
+*                                                               med referensvrden.
+*                                           - num_rows        : Antalet uppsttningar i batchen.
+**************************************************************************************************/
+void dense_layer_batch_compare_with_reference(struct dense_layer_batch* self,
+                                              const ann_real* reference,
+                                              const size_t reference_stride,
+                                              const size_t num_rows)
+{
+   for (size_t b = 0; b < num_rows; ++b)
+   {
+      const ann_real* ref = reference + b * reference_stride;
+      const ann_real* output = self->output + b * self->stride;
+      ann_real* error = self->error + b * self->stride;
+
+      for (size_t i = 0; i < self->num_nodes; ++i)
+      {
+         error[i] = ref[i] - output[i];
+      }
+
+      simd_delta_relu(error, output, self->num_nodes);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_batch_backpropagate: Berknar avvikelser i ett dolt lager fr samtliga
+*                                  trningsuppsttningar i en batch via efterfljande lager.
+*                                  Efterfljande lagers viktmatris lses rad fr rad, dr varje
+*                                  rad teranvnds fr hela batchen innan nsta rad lses in.
+*
+*                                  - self      : Pekare till arbetsminnet fr aktuellt lager.
+*                                  - next_batch: Pekare till arbetsminnet fr efterfljande lager.
+*                                  - next_layer: Pekare till efterfljande dense-lager.
+*                                  - num_rows  : Antalet trningsuppsttningar i batchen.
+**************************************************************************************************/
+void dense_layer_batch_backpropagate(struct dense_layer_batch* self,
+                                     const struct dense_layer_batch* next_batch,
+                                     const struct dense_layer* next_layer,
+                                     const size_t num_rows)
+{
+   for (size_t b = 0; b < num_rows; ++b)
+   {
+      ann_real* error = self->error + b * self->stride;
+
+      for (size_t i = 0; i < self->num_nodes; ++i)
+      {
+         error[i] = 0;
+      }
+   }
+
+   for (size_t j = 0; j < next_layer->num_nodes; ++j)
+   {
+      const ann_real* weights = next_layer->weights + j * next_layer->stride;
+
+      for (size_t b = 0; b < num_rows; ++b)
+      {
+         const ann_real next_error = next_batch->error[b * next_batch->stride + j];
+         ann_real* error = self->error + b * self->stride;
+         if (next_error == 0.0) continue;
+         simd_axpy(error, next_error, weights, self->num_nodes);
+      }
+   }
+
+   for (size_t b = 0; b < num_rows; ++b)
+   {
+      simd_delta_relu(self->error + b * self->stride, self->output + b * self->stride, 
+                      self->num_nodes);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_batch_optimize: Justerar bias samt vikter i angivet dense-lager utifrn
+*                             medelvrdet av gradienterna fr samtliga trningsuppsttningar
+*                             i batchen. Gradienterna ackumuleras direkt i vikterna rad fr rad,
+*                             vilket motsvarar en enda uppdatering per batch eftersom samtliga
+*                             avvikelser redan har berknats med vikterna innan uppdateringen.
+*                             Eventuell komprimerad kopia av vikterna uppdateras fr varje rad.
+*
+*                             - self         : Pekare till arbetsminnet.
+*                             - layer        : Pekare till dense-lagret som skall justeras.
+*                             - input        : Pekare till lagrets indata, lagrad radvis.
+*                             - input_stride : Avstndet mellan tv rader i indatan.
+*                             - num_rows     : Antalet trningsuppsttningar i batchen.
+*                             - learning_rate: Lrhastigheten, avgr graden av justering.
+**************************************************************************************************/
+void dense_layer_batch_optimize(const struct dense_layer_batch* self,
+                                struct dense_layer* layer,
+                                const ann_real* input,
+                                const size_t input_stride,
+                                const size_t num_rows,
+                                const double learning_rate)
+{
+   const ann_real scale = (ann_real)(num_rows ? learning_rate / num_rows : 0.0);
+
+   for (size_t i = 0; i < layer->num_nodes; ++i)
+   {
+      ann_real* weights = layer->weights + i * layer->stride;
+
+      for (size_t b = 0; b < num_rows; ++b)
+      {
+         const ann_real change_rate = self->error[b * self->stride + i] * scale;
+         const ann_real* x = input + b * input_stride;
+         if (change_rate == 0.0) continue;
+         layer->bias[i] += change_rate;
+         simd_axpy(weights, change_rate, x, layer->num_weights);
+      }
+
+      dense_layer_store_row(layer, i);
+   }
+   return;
+}
@@ -0,0 +1,56 @@
+/**************************************************************************************************
+* dense_layer_batch.h: Innehller funktionalitet fr att bearbeta en hel batch av
+*                      trningsuppsttningar genom ett dense-lager t gngen via strukten
+*                      dense_layer_batch samt motsvarande externa funktioner. Berkningarna
+*                      genomfrs som matris-matrismultiplikationer, s att varje rad i lagrets
+*                      viktmatris lses en gng per batch i stllet fr en gng per uppsttning.
+**************************************************************************************************/
+#ifndef DENSE_LAYER_BATCH_H_
+#define DENSE_LAYER_BATCH_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "dense_layer.h"
+#include "aligned_memory.h"
+
+/**************************************************************************************************
+* dense_layer_batch: Arbetsminne fr ett dense-lager vid batchvis trning. Utsignaler och
+*                    avvikelser lagras radvis, en rad per trningsuppsttning i batchen.
+*                    Lagrets parametrar (vikter och bias) lagras inte hr utan i tillhrande
+*                    dense-lager, som passeras vid varje anrop.
+**************************************************************************************************/
+struct dense_layer_batch
+{
+   ann_real* output;  /* Utsignaler (batch_size x stride), lagrade radvis. */
+   ann_real* error;   /* Avvikelser (batch_size x stride), lagrade radvis. */
+   size_t batch_size; /* Maximalt antal trningsuppsttningar per batch. */
+   size_t num_nodes;  /* Antalet noder i tillhrande dense-lager. */
+   size_t stride;     /* Avstndet mellan tv rader i output och error. */
+};
+
+/* Externa funktioner: */
+int dense_layer_batch_new(struct dense_layer_batch* self,
+                          const size_t num_nodes,
+                          const size_t batch_size);
+void dense_layer_batch_delete(struct dense_layer_batch* self);
+void dense_layer_batch_feedforward(struct dense_layer_batch* self,
+                                   const struct dense_layer* layer,
+                                   const ann_real* input,
+                                   const size_t input_stride,
+                                   const size_t num_rows);
+void dense_layer_batch_compare_with_reference(struct dense_layer_batch* self,
+                                              const ann_real* reference,
+                                              const size_t reference_stride,
+                                              const size_t num_rows);
+void dense_layer_batch_backpropagate(struct dense_layer_batch* self,
+                                     const struct dense_layer_batch* next_batch,
+                                     const struct dense_layer* next_layer,
+                                     const size_t num_rows);
+void dense_layer_batch_optimize(const struct dense_layer_batch* self,
+                                struct dense_layer* layer,
+                                const ann_real* input,
+                                const size_t input_stride,
+                                const size_t num_rows,
+                                const double learning_rate);
+
+#endif /* DENSE_LAYER_BATCH_H_ */
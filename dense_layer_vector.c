@@ -13,19 +13,27 @@ void dense_layer_vector_new(struct dense_layer_vector* self)
 {
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    return;
 }
 
 /**************************************************************************************************
-* dense_layer_vector_delete: Tmmer angiven dense-lagervektor. 
+* dense_layer_vector_delete: Tmmer angiven dense-lagervektor. Minnet fr samtliga lagrade
+*                            dense-lager frigrs.
 * 
 *                            - self: Pekare till dense-lagervektorn.
 **************************************************************************************************/
 void dense_layer_vector_delete(struct dense_layer_vector* self)
 {
+   for (struct dense_layer* i = self->data; i < self->data + self->size; ++i)
+   {
+      dense_layer_delete(i);
+   }
+
    free(self->data);
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    return;
 }
 
@@ -38,6 +46,7 @@ struct dense_layer_vector* dense_layer_vector_ptr_new(void)
    if (!self) return 0;
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    return self;
 }
 
@@ -56,58 +65,104 @@ void dense_layer_vector_ptr_delete(struct dense_layer_vector** self)
 }
 
 /**************************************************************************************************
-* dense_layer_vector_resize: ndrar storleken angiven dense-lagervektor via omallokering.
+* dense_layer_vector_resize: ndrar storleken p angiven dense-lagervektor. Ifall den nya storleken
+*                            verstiger kapaciteten reserveras exakt s mycket minne som behvs,
+*                            annars behlls befintligt minne. Vid misslyckad minnesallokering
+*                            returneras 1, annars 0.
+*
 *                            - self    : Pekare till dense-lagervektorn.
-*                            - new_size: Dense-lagervektorns nya storlek efter omallokering.
+*                            - new_size: Den nya storleken.
 **************************************************************************************************/
-int dense_layer_vector_resize(struct dense_layer_vector* self, 
+int dense_layer_vector_resize(struct dense_layer_vector* self,
                               const size_t new_size)
 {
-   struct dense_layer* copy = (struct dense_layer*)realloc(self->data, 
-      sizeof(struct dense_layer) * new_size);
-   if (!copy) return 1;
-   self->data = copy;
+   if (dense_layer_vector_reserve(self, new_size)) return 1;
    self->size = new_size;
    return 0;
 }
 
 /**************************************************************************************************
-* dense_layer_vector_push: Lgger till ett nytt dense-lager lngst bak angiven dense-lagervektor.
-* 
+* dense_layer_vector_push: Lgger till ett nytt element lngst bak i angiven dense-lagervektor.
+*                          Ifall kapaciteten inte rcker frdubblas den, vilket medfr att varje
+*                          tillgg kostar amorterat konstant tid. Vid misslyckad minnesallokering
+*                          returneras 1, annars 0.
+*
 *                          - self     : Pekare till dense-lagervektorn.
-*                          - new_layer: Pekare till det nya lager som skall lggas till.
+*                          - new_layer: Pekare till det nya element som skall lggas till.
 **************************************************************************************************/
-int dense_layer_vector_push(struct dense_layer_vector* self, 
+int dense_layer_vector_push(struct dense_layer_vector* self,
                             const struct dense_layer* new_layer)
 {
-   struct dense_layer* copy = (struct dense_layer*)realloc(self->data, 
-      sizeof(struct dense_layer) * (self->size + 1));
-   if (!copy) return 1;
-   copy[self->size++] = *new_layer;
-   self->data = copy;
+   if (self->size == self->capacity && 
+       dense_layer_vector_reserve(self, self->capacity ? 2 * self->capacity : 4))
+   {
+      return 1;
+   }
+   self->data[self->size++] = *new_layer;
    return 0;
 }
 
 /**************************************************************************************************
-* dense_layer_vector_pop: Tar bort ett dense-lager lngst bak i angiven dense-lagervektor, 
-*                         frutsatt att denna vektor inte r tom.
-* 
+* dense_layer_vector_pop: Tar bort det sista elementet i angiven dense-lagervektor, frutsatt att
+*                         denna inte r tom. Minnet behlls fr efterfljande tillgg och frigrs
+*                         vid behov via dense_layer_vector_shrink_to_fit. Ifall dense-lagervektorn
+*                         r tom returneras 1, annars 0.
+*
 *                         - self: Pekare till dense-lagervektorn.
 **************************************************************************************************/
 int dense_layer_vector_pop(struct dense_layer_vector* self)
 {
-   if (self->size <= 1)
-   {
-      dense_layer_vector_delete(self);
-   }
-   else
+   if (!self->size) return 1;
+   dense_layer_delete(&self->data[self->size - 1]);
+   self->size--;
+   return 0;
+}
+
+/**************************************************************************************************
+* dense_layer_vector_reserve: Reserverar minne fr minst angivet antal element i angiven dense-
+*                             lagervektor, utan att storleken ndras. Vid misslyckad
+*                             minnesallokering returneras 1, annars 0.
+*
+*                             - self        : Pekare till dense-lagervektorn.
+*                             - new_capacity: Antalet element som minne skall reserveras fr.
+**************************************************************************************************/
+int dense_layer_vector_reserve(struct dense_layer_vector* self,
+                               const size_t new_capacity)
+{
+   struct dense_layer* copy = 0;
+   if (new_capacity <= self->capacity) return 0;
+   copy = (struct dense_layer*)realloc(self->data, sizeof(struct dense_layer) * new_capacity);
+   if (!copy) return 1;
+   self->data = copy;
+   self->capacity = new_capacity;
+   return 0;
+}
+
+/**************************************************************************************************
+* dense_layer_vector_shrink_to_fit: Minskar kapaciteten p angiven dense-lagervektor till aktuell
+*                                   storlek, s att oanvnt minne frigrs. Vid misslyckad
+*                                   minnesallokering returneras 1 och befintligt minne behlls,
+*                                   annars returneras 0.
+*
+*                                   - self: Pekare till dense-lagervektorn.
+**************************************************************************************************/
+int dense_layer_vector_shrink_to_fit(struct dense_layer_vector* self)
+{
+   struct dense_layer* copy = 0;
+   if (self->size == self->capacity) return 0;
+
+   if (!self->size)
    {
-      struct dense_layer* copy = (struct dense_layer*)realloc(self->data,
-         sizeof(struct dense_layer) * (self->size - 1));
-      if (!copy) return 1;
-      self->data = copy;
-      self->size--;
+      free(self->data);
+      self->data = 0;
+      self->capacity = 0;
+      return 0;
    }
+
+   copy = (struct dense_layer*)realloc(self->data, sizeof(struct dense_layer) * self->size);
+   if (!copy) return 1;
+   self->data = copy;
+   self->capacity = self->size;
    return 0;
 }
 
@@ -130,13 +185,15 @@ int dense_layer_vector_add_layer(struct dense_layer_vector* self,
 
 /**************************************************************************************************
 * dense_layer_vector_add_layers: Lgger till angivet antal dense-lager i angiven dense-lagervektor.
-*                                Varje nytt dense-lager initieras med angivet antal noder samt
-*                                vikter per nod.
+*                                Varje nytt dense-lager initieras med angivet antal noder.
+*                                Det frsta nya lagret tilldelas angivet antal vikter per nod,
+*                                medan efterfljande lager tilldelas en vikt per nod i
+*                                fregende lager.
 *
 *                               - self       : Pekare till angiven dense-lagervektor.
 *                               - num_layers : Antalet dense-lager som skall lggas till.
 *                               - num_nodes  : Antalet noder i varje nytt dense-lager.
-*                               - num_weights: Antalet vikter per nod i varje nytt dense-lager.
+*                               - num_weights: Antalet vikter per nod i det frsta nya lagret.
 **************************************************************************************************/
 int dense_layer_vector_add_layers(struct dense_layer_vector* self, 
                                   const size_t num_layers,
@@ -158,7 +215,7 @@ int dense_layer_vector_add_layers(struct dense_layer_vector* self,
       for (struct dense_layer* i = begin; i < end; ++i)
       {
          struct dense_layer new_layer;
-         dense_layer_new(&new_layer, num_nodes, num_weights);
+         dense_layer_new(&new_layer, num_nodes, i == begin ? num_weights : num_nodes);
          *i = new_layer;
       }
    }
@@ -194,19 +251,46 @@ void dense_layer_vector_print(const struct dense_layer_vector* self,
 *                                 - input: Utdata frn fregende ingngslager.
 **************************************************************************************************/
 void dense_layer_vector_feedforward(struct dense_layer_vector* self, 
-                                    const struct double_vector* input)
+                                    const ann_real* input)
 {
    dense_layer_feedforward(self->data, input);
 
    for (struct dense_layer* i = self->data + 1; i < self->data + self->size; ++i)
    {
       const size_t num = i - self->data;
-      const struct double_vector* previous_output = &((i - 1)->output);
+      const ann_real* previous_output = (i - 1)->output;
       dense_layer_feedforward(i, previous_output);
    }
    return;
 }
 
+/**************************************************************************************************
+* dense_layer_vector_feedforward_sparse: Uppdaterar utsignaler fr noder i samtliga dense-lager
+*                                        lagrade i angiven dense-lagervektor via gles indata
+*                                        till det frsta dense-lagret, dr enbart indatans
+*                                        element skilda frn noll passeras. Fr resterande
+*                                        dense-lager anvnds utdata frn fregende lager som
+*                                        indata.
+*
+*                                        - self   : Pekare till dense-lagervektorn.
+*                                        - indices: Pekare till den glesa indatans index.
+*                                        - values : Pekare till den glesa indatans vrden.
+*                                        - size   : Antalet element i den glesa indatan.
+**************************************************************************************************/
+void dense_layer_vector_feedforward_sparse(struct dense_layer_vector* self,
+                                           const uint32_t* indices,
+                                           const double* values,
+                                           const size_t size)
+{
+   dense_layer_feedforward_sparse(self->data, indices, values, size);
+
+   for (struct dense_layer* i = self->data + 1; i < self->data + self->size; ++i)
+   {
+      dense_layer_feedforward(i, (i - 1)->output);
+   }
+   return;
+}
+
 /**************************************************************************************************
 * dense_layer_vector_backpropagate: Berknar avvikelser i samtliga dense-lager lagrade i angiven
 *                                   dense-lagervektor. Avvikelserna i det sista dense-lagret 
@@ -243,7 +327,7 @@ void dense_layer_vector_backpropagate(struct dense_layer_vector* self,
 *                              - learning_rate: Lrhastigheten, avgr graden av justering.
 **************************************************************************************************/
 void dense_layer_vector_optimize(struct dense_layer_vector* self, 
-                                 const struct double_vector* input,
+                                 const ann_real* input,
                                  const double learning_rate)
 {
    struct dense_layer* first = self->data;
@@ -251,7 +335,7 @@ void dense_layer_vector_optimize(struct dense_layer_vector* self,
 
    for (struct dense_layer* i = last; i > first; --i)
    {
-      const struct double_vector* previous_output = &(i - 1)->output;
+      const ann_real* previous_output = (i - 1)->output;
       dense_layer_optimize(i, previous_output, learning_rate);
    }
 
@@ -259,6 +343,205 @@ void dense_layer_vector_optimize(struct dense_layer_vector* self,
    return;
 }
 
+/**************************************************************************************************
+* dense_layer_vector_backpropagate_optimize: Genomfr backpropagation och optimering i ett enda
+*                                            svep bakt genom angivet utgngslager samt
+*                                            samtliga dense-lager i angiven dense-lagervektor,
+*                                            dr utgngslagrets avvikelser redan r berknade.
+*                                            Varje lager berknar fregende lagers avvikelser
+*                                            och justerar sina parametrar via funktionen
+*                                            dense_layer_backpropagate_optimize, vilket ger
+*                                            samma resultat som dense_layer_vector_backpropagate
+*                                            fljt av optimering av samtliga lager, men med en
+*                                            enda lsning av varje viktmatris i stllet fr tv.
+*
+*                                            - self         : Pekare till dense-lagervektorn.
+*                                            - output_layer : Pekare till utgngslagret.
+*                                            - input        : Utdata frn fregende
+*                                                             ingngslager.
+*                                            - learning_rate: Lrhastigheten, avgr graden av
+*                                                             justering.
+**************************************************************************************************/
+void dense_layer_vector_backpropagate_optimize(struct dense_layer_vector* self,
+                                               struct dense_layer* output_layer,
+                                               const ann_real* input,
+                                               const double learning_rate)
+{
+   struct dense_layer* first = self->data;
+   struct dense_layer* last = self->data + self->size - 1;
+   dense_layer_backpropagate_optimize(output_layer, last->output, last, learning_rate);
+
+   for (struct dense_layer* i = last; i > first; --i)
+   {
+      dense_layer_backpropagate_optimize(i, (i - 1)->output, i - 1, learning_rate);
+   }
+
+   dense_layer_backpropagate_optimize(first, input, 0, learning_rate);
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_vector_backpropagate_optimize_sparse: Motsvarar funktionen
+*                                                   dense_layer_vector_backpropagate_optimize,
+*                                                   men med gles indata till det frsta
+*                                                   dense-lagret, vars vikter enbart justeras
+*                                                   fr indatans element skilda frn noll.
+*
+*                                                   - self         : Pekare till
+*                                                                    dense-lagervektorn.
+*                                                   - output_layer : Pekare till utgngslagret.
+*                                                   - indices      : Pekare till den glesa
+*                                                                    indatans index.
+*                                                   - values       : Pekare till den glesa
+*                                                                    indatans vrden.
+*                                                   - size         : Antalet element i den
+*                                                                    glesa indatan.
+*                                                   - learning_rate: Lrhastigheten, avgr
+*                                                                    graden av justering.
+**************************************************************************************************/
+void dense_layer_vector_backpropagate_optimize_sparse(struct dense_layer_vector* self,
+                                                      struct dense_layer* output_layer,
+                                                      const uint32_t* indices,
+                                                      const double* values,
+                                                      const size_t size,
+                                                      const double learning_rate)
+{
+   struct dense_layer* first = self->data;
+   struct dense_layer* last = self->data + self->size - 1;
+   dense_layer_backpropagate_optimize(output_layer, last->output, last, learning_rate);
+
+   for (struct dense_layer* i = last; i > first; --i)
+   {
+      dense_layer_backpropagate_optimize(i, (i - 1)->output, i - 1, learning_rate);
+   }
+
+   dense_layer_optimize_sparse(first, indices, values, size, learning_rate);
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_vector_backpropagate_optimize_input: Motsvarar funktionen
+*                                                  dense_layer_vector_backpropagate_optimize,
+*                                                  men berknar ven avvikelserna fr det
+*                                                  frsta dense-lagrets indata, exempelvis
+*                                                  utdatan frn ett inbddningslager, och
+*                                                  lagrar dem i angivet flt.
+*
+*                                                  - self         : Pekare till
+*                                                                   dense-lagervektorn.
+*                                                  - output_layer : Pekare till utgngslagret.
+*                                                  - input        : Indata till det frsta
+*                                                                   dense-lagret.
+*                                                  - input_error  : Flt som indatans
+*                                                                   avvikelser skrivs till.
+*                                                  - learning_rate: Lrhastigheten, avgr
+*                                                                   graden av justering.
+**************************************************************************************************/
+void dense_layer_vector_backpropagate_optimize_input(struct dense_layer_vector* self,
+                                                     struct dense_layer* output_layer,
+                                                     const ann_real* input,
+                                                     ann_real* input_error,
+                                                     const double learning_rate)
+{
+   struct dense_layer* first = self->data;
+   struct dense_layer* last = self->data + self->size - 1;
+   dense_layer_backpropagate_optimize(output_layer, last->output, last, learning_rate);
+
+   for (struct dense_layer* i = last; i > first; --i)
+   {
+      dense_layer_backpropagate_optimize(i, (i - 1)->output, i - 1, learning_rate);
+   }
+
+   dense_layer_backpropagate_optimize_input(first, input, input_error, learning_rate);
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_vector_feedforward_batch: Uppdaterar utsignaler fr samtliga dense-lager i angiven
+*                                       dense-lagervektor fr en hel batch av insignaler.
+*                                       Varje dense-lager har ett eget arbetsminne i fltet
+*                                       batches, dr utsignalerna frn fregende lager utgr
+*                                       indata till nsta lager.
+*
+*                                       - self        : Pekare till dense-lagervektorn.
+*                                       - batches     : Flt med arbetsminne, ett per dense-lager.
+*                                       - input       : Insignaler till frsta lagret, radvis.
+*                                       - input_stride: Avstndet mellan tv rader i input.
+*                                       - num_rows    : Antalet trningsuppsttningar i batchen.
+**************************************************************************************************/
+void dense_layer_vector_feedforward_batch(const struct dense_layer_vector* self,
+                                          struct dense_layer_batch* batches,
+                                          const ann_real* input,
+                                          const size_t input_stride,
+                                          const size_t num_rows)
+{
+   dense_layer_batch_feedforward(batches, self->data, input, input_stride, num_rows);
+
+   for (size_t i = 1; i < self->size; ++i)
+   {
+      const struct dense_layer_batch* previous = &batches[i - 1];
+      dense_layer_batch_feedforward(&batches[i], &self->data[i], previous->output, 
+                                    previous->stride, num_rows);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_vector_backpropagate_batch: Berknar avvikelser i samtliga dense-lager i angiven
+*                                         dense-lagervektor fr en hel batch, med start frn
+*                                         efterfljande utgngslager.
+*
+*                                         - self        : Pekare till dense-lagervektorn.
+*                                         - batches     : Flt med arbetsminne, ett per lager.
+*                                         - output_layer: Pekare till efterfljande utgngslager.
+*                                         - output_batch: Pekare till utgngslagrets arbetsminne.
+*                                         - num_rows    : Antalet trningsuppsttningar i batchen.
+**************************************************************************************************/
+void dense_layer_vector_backpropagate_batch(const struct dense_layer_vector* self,
+                                            struct dense_layer_batch* batches,
+                                            const struct dense_layer* output_layer,
+                                            const struct dense_layer_batch* output_batch,
+                                            const size_t num_rows)
+{
+   const size_t last = self->size - 1;
+   dense_layer_batch_backpropagate(&batches[last], output_batch, output_layer, num_rows);
+
+   for (size_t i = last; i > 0; --i)
+   {
+      dense_layer_batch_backpropagate(&batches[i - 1], &batches[i], &self->data[i], num_rows);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* dense_layer_vector_optimize_batch: Justerar parametrar i samtliga dense-lager i angiven
+*                                    dense-lagervektor utifrn avvikelserna fr en hel batch.
+*
+*                                    - self         : Pekare till dense-lagervektorn.
+*                                    - batches      : Flt med arbetsminne, ett per dense-lager.
+*                                    - input        : Insignaler till frsta lagret, radvis.
+*                                    - input_stride : Avstndet mellan tv rader i input.
+*                                    - num_rows     : Antalet trningsuppsttningar i batchen.
+*                                    - learning_rate: Lrhastigheten, avgr graden av justering.
+**************************************************************************************************/
+void dense_layer_vector_optimize_batch(struct dense_layer_vector* self,
+                                       const struct dense_layer_batch* batches,
+                                       const ann_real* input,
+                                       const size_t input_stride,
+                                       const size_t num_rows,
+                                       const double learning_rate)
+{
+   for (size_t i = self->size - 1; i > 0; --i)
+   {
+      const struct dense_layer_batch* previous = &batches[i - 1];
+      dense_layer_batch_optimize(&batches[i], &self->data[i], previous->output, 
+                                 previous->stride, num_rows, learning_rate);
+   }
+
+   dense_layer_batch_optimize(batches, self->data, input, input_stride, num_rows, learning_rate);
+   return;
+}
+
 /**************************************************************************************************
 * dense_layer_vector_begin: Returnerar adressen till det frsta dense-lagret i angiven 
 *                           dense-lagervektor.
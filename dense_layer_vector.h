@@ -10,6 +10,7 @@
 /* Inkluderingsdirektiv: */
 #include "def.h"
 #include "dense_layer.h"
+#include "dense_layer_batch.h"
 
 /**************************************************************************************************
 * dense_layer_vector: Dynamiskt flt innehllande dense-lager.
@@ -18,6 +19,7 @@ struct dense_layer_vector
 {
    struct dense_layer* data; /* Pekare till flt innehllande dense-lager. */
    size_t size;             /* Antalet dense-lager i fltet. */
+   size_t capacity;         /* Antalet dense-lager som fltet rymmer. */
 };
 
 /* Externa funktioner: */
@@ -30,6 +32,9 @@ int dense_layer_vector_resize(struct dense_layer_vector* self,
 int dense_layer_vector_push(struct dense_layer_vector* self, 
                             const struct dense_layer* new_layer);
 int dense_layer_vector_pop(struct dense_layer_vector* self);
+int dense_layer_vector_reserve(struct dense_layer_vector* self,
+                               const size_t new_capacity);
+int dense_layer_vector_shrink_to_fit(struct dense_layer_vector* self);
 int dense_layer_vector_add_layer(struct dense_layer_vector* self, 
                                  const size_t num_nodes, 
                                  const size_t num_weights);
@@ -40,12 +45,47 @@ int dense_layer_vector_add_layers(struct dense_layer_vector* self,
 void dense_layer_vector_print(const struct dense_layer_vector* self, 
                               FILE* ostream);
 void dense_layer_vector_feedforward(struct dense_layer_vector* self, 
-                                    const struct double_vector* input);
+                                    const ann_real* input);
+void dense_layer_vector_feedforward_sparse(struct dense_layer_vector* self,
+                                           const uint32_t* indices,
+                                           const double* values,
+                                           const size_t size);
 void dense_layer_vector_backpropagate(struct dense_layer_vector* self, 
                                       const struct dense_layer* output_layer);
 void dense_layer_vector_optimize(struct dense_layer_vector* self, 
-                                 const struct double_vector* input, 
+                                 const ann_real* input, 
                                  const double learning_rate);
+void dense_layer_vector_backpropagate_optimize(struct dense_layer_vector* self,
+                                               struct dense_layer* output_layer,
+                                               const ann_real* input,
+                                               const double learning_rate);
+void dense_layer_vector_backpropagate_optimize_sparse(struct dense_layer_vector* self,
+                                                      struct dense_layer* output_layer,
+                                                      const uint32_t* indices,
+                                                      const double* values,
+                                                      const size_t size,
+                                                      const double learning_rate);
+void dense_layer_vector_backpropagate_optimize_input(struct dense_layer_vector* self,
+                                                     struct dense_layer* output_layer,
+                                                     const ann_real* input,
+                                                     ann_real* input_error,
+                                                     const double learning_rate);
+void dense_layer_vector_feedforward_batch(const struct dense_layer_vector* self,
+                                          struct dense_layer_batch* batches,
+                                          const ann_real* input,
+                                          const size_t input_stride,
+                                          const size_t num_rows);
+void dense_layer_vector_backpropagate_batch(const struct dense_layer_vector* self,
+                                            struct dense_layer_batch* batches,
+                                            const struct dense_layer* output_layer,
+                                            const struct dense_layer_batch* output_batch,
+                                            const size_t num_rows);
+void dense_layer_vector_optimize_batch(struct dense_layer_vector* self,
+                                       const struct dense_layer_batch* batches,
+                                       const ann_real* input,
+                                       const size_t input_stride,
+                                       const size_t num_rows,
+                                       const double learning_rate);
 struct dense_layer* dense_layer_vector_begin(const struct dense_layer_vector* self);
 struct dense_layer* dense_layer_vector_end(const struct dense_layer_vector* self);
 struct dense_layer* dense_layer_vector_last(const struct dense_layer_vector* self);
@@ -4,6 +4,10 @@
 **************************************************************************************************/
 #include "double_2d_vector.h"
 
+/* Statiska funktioner: */
+static void relocate_elements(struct double_vector* data,
+                              const size_t size);
+
 /**************************************************************************************************
 * double_2d_vector_new: Initierar angiven tvdimensionell vektor.
 * 
@@ -13,6 +17,7 @@ void double_2d_vector_new(struct double_2d_vector* self)
 {
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    return;
 }
 
@@ -31,6 +36,7 @@ void double_2d_vector_delete(struct double_2d_vector* self)
    free(self->data);
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    return;
 }
 
@@ -46,6 +52,7 @@ struct double_2d_vector* double_2d_vector_ptr_new(const size_t size)
    if (!self) return 0;
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    double_2d_vector_resize(self, size);
    return self;
 }
@@ -65,61 +72,108 @@ void double_2d_vector_ptr_delete(struct double_2d_vector** self)
 }
 
 /**************************************************************************************************
-* double_2d_vector_resize: ndrar storleken / kapaciteten p angiven tvdimensionell vektor.
-* 
+* double_2d_vector_resize: ndrar storleken p angiven tvdimensionell vektor. Ifall den nya
+*                          storleken verstiger kapaciteten reserveras exakt s mycket minne som
+*                          behvs, annars behlls befintligt minne. Vid misslyckad minnesallokering
+*                          returneras 1, annars 0.
+*
 *                          - self    : Pekare till den tvdimensionella vektorn.
-*                          - new_size: Vektorns nya storlek.
+*                          - new_size: Den nya storleken.
 **************************************************************************************************/
-int double_2d_vector_resize(struct double_2d_vector* self, 
+int double_2d_vector_resize(struct double_2d_vector* self,
                             const size_t new_size)
 {
-   struct double_vector* copy = (struct double_vector*)realloc(self->data,
-      sizeof(struct double_vector) * new_size);
-   if (!copy) return 1;
-   self->data = copy;
+   if (double_2d_vector_reserve(self, new_size)) return 1;
    self->size = new_size;
    return 0;
 }
 
 /**************************************************************************************************
 * double_2d_vector_push: Lgger till ett nytt element lngst bak i angiven tvdimensionell vektor.
-* 
+*                        Ifall kapaciteten inte rcker frdubblas den, vilket medfr att varje
+*                        tillgg kostar amorterat konstant tid. Vid misslyckad minnesallokering
+*                        returneras 1, annars 0.
+*
 *                        - self       : Pekare till den tvdimensionella vektorn.
-*                        - new_element: Pekare till det nya element som skall lggas till. 
+*                        - new_element: Pekare till det nya element som skall lggas till.
 **************************************************************************************************/
-int double_2d_vector_push(struct double_2d_vector* self, 
+int double_2d_vector_push(struct double_2d_vector* self,
                           const struct double_vector* new_element)
 {
-   struct double_vector* copy = (struct double_vector*)realloc(self->data, 
-      sizeof(struct double_vector) * (self->size + 1));
-   if (!copy) return 1;
-   copy[self->size++] = *new_element;
-   self->data = copy;
+   if (self->size == self->capacity && 
+       double_2d_vector_reserve(self, self->capacity ? 2 * self->capacity : 4))
+   {
+      return 1;
+   }
+   self->data[self->size] = *new_element;
+   double_vector_relocate(&self->data[self->size++]);
    return 0;
 }
 
 /**************************************************************************************************
-* double_2d_vector_pop: Tar bort det sista elementet i angiven tvdimensionell vektor, frutsatt 
-*                       att denna inte r tom.
-*                      
+* double_2d_vector_pop: Tar bort det sista elementet i angiven tvdimensionell vektor, frutsatt
+*                       att denna inte r tom. Minnet behlls fr efterfljande tillgg och frigrs
+*                       vid behov via double_2d_vector_shrink_to_fit. Ifall vektorn r tom
+*                       returneras 1, annars 0.
+*
 *                       - self: Pekare till den tvdimensionella vektorn.
 **************************************************************************************************/
 int double_2d_vector_pop(struct double_2d_vector* self)
 {
-   if (self->size <= 1)
-   {
-      double_2d_vector_delete(self);
-      return 1;
-   }
-   else
+   if (!self->size) return 1;
+   double_vector_delete(&self->data[self->size - 1]);
+   self->size--;
+   return 0;
+}
+
+/**************************************************************************************************
+* double_2d_vector_reserve: Reserverar minne fr minst angivet antal element i angiven
+*                           tvdimensionell vektor, utan att storleken ndras. Vid misslyckad
+*                           minnesallokering returneras 1, annars 0.
+*
+*                           - self        : Pekare till den tvdimensionella vektorn.
+*                           - new_capacity: Antalet element som minne skall reserveras fr.
+**************************************************************************************************/
+int double_2d_vector_reserve(struct double_2d_vector* self,
+                             const size_t new_capacity)
+{
+   struct double_vector* copy = 0;
+   if (new_capacity <= self->capacity) return 0;
+   copy = (struct double_vector*)realloc(self->data, sizeof(struct double_vector) * new_capacity);
+   if (!copy) return 1;
+   relocate_elements(copy, self->size);
+   self->data = copy;
+   self->capacity = new_capacity;
+   return 0;
+}
+
+/**************************************************************************************************
+* double_2d_vector_shrink_to_fit: Minskar kapaciteten p angiven tvdimensionell vektor till
+*                                 aktuell storlek, s att oanvnt minne frigrs. Vid misslyckad
+*                                 minnesallokering returneras 1 och befintligt minne behlls,
+*                                 annars returneras 0.
+*
+*                                 - self: Pekare till den tvdimensionella vektorn.
+**************************************************************************************************/
+int double_2d_vector_shrink_to_fit(struct double_2d_vector* self)
+{
+   struct double_vector* copy = 0;
+   if (self->size == self->capacity) return 0;
+
+   if (!self->size)
    {
-      struct double_vector* copy = (struct double_vector*)realloc(self->data,
-         sizeof(struct double_vector) * (self->size - 1));
-      if (!copy) return 1;
-      self->data = copy;
-      self->size--;
+      free(self->data);
+      self->data = 0;
+      self->capacity = 0;
       return 0;
    }
+
+   copy = (struct double_vector*)realloc(self->data, sizeof(struct double_vector) * self->size);
+   if (!copy) return 1;
+   relocate_elements(copy, self->size);
+   self->data = copy;
+   self->capacity = self->size;
+   return 0;
 }
 
 /**************************************************************************************************
@@ -171,3 +225,21 @@ struct double_vector* double_2d_vector_end(const struct double_2d_vector* self)
 *                         - self: Pekare till den tvdimensionella vektorn.
 **************************************************************************************************/
 void (*double_2d_vector_clear)(struct double_2d_vector* self) = &double_2d_vector_delete;
+
+/**************************************************************************************************
+* relocate_elements: Uppdaterar samtliga vektorer i ett flt som kan ha flyttats via
+*                    omallokering, s att vektorer vars element lagras direkt i vektorn pekar p
+*                    sin nya adress.
+*
+*                    - data: Pekare till fltets nya adress.
+*                    - size: Antalet vektorer i fltet.
+**************************************************************************************************/
+static void relocate_elements(struct double_vector* data,
+                              const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      double_vector_relocate(&data[i]);
+   }
+   return;
+}
\ No newline at end of file
@@ -13,19 +13,22 @@ void double_vector_new(struct double_vector* self)
 {
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    return;
 }
 
 /**************************************************************************************************
-* double_vector_delete: Tmmer innehllet i angiven vektor.
+* double_vector_delete: Tmmer innehllet i angiven vektor. Heapallokerat minne frigrs, medan
+*                       element lagrade direkt i vektorn inte krver ngon frigring.
 *
 *                       - self: Pekare till vektorn.
 **************************************************************************************************/
 void double_vector_delete(struct double_vector* self)
 {
-   free(self->data);
+   if (self->data != self->buffer) free(self->data);
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    return;
 }
 
@@ -40,6 +43,7 @@ struct double_vector* double_vector_ptr_new(const size_t size)
    if (!self) return 0;
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    double_vector_resize(self, size);
    return self;
 }
@@ -60,23 +64,25 @@ void double_vector_ptr_delete(struct double_vector** self)
 }
 
 /**************************************************************************************************
-* double_vector_resize: ndrar storleken / kapaciteten p angiven vektor via omallokering.
+* double_vector_resize: ndrar storleken p angiven vektor. Ifall den nya storleken verstiger
+*                       kapaciteten reserveras exakt s mycket minne som behvs, annars behlls
+*                       befintligt minne. Vid misslyckad minnesallokering returneras 1, annars 0.
 *
-*                      - self    : Pekare till vektorn.
-*                      - new_size: Vektorns nya storlek efter omallokeringen.
+*                       - self    : Pekare till vektorn.
+*                       - new_size: Den nya storleken.
 **************************************************************************************************/
 int double_vector_resize(struct double_vector* self,
                          const size_t new_size)
 {
-   double* copy = (double*)realloc(self->data, sizeof(double) * new_size);
-   if (!copy) return 1;
-   self->data = copy;
+   if (double_vector_reserve(self, new_size)) return 1;
    self->size = new_size;
    return 0;
 }
 
 /**************************************************************************************************
-* double_vector_push: Lgger till ett nytt element lngst bak i angiven vektor.
+* double_vector_push: Lgger till ett nytt element lngst bak i angiven vektor. Ifall kapaciteten
+*                     inte rcker frdubblas den, vilket medfr att varje tillgg kostar amorterat
+*                     konstant tid. Vid misslyckad minnesallokering returneras 1, annars 0.
 *
 *                     - self       : Pekare till vektorn.
 *                     - new_element: Det nya element som skall lggas till.
@@ -84,33 +90,124 @@ int double_vector_resize(struct double_vector* self,
 int double_vector_push(struct double_vector* self,
                        const double new_element)
 {
-   double* copy = (double*)realloc(self->data, sizeof(double) * (self->size + 1));
-   if (!copy) return 1;
-   copy[self->size++] = new_element;
-   self->data = copy;
+   if (self->size == self->capacity && 
+       double_vector_reserve(self, self->capacity ? 2 * self->capacity : 4))
+   {
+      return 1;
+   }
+   self->data[self->size++] = new_element;
    return 0;
 }
 
 /**************************************************************************************************
-* double_vector_pop: Tar bort ett element lngst bak i angiven vektor, om ett sdant finns.
+* double_vector_pop: Tar bort det sista elementet i angiven vektor, frutsatt att denna inte r
+*                    tom. Minnet behlls fr efterfljande tillgg och frigrs vid behov via
+*                    double_vector_shrink_to_fit. Ifall vektorn r tom returneras 1, annars 0.
 *
 *                    - self: Pekare till vektorn.
 **************************************************************************************************/
 int double_vector_pop(struct double_vector* self)
 {
-   if (self->size <= 1)
+   if (!self->size) return 1;
+   self->size--;
+   return 0;
+}
+
+/**************************************************************************************************
+* double_vector_reserve: Reserverar minne fr minst angivet antal element i angiven vektor, utan
+*                        att storleken ndras. Upp till DOUBLE_VECTOR_INLINE_SIZE element lagras
+*                        direkt i vektorn, medan strre kapacitet allokeras p heapen, varvid
+*                        befintliga element flyttas dit. Vid misslyckad minnesallokering
+*                        returneras 1, annars 0.
+*
+*                        - self        : Pekare till vektorn.
+*                        - new_capacity: Antalet element som minne skall reserveras fr.
+**************************************************************************************************/
+int double_vector_reserve(struct double_vector* self,
+                          const size_t new_capacity)
+{
+   double* copy = 0;
+   if (new_capacity <= self->capacity) return 0;
+
+   if (!self->data && new_capacity <= DOUBLE_VECTOR_INLINE_SIZE)
    {
-      double_vector_delete(self);
-      return 1;
+      self->data = self->buffer;
+      self->capacity = DOUBLE_VECTOR_INLINE_SIZE;
+      return 0;
+   }
+
+   if (self->data == self->buffer)
+   {
+      copy = (double*)malloc(sizeof(double) * new_capacity);
+      if (!copy) return 1;
+      memcpy(copy, self->buffer, sizeof(double) * self->size);
    }
    else
    {
-      double* copy = (double*)realloc(self->data, sizeof(double) * (self->size - 1));
+      copy = (double*)realloc(self->data, sizeof(double) * new_capacity);
       if (!copy) return 1;
-      self->data = copy;
-      self->size--;
+   }
+
+   self->data = copy;
+   self->capacity = new_capacity;
+   return 0;
+}
+
+/**************************************************************************************************
+* double_vector_shrink_to_fit: Minskar kapaciteten p angiven vektor till aktuell storlek, s att
+*                              oanvnt minne frigrs. Heapallokerade element som ryms direkt i
+*                              vektorn flyttas dit. Vid misslyckad minnesallokering returneras 1
+*                              och befintligt minne behlls, annars returneras 0.
+*
+*                              - self: Pekare till vektorn.
+**************************************************************************************************/
+int double_vector_shrink_to_fit(struct double_vector* self)
+{
+   double* copy = 0;
+   if (self->size == self->capacity || self->data == self->buffer) return 0;
+
+   if (!self->size)
+   {
+      free(self->data);
+      self->data = 0;
+      self->capacity = 0;
+      return 0;
+   }
+
+   if (self->size <= DOUBLE_VECTOR_INLINE_SIZE)
+   {
+      memcpy(self->buffer, self->data, sizeof(double) * self->size);
+      free(self->data);
+      self->data = self->buffer;
+      self->capacity = DOUBLE_VECTOR_INLINE_SIZE;
       return 0;
    }
+
+   copy = (double*)realloc(self->data, sizeof(double) * self->size);
+   if (!copy) return 1;
+   self->data = copy;
+   self->capacity = self->size;
+   return 0;
+}
+
+/**************************************************************************************************
+* double_vector_relocate: Uppdaterar angiven vektor efter att den har flyttats via bitvis
+*                         kopiering, exempelvis via memcpy eller realloc av ett flt av vektorer.
+*                         Ifall vektorns element lg lagrade direkt i vektorn pekar data fortsatt
+*                         p den tidigare adressen och stts drfr om till den nya bufferten.
+*                         Detta avgrs via kapaciteten, d heapallokerade element alltid har en
+*                         kapacitet som verstiger DOUBLE_VECTOR_INLINE_SIZE, s att den tidigare
+*                         adressen inte behver lsas. Heapallokerade element pverkas inte.
+*
+*                         - self: Pekare till vektorn p den nya adressen.
+**************************************************************************************************/
+void double_vector_relocate(struct double_vector* self)
+{
+   if (self->data && self->capacity <= DOUBLE_VECTOR_INLINE_SIZE)
+   {
+      self->data = self->buffer;
+   }
+   return;
 }
 
 /**************************************************************************************************
@@ -7,15 +7,30 @@
 
 /* Inkluderingsdirektiv: */
 #include "def.h"
+#include <stddef.h>
+#include <string.h>
+
+/* Makrodefinitioner: */
+#ifndef DOUBLE_VECTOR_INLINE_SIZE
+#define DOUBLE_VECTOR_INLINE_SIZE 4 /* Antalet flyttal som lagras direkt i vektorn. */
+#endif
 
 /**************************************************************************************************
 * double_vector: Vektor innehllande ett dynamiskt flt fr lagring av flyttal. Antalet element
-*                som lagras i fltet rknas upp och uttrycks i form av vektorns storlek.
+*                som lagras i fltet rknas upp och uttrycks i form av vektorns storlek. Upp
+*                till DOUBLE_VECTOR_INLINE_SIZE element lagras direkt i vektorn (buffer), s
+*                att sm vektorer inte krver ngon heapallokering och deras element ligger i
+*                samma cacherad som vektorn. Pekaren data pekar d p buffer, vilket medfr att
+*                en vektor som flyttas via bitvis kopiering (exempelvis vid omallokering av ett
+*                flt av vektorer) mste uppdateras via double_vector_relocate. Heapallokerade
+*                element har alltid en kapacitet som verstiger DOUBLE_VECTOR_INLINE_SIZE.
 **************************************************************************************************/
 struct double_vector
 {
-   double* data; /* Pekare till dynamiskt flt fr lagring av flyttal. */
-   size_t size;  /* Vektorns storlek (antalet element i fltet). */
+   double* data;                             /* Pekare till vektorns element. */
+   size_t size;                              /* Vektorns storlek (antalet element i fltet). */
+   size_t capacity;                          /* Antalet element som fltet rymmer. */
+   double buffer[DOUBLE_VECTOR_INLINE_SIZE]; /* Lagring fr sm vektorer. */
 };
 
 /* Externa funktioner: */
@@ -28,6 +43,10 @@ int double_vector_resize(struct double_vector* self,
 int double_vector_push(struct double_vector* self,
                        const double new_element);
 int double_vector_pop(struct double_vector* self);
+int double_vector_reserve(struct double_vector* self,
+                          const size_t new_capacity);
+int double_vector_shrink_to_fit(struct double_vector* self);
+void double_vector_relocate(struct double_vector* self);
 void double_vector_print(const struct double_vector* self,
                          FILE* ostream);
 double* double_vector_begin(const struct double_vector* self);
@@ -0,0 +1,214 @@
+/**************************************************************************************************
+* double_vector_check.c: Fristende kontroll av vektortyperna double_vector och double_2d_vector,
+*                        dr slumpmssiga sekvenser av tillgg, borttagningar, reservationer och
+*                        krympningar genomfrs bde p vektorerna och p en enkel referensmodell.
+*                        Efter varje operation jmfrs storlek och innehll, samt att vektorer
+*                        vars element lagras direkt i vektorn pekar p sin egen buffert ven
+*                        efter att det omgivande fltet har omallokerats. Koden kompileras endast
+*                        d DOUBLE_VECTOR_CHECK r definierat, s att den inte pverkar vriga
+*                        program som byggs via *.c. Kompilera och kr exempelvis via fljande
+*                        kommandon, dr ett valfritt fr kan passeras som argument:
+*                        $ gcc double_vector_check.c double_vector.c double_2d_vector.c
+*                          random_generator.c -o double_vector_check -Wall -DDOUBLE_VECTOR_CHECK
+*                          -fsanitize=address,undefined
+*                        $ ./double_vector_check [seed]
+**************************************************************************************************/
+#ifdef DOUBLE_VECTOR_CHECK
+
+#include "double_2d_vector.h"
+#include "random_generator.h"
+
+/* Makrodefinitioner: */
+#define MAX_VECTORS    64     /* Strsta antalet vektorer i den tvdimensionella vektorn. */
+#define MAX_ELEMENTS   64     /* Strsta antalet element per vektor. */
+#define NUM_OPERATIONS 200000 /* Antalet slumpmssiga operationer som genomfrs. */
+
+/**************************************************************************************************
+* reference: Referensmodell, dr varje vektor lagras som ett flt med fast storlek.
+**************************************************************************************************/
+struct reference
+{
+   double data[MAX_VECTORS][MAX_ELEMENTS]; /* Frvntade element fr respektive vektor. */
+   size_t sizes[MAX_VECTORS];              /* Frvntad storlek fr respektive vektor. */
+   size_t size;                            /* Frvntat antal vektorer. */
+};
+
+/* Statiska funktioner: */
+static int check_vector(const struct double_vector* vector,
+                        const double* expected,
+                        const size_t size);
+static int check_all(const struct double_2d_vector* vectors,
+                     const struct reference* reference);
+static int apply_operation(struct double_2d_vector* vectors,
+                           struct reference* reference,
+                           struct random_generator* generator);
+
+/**************************************************************************************************
+* main: Genomfr NUM_OPERATIONS slumpmssiga operationer och kontrollerar vektorerna mot
+*       referensmodellen efter varje operation. Vid frsta avvikelse avbryts kontrollen och 1
+*       returneras, annars returneras 0.
+*
+*       - argc: Antalet argument.
+*       - argv: Argumenten, dr ett eventuellt fr passeras som frsta argument.
+**************************************************************************************************/
+int main(int argc, char** argv)
+{
+   static struct reference reference;
+   struct double_2d_vector vectors;
+   struct random_generator generator;
+   const uint64_t seed = argc > 1 ? strtoull(argv[1], 0, 10) : 1;
+   int result = 0;
+
+   random_generator_new(&generator, seed);
+   double_2d_vector_new(&vectors);
+
+   for (size_t i = 0; i < NUM_OPERATIONS; ++i)
+   {
+      if (apply_operation(&vectors, &reference, &generator) || check_all(&vectors, &reference))
+      {
+         fprintf(stderr, "double_vector_check: avvikelse vid operation %zu (seed %llu)\n",
+                 i, (unsigned long long)seed);
+         result = 1;
+         break;
+      }
+   }
+
+   if (!result)
+   {
+      printf("double_vector_check: %d operationer utan avvikelser (seed %llu)\n",
+             NUM_OPERATIONS, (unsigned long long)seed);
+   }
+
+   double_2d_vector_delete(&vectors);
+   return result;
+}
+
+/**************************************************************************************************
+* check_vector: Kontrollerar att angiven vektor har frvntad storlek och frvntade element
+*               samt att dess data pekar p den egna bufferten om och endast om kapaciteten
+*               ryms i vektorn. Vid avvikelse returneras 1, annars 0.
+*
+*               - vector  : Pekare till vektorn.
+*               - expected: Pekare till frvntade element.
+*               - size    : Frvntad storlek.
+**************************************************************************************************/
+static int check_vector(const struct double_vector* vector,
+                        const double* expected,
+                        const size_t size)
+{
+   if (vector->size != size || vector->capacity < size) return 1;
+   if (!vector->data) return vector->capacity != 0;
+   if ((vector->data == vector->buffer) != (vector->capacity <= DOUBLE_VECTOR_INLINE_SIZE))
+   {
+      return 1;
+   }
+   return size && memcmp(vector->data, expected, sizeof(double) * size) != 0;
+}
+
+/**************************************************************************************************
+* check_all: Kontrollerar samtliga vektorer mot referensmodellen. Vid avvikelse returneras 1,
+*            annars 0.
+*
+*            - vectors  : Pekare till den tvdimensionella vektorn.
+*            - reference: Pekare till referensmodellen.
+**************************************************************************************************/
+static int check_all(const struct double_2d_vector* vectors,
+                     const struct reference* reference)
+{
+   if (vectors->size != reference->size || vectors->capacity < vectors->size) return 1;
+
+   for (size_t i = 0; i < vectors->size; ++i)
+   {
+      if (check_vector(&vectors->data[i], reference->data[i], reference->sizes[i])) return 1;
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* apply_operation: Vljer en slumpmssig operation och genomfr den bde p vektorerna och p
+*                  referensmodellen. Ifall en operation misslyckas trots att den borde lyckas,
+*                  eller tvrtom, returneras 1, annars 0.
+*
+*                  - vectors  : Pekare till den tvdimensionella vektorn.
+*                  - reference: Pekare till referensmodellen.
+*                  - generator: Pekare till slumptalsgeneratorn.
+**************************************************************************************************/
+static int apply_operation(struct double_2d_vector* vectors,
+                           struct reference* reference,
+                           struct random_generator* generator)
+{
+   const size_t operation = random_generator_index(generator, 9);
+   const size_t index = random_generator_index(generator, reference->size);
+   struct double_vector* vector = reference->size ? &vectors->data[index] : 0;
+   double* expected = reference->data[index];
+   size_t* size = &reference->sizes[index];
+
+   if (operation == 0 && reference->size < MAX_VECTORS)
+   {
+      struct double_vector new_element;
+      const size_t new_size = random_generator_index(generator, 2 * DOUBLE_VECTOR_INLINE_SIZE + 2);
+      double_vector_new(&new_element);
+
+      for (size_t i = 0; i < new_size; ++i)
+      {
+         reference->data[reference->size][i] = random_generator_real(generator);
+         if (double_vector_push(&new_element, reference->data[reference->size][i])) return 1;
+      }
+
+      if (double_2d_vector_push(vectors, &new_element)) return 1;
+      reference->sizes[reference->size++] = new_size;
+   }
+   else if (operation == 1)
+   {
+      if (double_2d_vector_pop(vectors) != !reference->size) return 1;
+      if (reference->size) reference->size--;
+   }
+   else if (operation == 2)
+   {
+      const size_t new_capacity = reference->size + random_generator_index(generator, 8);
+      if (double_2d_vector_reserve(vectors, new_capacity)) return 1;
+   }
+   else if (operation == 3)
+   {
+      if (double_2d_vector_shrink_to_fit(vectors)) return 1;
+   }
+   else if (!vector)
+   {
+      return 0;
+   }
+   else if (operation == 4 && *size < MAX_ELEMENTS)
+   {
+      expected[*size] = random_generator_real(generator);
+      if (double_vector_push(vector, expected[(*size)++])) return 1;
+   }
+   else if (operation == 5)
+   {
+      if (double_vector_pop(vector) != !*size) return 1;
+      if (*size) (*size)--;
+   }
+   else if (operation == 6)
+   {
+      if (double_vector_reserve(vector, random_generator_index(generator, 2 * MAX_ELEMENTS)))
+      {
+         return 1;
+      }
+   }
+   else if (operation == 7)
+   {
+      if (double_vector_shrink_to_fit(vector)) return 1;
+   }
+   else if (operation == 8)
+   {
+      const size_t new_size = random_generator_index(generator, MAX_ELEMENTS + 1);
+      if (double_vector_resize(vector, new_size)) return 1;
+
+      for (size_t i = *size; i < new_size; ++i)
+      {
+         vector->data[i] = expected[i] = random_generator_real(generator);
+      }
+      *size = new_size;
+   }
+   return 0;
+}
+
+#endif /* DOUBLE_VECTOR_CHECK */
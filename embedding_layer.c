@@ -0,0 +1,181 @@
+/**************************************************************************************************
+* embedding_layer.c: Innehller funktionsdefinitioner som anvnds fr implementering av
+*                    inbddningslager fr kategoriska insignaler.
+**************************************************************************************************/
+#include "embedding_layer.h"
+
+/**************************************************************************************************
+* embedding_layer_new: Initierar angivet inbddningslager. Minne allokeras fr tabellen samt
+*                      inbddningen, varefter tabellens element tilldelas startvrden. Ett lager
+*                      med noll kategorier allokerar inget minne och anvnds fr att indikera
+*                      att ett ntverk saknar inbddningslager. Fr vriga lager vljs
+*                      berkningskrnorna via simd_init, ifall detta inte redan har skett. Vid
+*                      misslyckad minnesallokering returneras 1 och lagret lmnas tomt, annars 0.
+*
+*                      - self          : Pekare till inbddningslagret.
+*                      - num_categories: Antalet kategorier.
+*                      - dimension     : Antalet element per inbddning.
+**************************************************************************************************/
+int embedding_layer_new(struct embedding_layer* self,
+                        const size_t num_categories,
+                        const size_t dimension)
+{
+   struct random_generator* generator = 0;
+   self->weights = 0;
+   self->output = 0;
+   self->error = 0;
+   self->num_categories = 0;
+   self->dimension = 0;
+   self->stride = 0;
+   if (!num_categories || !dimension) return 0;
+
+   simd_init();
+   self->stride = aligned_memory_stride(dimension, sizeof(ann_real));
+   self->weights = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * num_categories *
+                                                   self->stride);
+   self->output = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * self->stride);
+   self->error = (ann_real*)aligned_memory_alloc(sizeof(ann_real) * self->stride);
+
+   if (!self->weights || !self->output || !self->error)
+   {
+      embedding_layer_delete(self);
+      return 1;
+   }
+
+   generator = random_generator_local();
+   self->num_categories = num_categories;
+   self->dimension = dimension;
+
+   for (size_t i = 0; i < num_categories; ++i)
+   {
+      ann_real* row = self->weights + i * self->stride;
+
+      for (size_t j = 0; j < self->stride; ++j)
+      {
+         row[j] = j < dimension ? (ann_real)random_generator_real(generator) : 0;
+      }
+   }
+
+   memset(self->output, 0, sizeof(ann_real) * self->stride);
+   memset(self->error, 0, sizeof(ann_real) * self->stride);
+   return 0;
+}
+
+/**************************************************************************************************
+* embedding_layer_delete: Frigr minnet fr angivet inbddningslager.
+*
+*                         - self: Pekare till inbddningslagret.
+**************************************************************************************************/
+void embedding_layer_delete(struct embedding_layer* self)
+{
+   aligned_memory_free(self->weights);
+   aligned_memory_free(self->output);
+   aligned_memory_free(self->error);
+   self->weights = 0;
+   self->output = 0;
+   self->error = 0;
+   self->num_categories = 0;
+   self->dimension = 0;
+   self->stride = 0;
+   return;
+}
+
+/**************************************************************************************************
+* embedding_layer_feedforward: Berknar inbddningen fr angivna kategorier, dr varje kategoris
+*                              rad hmtas och adderas till utdatan multiplicerad med
+*                              kategorins vrde. Samtliga index mste understiga antalet
+*                              kategorier.
+*
+*                              - self   : Pekare till inbddningslagret.
+*                              - indices: Pekare till flt innehllande kategoriernas index.
+*                              - values : Pekare till flt innehllande kategoriernas vrden.
+*                              - size   : Antalet kategorier i indatan.
+**************************************************************************************************/
+void embedding_layer_feedforward(struct embedding_layer* self,
+                                 const uint32_t* indices,
+                                 const double* values,
+                                 const size_t size)
+{
+   memset(self->output, 0, sizeof(ann_real) * self->dimension);
+
+   for (size_t k = 0; k < size; ++k)
+   {
+      const ann_real* row = self->weights + (size_t)indices[k] * self->stride;
+      simd_axpy(self->output, (ann_real)values[k], row, self->dimension);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* embedding_layer_feedforward_dense: Berknar inbddningen utifrn en tt insignal med ett
+*                                    element per kategori, exempelvis en one-hot-kodad vektor.
+*                                    Enbart rader fr kategorier skilda frn noll hmtas.
+*
+*                                    - self : Pekare till inbddningslagret.
+*                                    - input: Pekare till flt med num_categories element.
+**************************************************************************************************/
+void embedding_layer_feedforward_dense(struct embedding_layer* self,
+                                       const ann_real* input)
+{
+   memset(self->output, 0, sizeof(ann_real) * self->dimension);
+
+   for (size_t i = 0; i < self->num_categories; ++i)
+   {
+      if (input[i] != 0)
+      {
+         simd_axpy(self->output, input[i], self->weights + i * self->stride, self->dimension);
+      }
+   }
+   return;
+}
+
+/**************************************************************************************************
+* embedding_layer_optimize: Justerar raderna fr angivna kategorier med angiven lrhastighet
+*                           utifrn inbddningens avvikelser, som skall ha berknats av
+*                           efterfljande lager. vriga rader pverkas inte av justeringen.
+*
+*                           - self         : Pekare till inbddningslagret.
+*                           - indices      : Pekare till flt innehllande kategoriernas index.
+*                           - values       : Pekare till flt innehllande kategoriernas vrden.
+*                           - size         : Antalet kategorier i indatan.
+*                           - learning_rate: Lrhastigheten, avgr graden av justering vid
+*                                            avvikelse.
+**************************************************************************************************/
+void embedding_layer_optimize(struct embedding_layer* self,
+                              const uint32_t* indices,
+                              const double* values,
+                              const size_t size,
+                              const double learning_rate)
+{
+   for (size_t k = 0; k < size; ++k)
+   {
+      ann_real* row = self->weights + (size_t)indices[k] * self->stride;
+      simd_axpy(row, (ann_real)(values[k] * learning_rate), self->error, self->dimension);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* embedding_layer_optimize_dense: Motsvarar embedding_layer_optimize fr en tt insignal med ett
+*                                 element per kategori, dr enbart rader fr kategorier skilda
+*                                 frn noll justeras.
+*
+*                                 - self         : Pekare till inbddningslagret.
+*                                 - input        : Pekare till flt med num_categories element.
+*                                 - learning_rate: Lrhastigheten, avgr graden av justering vid
+*                                                  avvikelse.
+**************************************************************************************************/
+void embedding_layer_optimize_dense(struct embedding_layer* self,
+                                    const ann_real* input,
+                                    const double learning_rate)
+{
+   for (size_t i = 0; i < self->num_categories; ++i)
+   {
+      if (input[i] != 0)
+      {
+         simd_axpy(self->weights + i * self->stride, (ann_real)(input[i] * learning_rate),
+                   self->error, self->dimension);
+      }
+   }
+   return;
+}
@@ -0,0 +1,57 @@
+/**************************************************************************************************
+* embedding_layer.h: Innehller funktionalitet fr implementering av inbddningslager fr
+*                    kategoriska insignaler via strukten embedding_layer samt motsvarande externa
+*                    funktioner. I stllet fr att en kategori one-hot-kodas och multipliceras
+*                    med en hel viktmatris lagras en rad (inbddning) per kategori, s att
+*                    kategorins bidrag hmtas som en enda sammanhngande rad. Lagret placeras
+*                    fre de dolda lagren, vars frsta lager fr inbddningen som indata.
+**************************************************************************************************/
+#ifndef EMBEDDING_LAYER_H_
+#define EMBEDDING_LAYER_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "aligned_memory.h"
+#include "simd.h"
+#include "random_generator.h"
+#include <string.h>
+
+/**************************************************************************************************
+* embedding_layer: Inbddningslager med en tabell innehllande en rad per kategori, lagrad
+*                  radvis i ett cachejusterat minnesblock dr kategori i:s rad brjar p index
+*                  i * stride. Indata utgrs av kategoriernas index med tillhrande vrden, dr
+*                  vrdet normalt r ett. Utdatan r summan av de valda raderna multiplicerade
+*                  med respektive vrde, vilket r identiskt med en one-hot-kodad (eller
+*                  multi-hot-kodad) insignal multiplicerad med en viktmatris utan bias.
+**************************************************************************************************/
+struct embedding_layer
+{
+   ann_real* weights;     /* Inbddningstabell (num_categories x stride), lagrad radvis. */
+   ann_real* output;      /* Inbddning fr senaste indata, dimension element. */
+   ann_real* error;       /* Avvikelser fr respektive element i inbddningen. */
+   size_t num_categories; /* Antalet kategorier (rader i tabellen). */
+   size_t dimension;      /* Antalet element per inbddning. */
+   size_t stride;         /* Avstndet mellan tv kategoriers rader i tabellen. */
+};
+
+/* Externa funktioner: */
+int embedding_layer_new(struct embedding_layer* self,
+                        const size_t num_categories,
+                        const size_t dimension);
+void embedding_layer_delete(struct embedding_layer* self);
+void embedding_layer_feedforward(struct embedding_layer* self,
+                                 const uint32_t* indices,
+                                 const double* values,
+                                 const size_t size);
+void embedding_layer_feedforward_dense(struct embedding_layer* self,
+                                       const ann_real* input);
+void embedding_layer_optimize(struct embedding_layer* self,
+                              const uint32_t* indices,
+                              const double* values,
+                              const size_t size,
+                              const double learning_rate);
+void embedding_layer_optimize_dense(struct embedding_layer* self,
+                                    const ann_real* input,
+                                    const double learning_rate);
+
+#endif /* EMBEDDING_LAYER_H_ */
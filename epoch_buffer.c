@@ -0,0 +1,150 @@
+/**************************************************************************************************
+* epoch_buffer.c: Innehller funktionsdefinitioner som anvnds fr dubbelbuffrad mellanlagring
+*                 av trningsdata.
+**************************************************************************************************/
+#include "epoch_buffer.h"
+
+/* Statiska funktioner: */
+static void epoch_buffer_start(struct epoch_buffer* self);
+static int epoch_buffer_fill(void* arg);
+
+/**************************************************************************************************
+* epoch_buffer_new: Initierar dubbelbuffrad mellanlagring av angiven trningsdata fr angivet
+*                   antal epoker. Minne allokeras fr tv buffertar, eller fr en enda buffert
+*                   vid en enda epok, varefter den frsta epoken brjar fyllas i en
+*                   bakgrundstrd. Vid misslyckad minnesallokering returneras 1, annars 0.
+*
+*                   - self      : Pekare till mellanlagringen.
+*                   - data      : Pekare till trningsdatan som epokerna hmtas frn.
+*                   - num_epochs: Antalet epoker som skall fyllas.
+**************************************************************************************************/
+int epoch_buffer_new(struct epoch_buffer* self,
+                     struct training_data* data,
+                     const size_t num_epochs)
+{
+   const size_t input_size = sizeof(ann_real) * data->sets * data->num_inputs;
+   const size_t output_size = sizeof(ann_real) * data->sets * data->num_outputs;
+
+   self->data = data;
+   self->current = 0;
+   self->filling = 0;
+   self->remaining = num_epochs;
+   self->started = false;
+   self->filled = false;
+
+   for (size_t i = 0; i < 2; ++i)
+   {
+      const bool used = i < num_epochs;
+      self->in[i] = used ? (ann_real*)aligned_memory_alloc(input_size) : 0;
+      self->out[i] = used ? (ann_real*)aligned_memory_alloc(output_size) : 0;
+
+      if (used && (!self->in[i] || !self->out[i]))
+      {
+         epoch_buffer_delete(self);
+         return 1;
+      }
+   }
+
+   epoch_buffer_start(self);
+   return 0;
+}
+
+/**************************************************************************************************
+* epoch_buffer_delete: Vntar in eventuell bakgrundstrd och frigr minnet fr angiven
+*                      mellanlagring.
+*
+*                      - self: Pekare till mellanlagringen.
+**************************************************************************************************/
+void epoch_buffer_delete(struct epoch_buffer* self)
+{
+   if (self->started)
+   {
+      thrd_join(self->thread, 0);
+   }
+
+   for (size_t i = 0; i < 2; ++i)
+   {
+      aligned_memory_free(self->in[i]);
+      aligned_memory_free(self->out[i]);
+      self->in[i] = 0;
+      self->out[i] = 0;
+   }
+
+   self->data = 0;
+   self->remaining = 0;
+   self->started = false;
+   self->filled = false;
+   return;
+}
+
+/**************************************************************************************************
+* epoch_buffer_next: Lmnar ut bufferten med nsta epok fr trning, dr in- och utdata lagras
+*                    radvis i samma ordning som de skall trnas. Vid behov vntar funktionen
+*                    tills bakgrundstrden har fyllt bufferten, varefter den andra bufferten
+*                    brjar fyllas med efterfljande epok. Den utlmnade bufferten r giltig
+*                    fram till nsta anrop. Ifall samtliga epoker redan har lmnats ut
+*                    returneras 1, annars 0.
+*
+*                    - self: Pekare till mellanlagringen.
+*                    - in  : Pekare till variabeln som adressen till epokens indata lagras i.
+*                    - out : Pekare till variabeln som adressen till epokens utdata lagras i.
+**************************************************************************************************/
+int epoch_buffer_next(struct epoch_buffer* self,
+                      const ann_real** in,
+                      const ann_real** out)
+{
+   if (!self->filled) return 1;
+
+   if (self->started)
+   {
+      thrd_join(self->thread, 0);
+      self->started = false;
+   }
+
+   self->filled = false;
+   self->current = self->filling;
+   self->filling = 1 - self->current;
+   *in = self->in[self->current];
+   *out = self->out[self->current];
+   epoch_buffer_start(self);
+   return 0;
+}
+
+/**************************************************************************************************
+* epoch_buffer_start: Brjar fylla bufferten med index filling med nsta epok, frutsatt att
+*                     epoker terstr. Bufferten fylls i en bakgrundstrd. Ifall trden inte kan
+*                     startas fylls bufferten i stllet direkt av den anropande trden.
+*
+*                     - self: Pekare till mellanlagringen.
+**************************************************************************************************/
+static void epoch_buffer_start(struct epoch_buffer* self)
+{
+   if (!self->remaining) return;
+   self->remaining--;
+   self->filled = true;
+   self->started = thrd_create(&self->thread, epoch_buffer_fill, self) == thrd_success;
+
+   if (!self->started)
+   {
+      epoch_buffer_fill(self);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* epoch_buffer_fill: Randomiserar ordningen p trningsuppsttningarna och kopierar samtliga
+*                    uppsttningar i den nya ordningen till bufferten med index filling.
+*                    Utgr startfunktion fr bakgrundstrden och returnerar alltid 0.
+*
+*                    - arg: Pekare till mellanlagringen (struct epoch_buffer).
+**************************************************************************************************/
+static int epoch_buffer_fill(void* arg)
+{
+   struct epoch_buffer* self = (struct epoch_buffer*)arg;
+   struct training_data* data = self->data;
+
+   training_data_shuffle(data);
+   training_data_gather(data, 0, data->sets, self->in[self->filling], data->num_inputs,
+                        self->out[self->filling], data->num_outputs);
+   return 0;
+}
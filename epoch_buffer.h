@@ -0,0 +1,48 @@
+/**************************************************************************************************
+* epoch_buffer.h: Innehller funktionalitet fr dubbelbuffrad mellanlagring av trningsdata via
+*                 strukten epoch_buffer samt motsvarande externa funktioner. Infr varje epok
+*                 randomiseras ordningen p trningsuppsttningarna, varefter uppsttningarna
+*                 kopieras i den nya ordningen till en sammanhngande buffert. Medan en epok
+*                 trnas med den ena bufferten fylls den andra bufferten med nsta epok i en
+*                 bakgrundstrd. Trningen lser drmed raderna sekventiellt, ven nr
+*                 trningsdatan r mycket strre n cacheminnet, till priset av att tv
+*                 kopior av trningsdatan lagras med ntverkets flyttalstyp ann_real.
+**************************************************************************************************/
+#ifndef EPOCH_BUFFER_H_
+#define EPOCH_BUFFER_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "aligned_memory.h"
+#include "training_data.h"
+#include <threads.h>
+
+/**************************************************************************************************
+* epoch_buffer: Dubbelbuffrad mellanlagring av trningsdata, dr varje buffert rymmer samtliga
+*               trningsuppsttningar i en epok lagrade radvis utan utfyllnad mellan raderna.
+*               Trningsdatans ordningsfljd ndras av bakgrundstrden och fr drfr inte
+*               anvndas s lnge bufferten anvnds.
+**************************************************************************************************/
+struct epoch_buffer
+{
+   struct training_data* data; /* Trningsdatan som epokerna hmtas frn. */
+   ann_real* in[2];            /* Indata fr tv epoker, num_inputs flyttal per rad. */
+   ann_real* out[2];           /* Utdata fr tv epoker, num_outputs flyttal per rad. */
+   size_t current;             /* Index fr bufferten som senast lmnades ut fr trning. */
+   size_t filling;             /* Index fr bufferten som fylls med nsta epok. */
+   size_t remaining;           /* Antalet epoker som nnu inte har brjat fyllas. */
+   thrd_t thread;              /* Bakgrundstrden som fyller nsta buffert. */
+   bool started;               /* Indikerar ifall bakgrundstrden r startad. */
+   bool filled;                /* Indikerar ifall nsta epok har brjat fyllas. */
+};
+
+/* Externa funktioner: */
+int epoch_buffer_new(struct epoch_buffer* self,
+                     struct training_data* data,
+                     const size_t num_epochs);
+void epoch_buffer_delete(struct epoch_buffer* self);
+int epoch_buffer_next(struct epoch_buffer* self,
+                      const ann_real** in,
+                      const ann_real** out);
+
+#endif /* EPOCH_BUFFER_H_ */
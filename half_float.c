@@ -0,0 +1,111 @@
+/**************************************************************************************************
+* half_float.c: Innehller funktionsdefinitioner fr konvertering mellan flyttalstypen ann_real
+*               och flyttal p 16 bitar.
+**************************************************************************************************/
+#include "half_float.h"
+
+/**************************************************************************************************
+* float_bits: Anvnds fr att tolka bitmnstret i ett flyttal med enkel precision som ett heltal
+*             och vice versa.
+**************************************************************************************************/
+union float_bits
+{
+   float value;   /* Flyttal med enkel precision. */
+   uint32_t bits; /* Motsvarande bitmnster. */
+};
+
+/**************************************************************************************************
+* half_float_fp16_from_real: Returnerar angivet vrde konverterat till halv precision (fp16).
+*                            Vrden vars belopp verstiger det strsta representerbara vrdet
+*                            65504 blir ondliga, medan mycket sm vrden blir subnormala eller
+*                            noll. NaN blir tyst NaN med bevarade vre mantissabitar, likt
+*                            F16C. Vid dubbel precision avrundas vrdet frst till enkel
+*                            precision.
+*
+*                            - value: Vrdet som skall konverteras.
+**************************************************************************************************/
+uint16_t half_float_fp16_from_real(const ann_real value)
+{
+   union float_bits input = { (float)value };
+   const uint32_t sign = input.bits & 0x80000000u;
+   uint32_t bits = input.bits ^ sign;
+   uint16_t result = 0;
+
+   if (bits >= (127u + 16u) << 23)
+   {
+      result = bits > 0x7f800000u ? (uint16_t)(0x7e00u | ((bits >> 13) & 0x3ffu)) : 0x7c00;
+   }
+   else if (bits < 113u << 23)
+   {
+      const union float_bits magic = { .bits = ((127u - 15u) + (23u - 10u) + 1u) << 23 };
+      union float_bits subnormal = { .bits = bits };
+      subnormal.value += magic.value;
+      result = (uint16_t)(subnormal.bits - magic.bits);
+   }
+   else
+   {
+      const uint32_t odd = (bits >> 13) & 1u;
+      bits += ((uint32_t)(15 - 127) << 23) + 0xfffu + odd;
+      result = (uint16_t)(bits >> 13);
+   }
+   return (uint16_t)(result | (sign >> 16));
+}
+
+/**************************************************************************************************
+* half_float_fp16_to_real: Returnerar angivet vrde i halv precision (fp16) konverterat till
+*                          flyttalstypen ann_real. Konverteringen r exakt.
+*
+*                          - value: Vrdet som skall konverteras.
+**************************************************************************************************/
+ann_real half_float_fp16_to_real(const uint16_t value)
+{
+   const uint32_t exponent_mask = 0x7c00u << 13;
+   union float_bits result = { .bits = ((uint32_t)value & 0x7fffu) << 13 };
+   const uint32_t exponent = result.bits & exponent_mask;
+   result.bits += (127u - 15u) << 23;
+
+   if (exponent == exponent_mask)
+   {
+      result.bits += (128u - 16u) << 23;
+   }
+   else if (!exponent)
+   {
+      const union float_bits magic = { .bits = 113u << 23 };
+      result.bits += 1u << 23;
+      result.value -= magic.value;
+   }
+
+   result.bits |= ((uint32_t)value & 0x8000u) << 16;
+   return (ann_real)result.value;
+}
+
+/**************************************************************************************************
+* half_float_bf16_from_real: Returnerar angivet vrde konverterat till bfloat16 (bf16), vilket
+*                            motsvarar de vre sexton bitarna i ett flyttal med enkel precision
+*                            efter avrundning. Vid dubbel precision avrundas vrdet frst till
+*                            enkel precision.
+*
+*                            - value: Vrdet som skall konverteras.
+**************************************************************************************************/
+uint16_t half_float_bf16_from_real(const ann_real value)
+{
+   const union float_bits input = { (float)value };
+
+   if ((input.bits & 0x7fffffffu) > 0x7f800000u)
+   {
+      return (uint16_t)((input.bits >> 16) | 0x40u);
+   }
+   return (uint16_t)((input.bits + 0x7fffu + ((input.bits >> 16) & 1u)) >> 16);
+}
+
+/**************************************************************************************************
+* half_float_bf16_to_real: Returnerar angivet vrde i bfloat16 (bf16) konverterat till
+*                          flyttalstypen ann_real. Konverteringen r exakt.
+*
+*                          - value: Vrdet som skall konverteras.
+**************************************************************************************************/
+ann_real half_float_bf16_to_real(const uint16_t value)
+{
+   const union float_bits result = { .bits = (uint32_t)value << 16 };
+   return (ann_real)result.value;
+}
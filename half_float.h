@@ -0,0 +1,21 @@
+/**************************************************************************************************
+* half_float.h: Innehller funktioner fr konvertering mellan flyttalstypen ann_real och flyttal
+*               p 16 bitar, vilket anvnds fr att lagra vikter komprimerat. Tv format stds:
+*               IEEE 754 halv precision (fp16) med fem exponentbitar och tio mantissabitar,
+*               samt bfloat16 (bf16) med samma tta exponentbitar som enkel precision men
+*               enbart sju mantissabitar. Konvertering till 16 bitar avrundas till nrmaste
+*               vrde, dr vrden mitt emellan avrundas till jmnt.
+**************************************************************************************************/
+#ifndef HALF_FLOAT_H_
+#define HALF_FLOAT_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+
+/* Externa funktioner: */
+uint16_t half_float_fp16_from_real(const ann_real value);
+ann_real half_float_fp16_to_real(const uint16_t value);
+uint16_t half_float_bf16_from_real(const ann_real value);
+ann_real half_float_bf16_to_real(const uint16_t value);
+
+#endif /* HALF_FLOAT_H_ */
@@ -18,6 +18,11 @@
 * 
 *         Kr sedan programmet med fljande kommando:
 *         $ ./main
+*
+*         Vid frsta krningen sparas trningsdatan ven som en binr kopia i filen data.txt.bin
+*         bredvid data.txt. Kopian lses in i stllet fr textfilen vid efterfljande krningar,
+*         s lnge den r nyare n textfilen, och kan tas bort utan risk, varvid den skapas p
+*         nytt vid nsta krning.
 **************************************************************************************************/
 #include "ann.h"
 
@@ -30,11 +35,14 @@
 int main(void)
 {
    struct ann ann1;
+   struct double_2d_vector inputs;
    ann_new(&ann1, 3, 4, 1);
    ann_add_hidden_layers(&ann1, 2, 3);
    ann_load_training_data(&ann1, "data.txt");
    ann_train(&ann1, 10000, 0.01);
-   const struct double_2d_vector* inputs = &ann1.training_data.in;
-   ann_predict_range(&ann1, inputs, stdout);
+   double_2d_vector_new(&inputs);
+   training_data_get_inputs(&ann1.training_data, &inputs);
+   ann_predict_range(&ann1, &inputs, stdout);
+   double_2d_vector_delete(&inputs);
    return 0;
 }
\ No newline at end of file
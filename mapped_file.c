@@ -0,0 +1,193 @@
+/**************************************************************************************************
+* mapped_file.c: Innehller funktionsdefinitioner som anvnds fr minnesmappning av filer.
+**************************************************************************************************/
+#ifndef _DEFAULT_SOURCE
+#define _DEFAULT_SOURCE /* Krvs fr madvise och MADV_DONTNEED vid kompilering med c11. */
+#endif
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "mapped_file.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#define MAPPED_FILE_WIN32
+#elif defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPED_FILE_POSIX
+#endif
+
+/* Statiska funktioner: */
+static int mapped_file_read(struct mapped_file* self,
+                            const char* filepath);
+
+/**************************************************************************************************
+* mapped_file_new: Initierar angiven minnesmappad fil som tom.
+*
+*                  - self: Pekare till den minnesmappade filen.
+**************************************************************************************************/
+void mapped_file_new(struct mapped_file* self)
+{
+   self->data = 0;
+   self->size = 0;
+   self->mapped = false;
+   return;
+}
+
+/**************************************************************************************************
+* mapped_file_open: Minnesmappar angiven fil med privat (copy-on-write) tkomst. Startadressen
+*                   r justerad mot en sidgrns. Ifall minnesmappning inte stds eller
+*                   misslyckas lses filen i stllet in till ett cachejusterat minnesblock. Vid
+*                   misslyckande, exempelvis ifall filen inte finns eller r tom, returneras 1,
+*                   annars 0.
+*
+*                   - self    : Pekare till den minnesmappade filen.
+*                   - filepath: Pekare till filskvgen.
+**************************************************************************************************/
+int mapped_file_open(struct mapped_file* self,
+                     const char* filepath)
+{
+   mapped_file_new(self);
+#if defined(MAPPED_FILE_WIN32)
+   LARGE_INTEGER size;
+   HANDLE mapping = 0;
+   HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 
+                             FILE_ATTRIBUTE_NORMAL, 0);
+   if (file == INVALID_HANDLE_VALUE) return 1;
+
+   if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+   {
+      mapping = CreateFileMappingA(file, 0, PAGE_WRITECOPY, 0, 0, 0);
+   }
+   if (mapping)
+   {
+      self->data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+      self->size = (size_t)size.QuadPart;
+      CloseHandle(mapping);
+   }
+
+   CloseHandle(file);
+#elif defined(MAPPED_FILE_POSIX)
+   struct stat status;
+   const int file = open(filepath, O_RDONLY);
+   if (file < 0) return 1;
+
+   if (!fstat(file, &status) && status.st_size > 0)
+   {
+      void* data = mmap(0, (size_t)status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, file, 0);
+      if (data != MAP_FAILED)
+      {
+         self->data = data;
+         self->size = (size_t)status.st_size;
+      }
+   }
+
+   close(file);
+#endif
+   if (!self->data)
+   {
+      return mapped_file_read(self, filepath);
+   }
+
+   self->mapped = true;
+   return 0;
+}
+
+/**************************************************************************************************
+* mapped_file_close: Tar bort minnesmappningen fr angiven fil, alternativt frigr det
+*                    minnesblock som filen lstes in till. Pekare till filens innehll blir
+*                    drmed ogiltiga.
+*
+*                    - self: Pekare till den minnesmappade filen.
+**************************************************************************************************/
+void mapped_file_close(struct mapped_file* self)
+{
+   if (!self->data) return;
+
+   if (!self->mapped)
+   {
+      aligned_memory_free(self->data);
+   }
+   else
+   {
+#if defined(MAPPED_FILE_WIN32)
+      UnmapViewOfFile(self->data);
+#elif defined(MAPPED_FILE_POSIX)
+      munmap(self->data, self->size);
+#endif
+   }
+
+   mapped_file_new(self);
+   return;
+}
+
+/**************************************************************************************************
+* mapped_file_discard: Meddelar operativsystemet att angivet intervall av den mappade filen inte
+*                      kommer att lsas inom kort, s att motsvarande fysiska sidor kan frigras
+*                      direkt i stllet fr att ligga kvar i processens minne. Innehllet r
+*                      fortfarande tkomligt och lses d in frn filen igen, men ndringar som
+*                      har skrivits till intervallet gr frlorade. Enbart hela sidor inom
+*                      intervallet pverkas. Ifall filen har lstes in till heapen, eller
+*                      plattformen saknar std, ignoreras anropet.
+*
+*                      - self  : Pekare till den minnesmappade filen.
+*                      - offset: Intervallets brjan, rknat i byte frn filens brjan.
+*                      - size  : Intervallets storlek i byte.
+**************************************************************************************************/
+void mapped_file_discard(struct mapped_file* self,
+                         const size_t offset,
+                         const size_t size)
+{
+#if defined(MAPPED_FILE_POSIX)
+   const long page_size = sysconf(_SC_PAGESIZE);
+   const size_t page = page_size > 0 ? (size_t)page_size : 4096;
+   const size_t end = offset + size < self->size ? offset + size : self->size;
+   const size_t first = (offset + page - 1) / page * page;
+   const size_t last = end / page * page;
+
+   if (self->mapped && first < last)
+   {
+      madvise((unsigned char*)self->data + first, last - first, MADV_DONTNEED);
+   }
+#else
+   (void)self;
+   (void)offset;
+   (void)size;
+#endif
+   return;
+}
+
+/**************************************************************************************************
+* mapped_file_read: Lser in hela angiven fil till ett cachejusterat minnesblock, anvnds d
+*                   filen inte kan minnesmappas. Vid misslyckande returneras 1, annars 0.
+*
+*                   - self    : Pekare till den minnesmappade filen.
+*                   - filepath: Pekare till filskvgen.
+**************************************************************************************************/
+static int mapped_file_read(struct mapped_file* self,
+                            const char* filepath)
+{
+   FILE* fstream = fopen(filepath, "rb");
+   long size = 0;
+   if (!fstream) return 1;
+
+   if (!fseek(fstream, 0, SEEK_END) && (size = ftell(fstream)) > 0 && 
+       !fseek(fstream, 0, SEEK_SET))
+   {
+      self->data = aligned_memory_alloc((size_t)size);
+      self->size = (size_t)size;
+   }
+
+   if (self->data && fread(self->data, 1, self->size, fstream) != self->size)
+   {
+      aligned_memory_free(self->data);
+      mapped_file_new(self);
+   }
+
+   fclose(fstream);
+   return self->data ? 0 : 1;
+}
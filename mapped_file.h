@@ -0,0 +1,37 @@
+/**************************************************************************************************
+* mapped_file.h: Innehller funktionalitet fr att minnesmappa filer via strukten mapped_file
+*                samt motsvarande externa funktioner. Filens innehll blir drmed direkt
+*                tkomligt via en pekare utan att lsas in, dr operativsystemet lser in
+*                sidor vid behov och delar fysiska sidor mellan processer som mappar samma fil.
+*                Mappningen r privat (copy-on-write), vilket innebr att skrivningar till det
+*                mappade minnet r tilltna men aldrig pverkar filen eller andra processer.
+*                P plattformar som saknar std fr minnesmappning lses filen i stllet in
+*                till ett allokerat minnesblock.
+**************************************************************************************************/
+#ifndef MAPPED_FILE_H_
+#define MAPPED_FILE_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "aligned_memory.h"
+
+/**************************************************************************************************
+* mapped_file: Minnesmappad fil, vars innehll r tkomligt via pekaren data.
+**************************************************************************************************/
+struct mapped_file
+{
+   void* data;  /* Pekare till filens innehll (null om ingen fil r mappad). */
+   size_t size; /* Filens storlek i byte. */
+   bool mapped; /* Indikerar ifall innehllet r mappat (annars inlst till heapen). */
+};
+
+/* Externa funktioner: */
+void mapped_file_new(struct mapped_file* self);
+int mapped_file_open(struct mapped_file* self,
+                     const char* filepath);
+void mapped_file_close(struct mapped_file* self);
+void mapped_file_discard(struct mapped_file* self,
+                         const size_t offset,
+                         const size_t size);
+
+#endif /* MAPPED_FILE_H_ */
@@ -0,0 +1,188 @@
+/**************************************************************************************************
+* random_generator.c: Innehller funktionsdefinitioner som anvnds fr generering av slumptal.
+**************************************************************************************************/
+#include "random_generator.h"
+#include <stdatomic.h>
+
+#ifdef _MSC_VER
+#define RANDOM_GENERATOR_THREAD_LOCAL __declspec(thread)
+#else
+#define RANDOM_GENERATOR_THREAD_LOCAL _Thread_local
+#endif
+
+/* Statiska variabler: */
+static atomic_uint_fast64_t shared_seed = RANDOM_GENERATOR_DEFAULT_SEED;
+static atomic_uint_fast64_t num_streams = 0;
+static RANDOM_GENERATOR_THREAD_LOCAL struct random_generator local_generator;
+static RANDOM_GENERATOR_THREAD_LOCAL bool local_seeded = false;
+
+/* Statiska funktioner: */
+static inline uint64_t rotate_left(const uint64_t value,
+                                   const unsigned int shift);
+static inline uint64_t split_mix(uint64_t* value);
+
+/**************************************************************************************************
+* random_generator_new: Initierar angiven slumptalsgenerator med angivet fr. Fret expanderas
+*                       till generatorns tillstnd via algoritmen SplitMix64, vilket ger ett
+*                       vlblandat tillstnd skilt frn noll ven fr sm eller nrliggande frn.
+*
+*                       - self: Pekare till slumptalsgeneratorn.
+*                       - seed: Fret som generatorn skall initieras med.
+**************************************************************************************************/
+void random_generator_new(struct random_generator* self,
+                          const uint64_t seed)
+{
+   uint64_t value = seed;
+
+   for (size_t i = 0; i < 4; ++i)
+   {
+      self->state[i] = split_mix(&value);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* random_generator_next: Returnerar nsta slumptal p 64 bitar frn angiven slumptalsgenerator.
+*
+*                        - self: Pekare till slumptalsgeneratorn.
+**************************************************************************************************/
+uint64_t random_generator_next(struct random_generator* self)
+{
+   uint64_t* s = self->state;
+   const uint64_t result = rotate_left(s[1] * 5, 7) * 9;
+   const uint64_t t = s[1] << 17;
+
+   s[2] ^= s[0];
+   s[3] ^= s[1];
+   s[1] ^= s[2];
+   s[0] ^= s[3];
+   s[2] ^= t;
+   s[3] = rotate_left(s[3], 45);
+   return result;
+}
+
+/**************************************************************************************************
+* random_generator_index: Returnerar ett likformigt frdelat heltal i intervallet [0, size) frn
+*                         angiven slumptalsgenerator. Till skillnad frn rand() % size r
+*                         frdelningen helt utan snedvridning, d slumptal som skulle ge en
+*                         ojmn frdelning frkastas. Fr intervall under 2^32 anvnds Lemires
+*                         metod med en multiplikation i stllet fr en division per anrop,
+*                         medan strre intervall maskas till nrmast strre tvpotens. Ifall
+*                         storleken r noll returneras 0.
+*
+*                         - self: Pekare till slumptalsgeneratorn.
+*                         - size: Antalet mjliga vrden.
+**************************************************************************************************/
+size_t random_generator_index(struct random_generator* self,
+                              const size_t size)
+{
+   if (size <= 1) return 0;
+
+   if ((uint64_t)size <= UINT32_MAX)
+   {
+      const uint32_t range = (uint32_t)size;
+      uint64_t product = (random_generator_next(self) >> 32) * range;
+
+      if ((uint32_t)product < range)
+      {
+         const uint32_t threshold = (uint32_t)(0 - range) % range;
+
+         while ((uint32_t)product < threshold)
+         {
+            product = (random_generator_next(self) >> 32) * range;
+         }
+      }
+      return (size_t)(product >> 32);
+   }
+   else
+   {
+      uint64_t mask = (uint64_t)size - 1;
+      uint64_t value = 0;
+
+      for (unsigned int shift = 1; shift < 64; shift <<= 1)
+      {
+         mask |= mask >> shift;
+      }
+
+      do
+      {
+         value = random_generator_next(self) & mask;
+      } while (value >= (uint64_t)size);
+      return (size_t)value;
+   }
+}
+
+/**************************************************************************************************
+* random_generator_real: Returnerar ett likformigt frdelat flyttal i intervallet [0.0, 1.0)
+*                        frn angiven slumptalsgenerator med 53 bitars upplsning.
+*
+*                        - self: Pekare till slumptalsgeneratorn.
+**************************************************************************************************/
+double random_generator_real(struct random_generator* self)
+{
+   return (random_generator_next(self) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+/**************************************************************************************************
+* random_generator_local: Returnerar en pekare till den anropande trdens egen
+*                         slumptalsgenerator, vilken kan anvndas utan synkronisering. Vid
+*                         trdens frsta anrop seedas generatorn med det gemensamma fret
+*                         kombinerat med ett lpnummer, s att varje trd fr en egen sekvens.
+**************************************************************************************************/
+struct random_generator* random_generator_local(void)
+{
+   if (!local_seeded)
+   {
+      const uint64_t stream = atomic_fetch_add(&num_streams, 1);
+      uint64_t value = atomic_load(&shared_seed) + stream * 0x9e3779b97f4a7c15ULL;
+      random_generator_new(&local_generator, split_mix(&value));
+      local_seeded = true;
+   }
+   return &local_generator;
+}
+
+/**************************************************************************************************
+* random_generator_seed: Stter det gemensamma fret fr trdarnas slumptalsgeneratorer. Den
+*                        anropande trdens generator seedas om direkt med fret, medan vriga
+*                        trdar seedas med fret och efterfljande lpnummer vid sitt frsta
+*                        anrop till random_generator_local. Anropas drmed lmpligen frn
+*                        huvudtrden innan ntverk och trningsdata skapas, s att
+*                        startvikterna och samtliga randomiseringar kan terskapas.
+*
+*                        - seed: Det nya fret.
+**************************************************************************************************/
+void random_generator_seed(const uint64_t seed)
+{
+   uint64_t value = seed;
+   atomic_store(&shared_seed, seed);
+   atomic_store(&num_streams, 1);
+   random_generator_new(&local_generator, split_mix(&value));
+   local_seeded = true;
+   return;
+}
+
+/**************************************************************************************************
+* rotate_left: Returnerar angivet heltal roterat angivet antal bitar t vnster.
+*
+*              - value: Heltalet som skall roteras.
+*              - shift: Antalet bitar som heltalet skall roteras (1 - 63).
+**************************************************************************************************/
+static inline uint64_t rotate_left(const uint64_t value,
+                                   const unsigned int shift)
+{
+   return (value << shift) | (value >> (64 - shift));
+}
+
+/**************************************************************************************************
+* split_mix: Stegar fram angivet tillstnd fr algoritmen SplitMix64 och returnerar nsta
+*            blandade vrde.
+*
+*            - value: Pekare till tillstndet.
+**************************************************************************************************/
+static inline uint64_t split_mix(uint64_t* value)
+{
+   uint64_t z = (*value += 0x9e3779b97f4a7c15ULL);
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+   return z ^ (z >> 31);
+}
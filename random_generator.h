@@ -0,0 +1,40 @@
+/**************************************************************************************************
+* random_generator.h: Innehller funktionalitet fr generering av slumptal via strukten
+*                     random_generator samt motsvarande externa funktioner. Slumptalen genereras
+*                     med algoritmen xoshiro256**, som har ett tillstnd p 256 bitar och en
+*                     period p 2^256 - 1. Till skillnad frn standardbibliotekets rand() delar
+*                     generatorerna inget globalt tillstnd och behver drmed inga ls, ger
+*                     slumptal p 64 bitar samt ger samma sekvens p samtliga plattformar fr ett
+*                     givet fr. Varje trd har dessutom en egen generator, vilken hmtas via
+*                     funktionen random_generator_local och seedas frn ett gemensamt fr som
+*                     kan sttas via funktionen random_generator_seed.
+**************************************************************************************************/
+#ifndef RANDOM_GENERATOR_H_
+#define RANDOM_GENERATOR_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+
+/* Makrodefinitioner: */
+#define RANDOM_GENERATOR_DEFAULT_SEED 0x853c49e6748fea9bULL /* Fr om inget annat har satts. */
+
+/**************************************************************************************************
+* random_generator: Slumptalsgenerator, vars tillstnd aldrig fr vara enbart nollor, vilket
+*                   undviks genom att generatorn alltid initieras via ett fr.
+**************************************************************************************************/
+struct random_generator
+{
+   uint64_t state[4]; /* Generatorns tillstnd. */
+};
+
+/* Externa funktioner: */
+void random_generator_new(struct random_generator* self,
+                          const uint64_t seed);
+uint64_t random_generator_next(struct random_generator* self);
+size_t random_generator_index(struct random_generator* self,
+                              const size_t size);
+double random_generator_real(struct random_generator* self);
+struct random_generator* random_generator_local(void);
+void random_generator_seed(const uint64_t seed);
+
+#endif /* RANDOM_GENERATOR_H_ */
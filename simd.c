@@ -0,0 +1,1932 @@
+/**************************************************************************************************
+* simd.c: Innehller funktionsdefinitioner fr vektoriserade berkningskrnor samt val av
+*         instruktionsuppsttning under krning. Krnorna fr SSE2, AVX2 och AVX-512 kompileras
+*         med funktionsspecifika mlattribut, s att samma binrfil kan kras p samtliga
+*         x86-processorer och nd nyttja de bredaste vektorer som respektive processor stdjer.
+*         Krnorna r skrivna via makron fr respektive instruktionsuppsttning, som verstts
+*         till instruktioner fr enkel eller dubbel precision beroende p typen ann_real.
+**************************************************************************************************/
+#include "simd.h"
+#include "half_float.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SIMD_TARGET(isa)
+#else
+#include <cpuid.h>
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+#ifdef SIMD_X86
+#ifdef ANN_SINGLE_PRECISION
+
+/* Makrodefinitioner fr enkel precision: */
+#define SSE2_VEC              __m128
+#define SSE2_LANES            4
+#define SSE2_LOAD(p)          _mm_loadu_ps(p)
+#define SSE2_STORE(p, v)      _mm_storeu_ps(p, v)
+#define SSE2_SET1(x)          _mm_set1_ps(x)
+#define SSE2_ZERO()           _mm_setzero_ps()
+#define SSE2_ADD(a, b)        _mm_add_ps(a, b)
+#define SSE2_MUL(a, b)        _mm_mul_ps(a, b)
+#define SSE2_MAX(a, b)        _mm_max_ps(a, b)
+#define SSE2_AND(a, b)        _mm_and_ps(a, b)
+#define SSE2_CMPGT(a, b)      _mm_cmpgt_ps(a, b)
+
+#define AVX2_VEC              __m256
+#define AVX2_LANES            8
+#define AVX2_LOAD(p)          _mm256_loadu_ps(p)
+#define AVX2_STORE(p, v)      _mm256_storeu_ps(p, v)
+#define AVX2_SET1(x)          _mm256_set1_ps(x)
+#define AVX2_ZERO()           _mm256_setzero_ps()
+#define AVX2_ADD(a, b)        _mm256_add_ps(a, b)
+#define AVX2_FMADD(a, b, c)   _mm256_fmadd_ps(a, b, c)
+#define AVX2_MAX(a, b)        _mm256_max_ps(a, b)
+#define AVX2_AND(a, b)        _mm256_and_ps(a, b)
+#define AVX2_CMPGT(a, b)      _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+
+#define AVX512_VEC            __m512
+#define AVX512_MASK           __mmask16
+#define AVX512_LANES          16
+#define AVX512_LOAD(p)        _mm512_loadu_ps(p)
+#define AVX512_STORE(p, v)    _mm512_storeu_ps(p, v)
+#define AVX512_SET1(x)        _mm512_set1_ps(x)
+#define AVX512_ZERO()         _mm512_setzero_ps()
+#define AVX512_ADD(a, b)      _mm512_add_ps(a, b)
+#define AVX512_FMADD(a, b, c) _mm512_fmadd_ps(a, b, c)
+#define AVX512_MAX(a, b)      _mm512_max_ps(a, b)
+#define AVX512_SUM(v)         _mm512_reduce_add_ps(v)
+#define AVX512_MASKZ_LOAD(m, p)     _mm512_maskz_loadu_ps(m, p)
+#define AVX512_MASK_STORE(p, m, v)  _mm512_mask_storeu_ps(p, m, v)
+#define AVX512_MASK_CMPGT(m, a, b)  _mm512_mask_cmp_ps_mask(m, a, b, _CMP_GT_OQ)
+
+#else
+
+/* Makrodefinitioner fr dubbel precision: */
+#define SSE2_VEC              __m128d
+#define SSE2_LANES            2
+#define SSE2_LOAD(p)          _mm_loadu_pd(p)
+#define SSE2_STORE(p, v)      _mm_storeu_pd(p, v)
+#define SSE2_SET1(x)          _mm_set1_pd(x)
+#define SSE2_ZERO()           _mm_setzero_pd()
+#define SSE2_ADD(a, b)        _mm_add_pd(a, b)
+#define SSE2_MUL(a, b)        _mm_mul_pd(a, b)
+#define SSE2_MAX(a, b)        _mm_max_pd(a, b)
+#define SSE2_AND(a, b)        _mm_and_pd(a, b)
+#define SSE2_CMPGT(a, b)      _mm_cmpgt_pd(a, b)
+
+#define AVX2_VEC              __m256d
+#define AVX2_LANES            4
+#define AVX2_LOAD(p)          _mm256_loadu_pd(p)
+#define AVX2_STORE(p, v)      _mm256_storeu_pd(p, v)
+#define AVX2_SET1(x)          _mm256_set1_pd(x)
+#define AVX2_ZERO()           _mm256_setzero_pd()
+#define AVX2_ADD(a, b)        _mm256_add_pd(a, b)
+#define AVX2_FMADD(a, b, c)   _mm256_fmadd_pd(a, b, c)
+#define AVX2_MAX(a, b)        _mm256_max_pd(a, b)
+#define AVX2_AND(a, b)        _mm256_and_pd(a, b)
+#define AVX2_CMPGT(a, b)      _mm256_cmp_pd(a, b, _CMP_GT_OQ)
+
+#define AVX512_VEC            __m512d
+#define AVX512_MASK           __mmask8
+#define AVX512_LANES          8
+#define AVX512_LOAD(p)        _mm512_loadu_pd(p)
+#define AVX512_STORE(p, v)    _mm512_storeu_pd(p, v)
+#define AVX512_SET1(x)        _mm512_set1_pd(x)
+#define AVX512_ZERO()         _mm512_setzero_pd()
+#define AVX512_ADD(a, b)      _mm512_add_pd(a, b)
+#define AVX512_FMADD(a, b, c) _mm512_fmadd_pd(a, b, c)
+#define AVX512_MAX(a, b)      _mm512_max_pd(a, b)
+#define AVX512_SUM(v)         _mm512_reduce_add_pd(v)
+#define AVX512_MASKZ_LOAD(m, p)     _mm512_maskz_loadu_pd(m, p)
+#define AVX512_MASK_STORE(p, m, v)  _mm512_mask_storeu_pd(p, m, v)
+#define AVX512_MASK_CMPGT(m, a, b)  _mm512_mask_cmp_pd_mask(m, a, b, _CMP_GT_OQ)
+
+#endif /* ANN_SINGLE_PRECISION */
+#endif /* SIMD_X86 */
+
+/**************************************************************************************************
+* simd_kernels: Berkningskrnor fr en instruktionsuppsttning, en per funktionspekare.
+**************************************************************************************************/
+struct simd_kernels
+{
+   ann_real (*dot)(const ann_real*, const ann_real*, const size_t);
+   void (*dot_4)(const ann_real*, const ann_real*, const size_t, const size_t, ann_real*);
+   void (*axpy)(ann_real*, const ann_real, const ann_real*, const size_t);
+   void (*axpy_update)(ann_real*, const ann_real, ann_real*, const ann_real, const ann_real*,
+                       const size_t);
+   void (*transpose_product)(ann_real*, const ann_real*, const size_t, const ann_real*,
+                             const size_t, const size_t);
+   void (*matrix_product)(ann_real*, const size_t, const ann_real*, const size_t,
+                          const ann_real*, const size_t, const size_t, const size_t,
+                          const size_t);
+   void (*relu)(ann_real*, const size_t);
+   void (*delta_relu)(ann_real*, const ann_real*, const size_t);
+   int32_t (*dot_u8s8)(const uint8_t*, const int8_t*, const size_t);
+   ann_real (*dot_fp16)(const uint16_t*, const ann_real*, const size_t);
+   ann_real (*dot_bf16)(const uint16_t*, const ann_real*, const size_t);
+   void (*encode_fp16)(uint16_t*, const ann_real*, const size_t);
+   void (*encode_bf16)(uint16_t*, const ann_real*, const size_t);
+};
+
+/* Statiska funktioner: */
+static ann_real scalar_dot(const ann_real* a,
+                           const ann_real* b,
+                           const size_t size);
+static void scalar_dot_4(const ann_real* weights,
+                         const ann_real* input,
+                         const size_t input_stride,
+                         const size_t size,
+                         ann_real* sums);
+static void scalar_axpy(ann_real* y,
+                        const ann_real a,
+                        const ann_real* x,
+                        const size_t size);
+static void scalar_axpy_update(ann_real* y,
+                               const ann_real e,
+                               ann_real* w,
+                               const ann_real a,
+                               const ann_real* x,
+                               const size_t size);
+static void scalar_transpose_product(ann_real* output,
+                                     const ann_real* matrix,
+                                     const size_t stride,
+                                     const ann_real* vector,
+                                     const size_t num_rows,
+                                     const size_t num_columns);
+static void scalar_matrix_product(ann_real* output,
+                                  const size_t output_stride,
+                                  const ann_real* matrix,
+                                  const size_t matrix_stride,
+                                  const ann_real* input,
+                                  const size_t input_stride,
+                                  const size_t num_rows,
+                                  const size_t size,
+                                  const size_t num_columns);
+static void scalar_relu(ann_real* data,
+                        const size_t size);
+static void scalar_delta_relu(ann_real* error,
+                              const ann_real* output,
+                              const size_t size);
+static int32_t scalar_dot_u8s8(const uint8_t* a,
+                               const int8_t* b,
+                               const size_t size);
+static ann_real scalar_dot_fp16(const uint16_t* a,
+                                const ann_real* b,
+                                const size_t size);
+static ann_real scalar_dot_bf16(const uint16_t* a,
+                                const ann_real* b,
+                                const size_t size);
+static void scalar_encode_fp16(uint16_t* output,
+                               const ann_real* input,
+                               const size_t size);
+static void scalar_encode_bf16(uint16_t* output,
+                               const ann_real* input,
+                               const size_t size);
+static void simd_init_once(void);
+static void simd_apply_level(const enum simd_level level);
+
+/* Statiska variabler: */
+static enum simd_level current_level = SIMD_LEVEL_SCALAR;
+static once_flag init_flag = ONCE_FLAG_INIT;
+static const struct simd_kernels scalar_kernels =
+{
+   &scalar_dot, &scalar_dot_4, &scalar_axpy, &scalar_axpy_update, &scalar_transpose_product,
+   &scalar_matrix_product, &scalar_relu, &scalar_delta_relu, &scalar_dot_u8s8, &scalar_dot_fp16,
+   &scalar_dot_bf16, &scalar_encode_fp16, &scalar_encode_bf16
+};
+
+/* Funktionspekare (pekar p de skalra krnorna tills simd_init har valt krnor): */
+ann_real (*simd_dot)(const ann_real* a,
+                     const ann_real* b,
+                     const size_t size) = &scalar_dot;
+void (*simd_dot_4)(const ann_real* weights,
+                   const ann_real* input,
+                   const size_t input_stride,
+                   const size_t size,
+                   ann_real* sums) = &scalar_dot_4;
+void (*simd_axpy)(ann_real* y,
+                  const ann_real a,
+                  const ann_real* x,
+                  const size_t size) = &scalar_axpy;
+void (*simd_axpy_update)(ann_real* y,
+                         const ann_real e,
+                         ann_real* w,
+                         const ann_real a,
+                         const ann_real* x,
+                         const size_t size) = &scalar_axpy_update;
+void (*simd_transpose_product)(ann_real* output,
+                               const ann_real* matrix,
+                               const size_t stride,
+                               const ann_real* vector,
+                               const size_t num_rows,
+                               const size_t num_columns) = &scalar_transpose_product;
+void (*simd_matrix_product)(ann_real* output,
+                            const size_t output_stride,
+                            const ann_real* matrix,
+                            const size_t matrix_stride,
+                            const ann_real* input,
+                            const size_t input_stride,
+                            const size_t num_rows,
+                            const size_t size,
+                            const size_t num_columns) = &scalar_matrix_product;
+void (*simd_relu)(ann_real* data,
+                  const size_t size) = &scalar_relu;
+void (*simd_delta_relu)(ann_real* error,
+                        const ann_real* output,
+                        const size_t size) = &scalar_delta_relu;
+int32_t (*simd_dot_u8s8)(const uint8_t* a,
+                         const int8_t* b,
+                         const size_t size) = &scalar_dot_u8s8;
+ann_real (*simd_dot_fp16)(const uint16_t* a,
+                          const ann_real* b,
+                          const size_t size) = &scalar_dot_fp16;
+ann_real (*simd_dot_bf16)(const uint16_t* a,
+                          const ann_real* b,
+                          const size_t size) = &scalar_dot_bf16;
+void (*simd_encode_fp16)(uint16_t* output,
+                         const ann_real* input,
+                         const size_t size) = &scalar_encode_fp16;
+void (*simd_encode_bf16)(uint16_t* output,
+                         const ann_real* input,
+                         const size_t size) = &scalar_encode_bf16;
+
+/**************************************************************************************************
+* scalar_dot: Returnerar skalrprodukten av tv flt med angiven storlek.
+**************************************************************************************************/
+static ann_real scalar_dot(const ann_real* a,
+                           const ann_real* b,
+                           const size_t size)
+{
+   ann_real sum = 0;
+   for (size_t i = 0; i < size; ++i)
+   {
+      sum += a[i] * b[i];
+   }
+   return sum;
+}
+
+/**************************************************************************************************
+* scalar_dot_4: Berknar skalrprodukten mellan en viktrad och fyra rader indata, dr raderna
+*               ligger med angivet radavstnd. Resultaten lagras i fltet sums.
+**************************************************************************************************/
+static void scalar_dot_4(const ann_real* weights,
+                         const ann_real* input,
+                         const size_t input_stride,
+                         const size_t size,
+                         ann_real* sums)
+{
+   const ann_real* x0 = input;
+   const ann_real* x1 = x0 + input_stride;
+   const ann_real* x2 = x1 + input_stride;
+   const ann_real* x3 = x2 + input_stride;
+   ann_real sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+
+   for (size_t i = 0; i < size; ++i)
+   {
+      const ann_real w = weights[i];
+      sum0 += x0[i] * w;
+      sum1 += x1[i] * w;
+      sum2 += x2[i] * w;
+      sum3 += x3[i] * w;
+   }
+
+   sums[0] = sum0;
+   sums[1] = sum1;
+   sums[2] = sum2;
+   sums[3] = sum3;
+   return;
+}
+
+/**************************************************************************************************
+* scalar_axpy: Adderar a * x till y elementvis.
+**************************************************************************************************/
+static void scalar_axpy(ann_real* y,
+                        const ann_real a,
+                        const ann_real* x,
+                        const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      y[i] += a * x[i];
+   }
+   return;
+}
+
+/**************************************************************************************************
+* scalar_axpy_update: Adderar e * w till y och drefter a * x till w elementvis, dr y berknas
+*                     med vikternas vrden fre uppdateringen.
+**************************************************************************************************/
+static void scalar_axpy_update(ann_real* y,
+                               const ann_real e,
+                               ann_real* w,
+                               const ann_real a,
+                               const ann_real* x,
+                               const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      y[i] += e * w[i];
+      w[i] += a * x[i];
+   }
+   return;
+}
+
+/**************************************************************************************************
+* scalar_transpose_product: Berknar produkten mellan den transponerade matrisen och angiven
+*                           vektor, allts output[i] = sum(vector[j] * matrix[j][i]). Matrisen
+*                           lses rad fr rad, fyra rader t gngen, dr varje rad multiplicerad
+*                           med motsvarande element i vektorn adderas till utdatan. Drmed lper
+*                           den innersta loopen lngs sammanhngande minne i stllet fr nedt
+*                           en kolumn, medan utdatan ligger kvar i cacheminnet. Raderna adderas
+*                           i samma ordning som vid kolumnvis summering, s resultatet pverkas
+*                           inte.
+**************************************************************************************************/
+static void scalar_transpose_product(ann_real* output,
+                                     const ann_real* matrix,
+                                     const size_t stride,
+                                     const ann_real* vector,
+                                     const size_t num_rows,
+                                     const size_t num_columns)
+{
+   size_t j = 0;
+
+   for (size_t i = 0; i < num_columns; ++i)
+   {
+      output[i] = 0;
+   }
+
+   for (; j + 4 <= num_rows; j += 4)
+   {
+      const ann_real* r0 = matrix + j * stride;
+      const ann_real* r1 = r0 + stride;
+      const ann_real* r2 = r1 + stride;
+      const ann_real* r3 = r2 + stride;
+      const ann_real v0 = vector[j], v1 = vector[j + 1], v2 = vector[j + 2], v3 = vector[j + 3];
+
+      for (size_t i = 0; i < num_columns; ++i)
+      {
+         output[i] = output[i] + v0 * r0[i] + v1 * r1[i] + v2 * r2[i] + v3 * r3[i];
+      }
+   }
+
+   for (; j < num_rows; ++j)
+   {
+      scalar_axpy(output, vector[j], matrix + j * stride, num_columns);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* scalar_matrix_product: Berknar matrisprodukten output = matrix * input, dr matrix har
+*                        num_rows rader och size kolumner medan input har size rader och
+*                        num_columns kolumner. Samtliga matriser lagras radvis med angivna
+*                        radavstnd. Varje element i matrix multipliceras med en hel rad i input,
+*                        s att de innersta looparna lper lngs sammanhngande minne.
+**************************************************************************************************/
+static void scalar_matrix_product(ann_real* output,
+                                  const size_t output_stride,
+                                  const ann_real* matrix,
+                                  const size_t matrix_stride,
+                                  const ann_real* input,
+                                  const size_t input_stride,
+                                  const size_t num_rows,
+                                  const size_t size,
+                                  const size_t num_columns)
+{
+   for (size_t i = 0; i < num_rows; ++i)
+   {
+      const ann_real* m = matrix + i * matrix_stride;
+      ann_real* y = output + i * output_stride;
+
+      for (size_t c = 0; c < num_columns; ++c)
+      {
+         y[c] = 0;
+      }
+
+      for (size_t k = 0; k < size; ++k)
+      {
+         const ann_real* x = input + k * input_stride;
+         for (size_t c = 0; c < num_columns; ++c)
+         {
+            y[c] += m[k] * x[c];
+         }
+      }
+   }
+   return;
+}
+
+/**************************************************************************************************
+* scalar_relu: Erstter samtliga negativa vrden i angivet flt med 0.0.
+**************************************************************************************************/
+static void scalar_relu(ann_real* data,
+                        const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      data[i] = data[i] > 0 ? data[i] : 0;
+   }
+   return;
+}
+
+/**************************************************************************************************
+* scalar_delta_relu: Multiplicerar avvikelserna med derivatan av ReLU fr motsvarande utsignal,
+*                    vilket innebr att avvikelser fr noder vars utsignal r 0.0 nollstlls.
+**************************************************************************************************/
+static void scalar_delta_relu(ann_real* error,
+                              const ann_real* output,
+                              const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      error[i] = output[i] > 0 ? error[i] : 0;
+   }
+   return;
+}
+
+/**************************************************************************************************
+* scalar_dot_u8s8: Returnerar skalrprodukten mellan ett flt med osignerade och ett flt med
+*                  signerade 8-bitars heltal, ackumulerad i 32 bitar. Elementen i det osignerade
+*                  fltet fr hgst vara 127, s att summan av tv intilliggande produkter ryms
+*                  i 16 bitar ven i de vektoriserade krnorna. Samtliga krnor ger drmed
+*                  exakt samma resultat.
+**************************************************************************************************/
+static int32_t scalar_dot_u8s8(const uint8_t* a,
+                               const int8_t* b,
+                               const size_t size)
+{
+   int32_t sum = 0;
+   for (size_t i = 0; i < size; ++i)
+   {
+      sum += (int32_t)a[i] * (int32_t)b[i];
+   }
+   return sum;
+}
+
+/**************************************************************************************************
+* scalar_dot_fp16: Returnerar skalrprodukten mellan ett flt med flyttal i halv precision (fp16)
+*                  och ett flt med flyttal av typen ann_real. Varje element i det frsta fltet
+*                  konverteras exakt till ann_real innan multiplikationen, s att summeringen
+*                  sker med samma precision som i scalar_dot.
+**************************************************************************************************/
+static ann_real scalar_dot_fp16(const uint16_t* a,
+                                const ann_real* b,
+                                const size_t size)
+{
+   ann_real sum = 0;
+   for (size_t i = 0; i < size; ++i)
+   {
+      sum += half_float_fp16_to_real(a[i]) * b[i];
+   }
+   return sum;
+}
+
+/**************************************************************************************************
+* scalar_dot_bf16: Motsvarar scalar_dot_fp16 fr ett frsta flt med flyttal i formatet bfloat16.
+**************************************************************************************************/
+static ann_real scalar_dot_bf16(const uint16_t* a,
+                                const ann_real* b,
+                                const size_t size)
+{
+   ann_real sum = 0;
+   for (size_t i = 0; i < size; ++i)
+   {
+      sum += half_float_bf16_to_real(a[i]) * b[i];
+   }
+   return sum;
+}
+
+/**************************************************************************************************
+* scalar_encode_fp16: Konverterar angivet flt med flyttal av typen ann_real till halv precision
+*                     (fp16). Vid dubbel precision avrundas varje vrde frst till enkel
+*                     precision, vilket motsvarar de vektoriserade krnorna.
+**************************************************************************************************/
+static void scalar_encode_fp16(uint16_t* output,
+                               const ann_real* input,
+                               const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      output[i] = half_float_fp16_from_real(input[i]);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* scalar_encode_bf16: Motsvarar scalar_encode_fp16 fr konvertering till formatet bfloat16.
+**************************************************************************************************/
+static void scalar_encode_bf16(uint16_t* output,
+                               const ann_real* input,
+                               const size_t size)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      output[i] = half_float_bf16_from_real(input[i]);
+   }
+   return;
+}
+
+#ifdef SIMD_X86
+
+/**************************************************************************************************
+* SSE2: Krnor fr 128-bitars vektorer.
+**************************************************************************************************/
+SIMD_TARGET("sse2")
+static inline ann_real sse2_sum(const SSE2_VEC x)
+{
+#ifdef ANN_SINGLE_PRECISION
+   const __m128 sum = _mm_add_ps(x, _mm_movehl_ps(x, x));
+   return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+#else
+   return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+#endif
+}
+
+SIMD_TARGET("sse2")
+static ann_real sse2_dot(const ann_real* a,
+                         const ann_real* b,
+                         const size_t size)
+{
+   SSE2_VEC sum0 = SSE2_ZERO(), sum1 = SSE2_ZERO();
+   size_t i = 0;
+
+   for (; i + 2 * SSE2_LANES <= size; i += 2 * SSE2_LANES)
+   {
+      sum0 = SSE2_ADD(sum0, SSE2_MUL(SSE2_LOAD(a + i), SSE2_LOAD(b + i)));
+      sum1 = SSE2_ADD(sum1, SSE2_MUL(SSE2_LOAD(a + i + SSE2_LANES), 
+                                     SSE2_LOAD(b + i + SSE2_LANES)));
+   }
+
+   ann_real sum = sse2_sum(SSE2_ADD(sum0, sum1));
+   for (; i < size; ++i)
+   {
+      sum += a[i] * b[i];
+   }
+   return sum;
+}
+
+SIMD_TARGET("sse2")
+static void sse2_dot_4(const ann_real* weights,
+                       const ann_real* input,
+                       const size_t input_stride,
+                       const size_t size,
+                       ann_real* sums)
+{
+   const ann_real* x0 = input;
+   const ann_real* x1 = x0 + input_stride;
+   const ann_real* x2 = x1 + input_stride;
+   const ann_real* x3 = x2 + input_stride;
+   SSE2_VEC sum0 = SSE2_ZERO(), sum1 = SSE2_ZERO(), sum2 = SSE2_ZERO(), sum3 = SSE2_ZERO();
+   size_t i = 0;
+
+   for (; i + SSE2_LANES <= size; i += SSE2_LANES)
+   {
+      const SSE2_VEC w = SSE2_LOAD(weights + i);
+      sum0 = SSE2_ADD(sum0, SSE2_MUL(SSE2_LOAD(x0 + i), w));
+      sum1 = SSE2_ADD(sum1, SSE2_MUL(SSE2_LOAD(x1 + i), w));
+      sum2 = SSE2_ADD(sum2, SSE2_MUL(SSE2_LOAD(x2 + i), w));
+      sum3 = SSE2_ADD(sum3, SSE2_MUL(SSE2_LOAD(x3 + i), w));
+   }
+
+   sums[0] = sse2_sum(sum0);
+   sums[1] = sse2_sum(sum1);
+   sums[2] = sse2_sum(sum2);
+   sums[3] = sse2_sum(sum3);
+
+   for (; i < size; ++i)
+   {
+      sums[0] += x0[i] * weights[i];
+      sums[1] += x1[i] * weights[i];
+      sums[2] += x2[i] * weights[i];
+      sums[3] += x3[i] * weights[i];
+   }
+   return;
+}
+
+SIMD_TARGET("sse2")
+static void sse2_axpy(ann_real* y,
+                      const ann_real a,
+                      const ann_real* x,
+                      const size_t size)
+{
+   const SSE2_VEC va = SSE2_SET1(a);
+   size_t i = 0;
+
+   for (; i + SSE2_LANES <= size; i += SSE2_LANES)
+   {
+      SSE2_STORE(y + i, SSE2_ADD(SSE2_LOAD(y + i), SSE2_MUL(va, SSE2_LOAD(x + i))));
+   }
+   for (; i < size; ++i)
+   {
+      y[i] += a * x[i];
+   }
+   return;
+}
+
+SIMD_TARGET("sse2")
+static void sse2_axpy_update(ann_real* y,
+                             const ann_real e,
+                             ann_real* w,
+                             const ann_real a,
+                             const ann_real* x,
+                             const size_t size)
+{
+   const SSE2_VEC ve = SSE2_SET1(e);
+   const SSE2_VEC va = SSE2_SET1(a);
+   size_t i = 0;
+
+   for (; i + SSE2_LANES <= size; i += SSE2_LANES)
+   {
+      const SSE2_VEC vw = SSE2_LOAD(w + i);
+      SSE2_STORE(y + i, SSE2_ADD(SSE2_LOAD(y + i), SSE2_MUL(ve, vw)));
+      SSE2_STORE(w + i, SSE2_ADD(vw, SSE2_MUL(va, SSE2_LOAD(x + i))));
+   }
+   scalar_axpy_update(y + i, e, w + i, a, x + i, size - i);
+   return;
+}
+
+SIMD_TARGET("sse2")
+static void sse2_transpose_product(ann_real* output,
+                                   const ann_real* matrix,
+                                   const size_t stride,
+                                   const ann_real* vector,
+                                   const size_t num_rows,
+                                   const size_t num_columns)
+{
+   size_t j = 0;
+
+   for (size_t i = 0; i < num_columns; ++i)
+   {
+      output[i] = 0;
+   }
+
+   for (; j + 4 <= num_rows; j += 4)
+   {
+      const ann_real* r0 = matrix + j * stride;
+      const ann_real* r1 = r0 + stride;
+      const ann_real* r2 = r1 + stride;
+      const ann_real* r3 = r2 + stride;
+      const SSE2_VEC v0 = SSE2_SET1(vector[j]), v1 = SSE2_SET1(vector[j + 1]);
+      const SSE2_VEC v2 = SSE2_SET1(vector[j + 2]), v3 = SSE2_SET1(vector[j + 3]);
+      size_t i = 0;
+
+      for (; i + SSE2_LANES <= num_columns; i += SSE2_LANES)
+      {
+         SSE2_VEC sum = SSE2_ADD(SSE2_LOAD(output + i), SSE2_MUL(v0, SSE2_LOAD(r0 + i)));
+         sum = SSE2_ADD(sum, SSE2_MUL(v1, SSE2_LOAD(r1 + i)));
+         sum = SSE2_ADD(sum, SSE2_MUL(v2, SSE2_LOAD(r2 + i)));
+         sum = SSE2_ADD(sum, SSE2_MUL(v3, SSE2_LOAD(r3 + i)));
+         SSE2_STORE(output + i, sum);
+      }
+      for (; i < num_columns; ++i)
+      {
+         output[i] = output[i] + vector[j] * r0[i] + vector[j + 1] * r1[i] + 
+            vector[j + 2] * r2[i] + vector[j + 3] * r3[i];
+      }
+   }
+
+   for (; j < num_rows; ++j)
+   {
+      sse2_axpy(output, vector[j], matrix + j * stride, num_columns);
+   }
+   return;
+}
+
+SIMD_TARGET("sse2")
+static void sse2_matrix_product(ann_real* output,
+                                const size_t output_stride,
+                                const ann_real* matrix,
+                                const size_t matrix_stride,
+                                const ann_real* input,
+                                const size_t input_stride,
+                                const size_t num_rows,
+                                const size_t size,
+                                const size_t num_columns)
+{
+   size_t c = 0;
+
+   for (; c + 2 * SSE2_LANES <= num_columns; c += 2 * SSE2_LANES)
+   {
+      size_t i = 0;
+
+      for (; i + 4 <= num_rows; i += 4)
+      {
+         const ann_real* m0 = matrix + i * matrix_stride;
+         const ann_real* m1 = m0 + matrix_stride;
+         const ann_real* m2 = m1 + matrix_stride;
+         const ann_real* m3 = m2 + matrix_stride;
+         ann_real* y = output + i * output_stride + c;
+         SSE2_VEC sum00 = SSE2_ZERO(), sum01 = SSE2_ZERO();
+         SSE2_VEC sum10 = SSE2_ZERO(), sum11 = SSE2_ZERO();
+         SSE2_VEC sum20 = SSE2_ZERO(), sum21 = SSE2_ZERO();
+         SSE2_VEC sum30 = SSE2_ZERO(), sum31 = SSE2_ZERO();
+
+         for (size_t k = 0; k < size; ++k)
+         {
+            const ann_real* x = input + k * input_stride + c;
+            const SSE2_VEC x0 = SSE2_LOAD(x);
+            const SSE2_VEC x1 = SSE2_LOAD(x + SSE2_LANES);
+            SSE2_VEC w = SSE2_SET1(m0[k]);
+            sum00 = SSE2_ADD(sum00, SSE2_MUL(w, x0));
+            sum01 = SSE2_ADD(sum01, SSE2_MUL(w, x1));
+            w = SSE2_SET1(m1[k]);
+            sum10 = SSE2_ADD(sum10, SSE2_MUL(w, x0));
+            sum11 = SSE2_ADD(sum11, SSE2_MUL(w, x1));
+            w = SSE2_SET1(m2[k]);
+            sum20 = SSE2_ADD(sum20, SSE2_MUL(w, x0));
+            sum21 = SSE2_ADD(sum21, SSE2_MUL(w, x1));
+            w = SSE2_SET1(m3[k]);
+            sum30 = SSE2_ADD(sum30, SSE2_MUL(w, x0));
+            sum31 = SSE2_ADD(sum31, SSE2_MUL(w, x1));
+         }
+
+         SSE2_STORE(y, sum00);
+         SSE2_STORE(y + SSE2_LANES, sum01);
+         SSE2_STORE(y + output_stride, sum10);
+         SSE2_STORE(y + output_stride + SSE2_LANES, sum11);
+         SSE2_STORE(y + 2 * output_stride, sum20);
+         SSE2_STORE(y + 2 * output_stride + SSE2_LANES, sum21);
+         SSE2_STORE(y + 3 * output_stride, sum30);
+         SSE2_STORE(y + 3 * output_stride + SSE2_LANES, sum31);
+      }
+
+      for (; i < num_rows; ++i)
+      {
+         const ann_real* m = matrix + i * matrix_stride;
+         SSE2_VEC sum0 = SSE2_ZERO(), sum1 = SSE2_ZERO();
+
+         for (size_t k = 0; k < size; ++k)
+         {
+            const ann_real* x = input + k * input_stride + c;
+            const SSE2_VEC w = SSE2_SET1(m[k]);
+            sum0 = SSE2_ADD(sum0, SSE2_MUL(w, SSE2_LOAD(x)));
+            sum1 = SSE2_ADD(sum1, SSE2_MUL(w, SSE2_LOAD(x + SSE2_LANES)));
+         }
+
+         SSE2_STORE(output + i * output_stride + c, sum0);
+         SSE2_STORE(output + i * output_stride + c + SSE2_LANES, sum1);
+      }
+   }
+
+   scalar_matrix_product(output + c, output_stride, matrix, matrix_stride, input + c, 
+                         input_stride, num_rows, size, num_columns - c);
+   return;
+}
+
+SIMD_TARGET("sse2")
+static void sse2_relu(ann_real* data,
+                      const size_t size)
+{
+   const SSE2_VEC zero = SSE2_ZERO();
+   size_t i = 0;
+
+   for (; i + SSE2_LANES <= size; i += SSE2_LANES)
+   {
+      SSE2_STORE(data + i, SSE2_MAX(SSE2_LOAD(data + i), zero));
+   }
+   scalar_relu(data + i, size - i);
+   return;
+}
+
+SIMD_TARGET("sse2")
+static void sse2_delta_relu(ann_real* error,
+                            const ann_real* output,
+                            const size_t size)
+{
+   const SSE2_VEC zero = SSE2_ZERO();
+   size_t i = 0;
+
+   for (; i + SSE2_LANES <= size; i += SSE2_LANES)
+   {
+      const SSE2_VEC mask = SSE2_CMPGT(SSE2_LOAD(output + i), zero);
+      SSE2_STORE(error + i, SSE2_AND(SSE2_LOAD(error + i), mask));
+   }
+   scalar_delta_relu(error + i, output + i, size - i);
+   return;
+}
+
+SIMD_TARGET("sse2")
+static int32_t sse2_dot_u8s8(const uint8_t* a,
+                             const int8_t* b,
+                             const size_t size)
+{
+   const __m128i zero = _mm_setzero_si128();
+   __m128i sum = _mm_setzero_si128();
+   size_t i = 0;
+
+   for (; i + 16 <= size; i += 16)
+   {
+      const __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+      const __m128i w = _mm_loadu_si128((const __m128i*)(b + i));
+      const __m128i x_low = _mm_unpacklo_epi8(x, zero);
+      const __m128i x_high = _mm_unpackhi_epi8(x, zero);
+      const __m128i w_low = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8);
+      const __m128i w_high = _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8);
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(x_low, w_low));
+      sum = _mm_add_epi32(sum, _mm_madd_epi16(x_high, w_high));
+   }
+
+   sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+   sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+   return _mm_cvtsi128_si32(sum) + scalar_dot_u8s8(a + i, b + i, size - i);
+}
+
+SIMD_TARGET("sse2")
+static inline SSE2_VEC sse2_load_bf16(const uint16_t* a)
+{
+#ifdef ANN_SINGLE_PRECISION
+   const __m128i x = _mm_loadl_epi64((const __m128i*)a);
+   return _mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), x));
+#else
+   const __m128i x = _mm_cvtsi32_si128((int)((uint32_t)a[0] | (uint32_t)a[1] << 16));
+   return _mm_cvtps_pd(_mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), x)));
+#endif
+}
+
+SIMD_TARGET("sse2")
+static ann_real sse2_dot_bf16(const uint16_t* a,
+                              const ann_real* b,
+                              const size_t size)
+{
+   SSE2_VEC sum0 = SSE2_ZERO(), sum1 = SSE2_ZERO();
+   size_t i = 0;
+
+   for (; i + 2 * SSE2_LANES <= size; i += 2 * SSE2_LANES)
+   {
+      sum0 = SSE2_ADD(sum0, SSE2_MUL(sse2_load_bf16(a + i), SSE2_LOAD(b + i)));
+      sum1 = SSE2_ADD(sum1, SSE2_MUL(sse2_load_bf16(a + i + SSE2_LANES), 
+                                     SSE2_LOAD(b + i + SSE2_LANES)));
+   }
+   return sse2_sum(SSE2_ADD(sum0, sum1)) + scalar_dot_bf16(a + i, b + i, size - i);
+}
+
+/**************************************************************************************************
+* AVX2: Krnor fr 256-bitars vektorer med FMA-instruktioner.
+**************************************************************************************************/
+SIMD_TARGET("avx2,fma")
+static inline ann_real avx2_sum(const AVX2_VEC x)
+{
+#ifdef ANN_SINGLE_PRECISION
+   __m128 sum = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+   sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+   return _mm_cvtss_f32(_mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1)));
+#else
+   const __m128d sum = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+   return _mm_cvtsd_f64(_mm_add_sd(sum, _mm_unpackhi_pd(sum, sum)));
+#endif
+}
+
+SIMD_TARGET("avx2,fma")
+static ann_real avx2_dot(const ann_real* a,
+                         const ann_real* b,
+                         const size_t size)
+{
+   AVX2_VEC sum0 = AVX2_ZERO(), sum1 = AVX2_ZERO(), sum2 = AVX2_ZERO(), sum3 = AVX2_ZERO();
+   size_t i = 0;
+
+   for (; i + 4 * AVX2_LANES <= size; i += 4 * AVX2_LANES)
+   {
+      sum0 = AVX2_FMADD(AVX2_LOAD(a + i), AVX2_LOAD(b + i), sum0);
+      sum1 = AVX2_FMADD(AVX2_LOAD(a + i + AVX2_LANES), AVX2_LOAD(b + i + AVX2_LANES), sum1);
+      sum2 = AVX2_FMADD(AVX2_LOAD(a + i + 2 * AVX2_LANES), 
+                        AVX2_LOAD(b + i + 2 * AVX2_LANES), sum2);
+      sum3 = AVX2_FMADD(AVX2_LOAD(a + i + 3 * AVX2_LANES), 
+                        AVX2_LOAD(b + i + 3 * AVX2_LANES), sum3);
+   }
+   for (; i + AVX2_LANES <= size; i += AVX2_LANES)
+   {
+      sum0 = AVX2_FMADD(AVX2_LOAD(a + i), AVX2_LOAD(b + i), sum0);
+   }
+
+   ann_real sum = avx2_sum(AVX2_ADD(AVX2_ADD(sum0, sum1), AVX2_ADD(sum2, sum3)));
+   for (; i < size; ++i)
+   {
+      sum += a[i] * b[i];
+   }
+   return sum;
+}
+
+SIMD_TARGET("avx2,fma")
+static void avx2_dot_4(const ann_real* weights,
+                       const ann_real* input,
+                       const size_t input_stride,
+                       const size_t size,
+                       ann_real* sums)
+{
+   const ann_real* x0 = input;
+   const ann_real* x1 = x0 + input_stride;
+   const ann_real* x2 = x1 + input_stride;
+   const ann_real* x3 = x2 + input_stride;
+   AVX2_VEC sum0 = AVX2_ZERO(), sum1 = AVX2_ZERO(), sum2 = AVX2_ZERO(), sum3 = AVX2_ZERO();
+   size_t i = 0;
+
+   for (; i + AVX2_LANES <= size; i += AVX2_LANES)
+   {
+      const AVX2_VEC w = AVX2_LOAD(weights + i);
+      sum0 = AVX2_FMADD(AVX2_LOAD(x0 + i), w, sum0);
+      sum1 = AVX2_FMADD(AVX2_LOAD(x1 + i), w, sum1);
+      sum2 = AVX2_FMADD(AVX2_LOAD(x2 + i), w, sum2);
+      sum3 = AVX2_FMADD(AVX2_LOAD(x3 + i), w, sum3);
+   }
+
+   sums[0] = avx2_sum(sum0);
+   sums[1] = avx2_sum(sum1);
+   sums[2] = avx2_sum(sum2);
+   sums[3] = avx2_sum(sum3);
+
+   for (; i < size; ++i)
+   {
+      sums[0] += x0[i] * weights[i];
+      sums[1] += x1[i] * weights[i];
+      sums[2] += x2[i] * weights[i];
+      sums[3] += x3[i] * weights[i];
+   }
+   return;
+}
+
+SIMD_TARGET("avx2,fma")
+static void avx2_axpy(ann_real* y,
+                      const ann_real a,
+                      const ann_real* x,
+                      const size_t size)
+{
+   const AVX2_VEC va = AVX2_SET1(a);
+   size_t i = 0;
+
+   for (; i + 2 * AVX2_LANES <= size; i += 2 * AVX2_LANES)
+   {
+      AVX2_STORE(y + i, AVX2_FMADD(va, AVX2_LOAD(x + i), AVX2_LOAD(y + i)));
+      AVX2_STORE(y + i + AVX2_LANES, AVX2_FMADD(va, AVX2_LOAD(x + i + AVX2_LANES), 
+                                                AVX2_LOAD(y + i + AVX2_LANES)));
+   }
+   for (; i + AVX2_LANES <= size; i += AVX2_LANES)
+   {
+      AVX2_STORE(y + i, AVX2_FMADD(va, AVX2_LOAD(x + i), AVX2_LOAD(y + i)));
+   }
+   for (; i < size; ++i)
+   {
+      y[i] += a * x[i];
+   }
+   return;
+}
+
+SIMD_TARGET("avx2,fma")
+static void avx2_axpy_update(ann_real* y,
+                             const ann_real e,
+                             ann_real* w,
+                             const ann_real a,
+                             const ann_real* x,
+                             const size_t size)
+{
+   const AVX2_VEC ve = AVX2_SET1(e);
+   const AVX2_VEC va = AVX2_SET1(a);
+   size_t i = 0;
+
+   for (; i + AVX2_LANES <= size; i += AVX2_LANES)
+   {
+      const AVX2_VEC vw = AVX2_LOAD(w + i);
+      AVX2_STORE(y + i, AVX2_FMADD(ve, vw, AVX2_LOAD(y + i)));
+      AVX2_STORE(w + i, AVX2_FMADD(va, AVX2_LOAD(x + i), vw));
+   }
+   for (; i < size; ++i)
+   {
+      y[i] += e * w[i];
+      w[i] += a * x[i];
+   }
+   return;
+}
+
+SIMD_TARGET("avx2,fma")
+static void avx2_transpose_product(ann_real* output,
+                                   const ann_real* matrix,
+                                   const size_t stride,
+                                   const ann_real* vector,
+                                   const size_t num_rows,
+                                   const size_t num_columns)
+{
+   size_t j = 0;
+
+   for (size_t i = 0; i < num_columns; ++i)
+   {
+      output[i] = 0;
+   }
+
+   for (; j + 4 <= num_rows; j += 4)
+   {
+      const ann_real* r0 = matrix + j * stride;
+      const ann_real* r1 = r0 + stride;
+      const ann_real* r2 = r1 + stride;
+      const ann_real* r3 = r2 + stride;
+      const AVX2_VEC v0 = AVX2_SET1(vector[j]), v1 = AVX2_SET1(vector[j + 1]);
+      const AVX2_VEC v2 = AVX2_SET1(vector[j + 2]), v3 = AVX2_SET1(vector[j + 3]);
+      size_t i = 0;
+
+      for (; i + AVX2_LANES <= num_columns; i += AVX2_LANES)
+      {
+         AVX2_VEC sum = AVX2_FMADD(v0, AVX2_LOAD(r0 + i), AVX2_LOAD(output + i));
+         sum = AVX2_FMADD(v1, AVX2_LOAD(r1 + i), sum);
+         sum = AVX2_FMADD(v2, AVX2_LOAD(r2 + i), sum);
+         sum = AVX2_FMADD(v3, AVX2_LOAD(r3 + i), sum);
+         AVX2_STORE(output + i, sum);
+      }
+      for (; i < num_columns; ++i)
+      {
+         output[i] = output[i] + vector[j] * r0[i] + vector[j + 1] * r1[i] + 
+            vector[j + 2] * r2[i] + vector[j + 3] * r3[i];
+      }
+   }
+
+   for (; j < num_rows; ++j)
+   {
+      avx2_axpy(output, vector[j], matrix + j * stride, num_columns);
+   }
+   return;
+}
+
+SIMD_TARGET("avx2,fma")
+static void avx2_matrix_product(ann_real* output,
+                                const size_t output_stride,
+                                const ann_real* matrix,
+                                const size_t matrix_stride,
+                                const ann_real* input,
+                                const size_t input_stride,
+                                const size_t num_rows,
+                                const size_t size,
+                                const size_t num_columns)
+{
+   size_t c = 0;
+
+   for (; c + 2 * AVX2_LANES <= num_columns; c += 2 * AVX2_LANES)
+   {
+      size_t i = 0;
+
+      for (; i + 4 <= num_rows; i += 4)
+      {
+         const ann_real* m0 = matrix + i * matrix_stride;
+         const ann_real* m1 = m0 + matrix_stride;
+         const ann_real* m2 = m1 + matrix_stride;
+         const ann_real* m3 = m2 + matrix_stride;
+         ann_real* y = output + i * output_stride + c;
+         AVX2_VEC sum00 = AVX2_ZERO(), sum01 = AVX2_ZERO();
+         AVX2_VEC sum10 = AVX2_ZERO(), sum11 = AVX2_ZERO();
+         AVX2_VEC sum20 = AVX2_ZERO(), sum21 = AVX2_ZERO();
+         AVX2_VEC sum30 = AVX2_ZERO(), sum31 = AVX2_ZERO();
+
+         for (size_t k = 0; k < size; ++k)
+         {
+            const ann_real* x = input + k * input_stride + c;
+            const AVX2_VEC x0 = AVX2_LOAD(x);
+            const AVX2_VEC x1 = AVX2_LOAD(x + AVX2_LANES);
+            AVX2_VEC w = AVX2_SET1(m0[k]);
+            sum00 = AVX2_FMADD(w, x0, sum00);
+            sum01 = AVX2_FMADD(w, x1, sum01);
+            w = AVX2_SET1(m1[k]);
+            sum10 = AVX2_FMADD(w, x0, sum10);
+            sum11 = AVX2_FMADD(w, x1, sum11);
+            w = AVX2_SET1(m2[k]);
+            sum20 = AVX2_FMADD(w, x0, sum20);
+            sum21 = AVX2_FMADD(w, x1, sum21);
+            w = AVX2_SET1(m3[k]);
+            sum30 = AVX2_FMADD(w, x0, sum30);
+            sum31 = AVX2_FMADD(w, x1, sum31);
+         }
+
+         AVX2_STORE(y, sum00);
+         AVX2_STORE(y + AVX2_LANES, sum01);
+         AVX2_STORE(y + output_stride, sum10);
+         AVX2_STORE(y + output_stride + AVX2_LANES, sum11);
+         AVX2_STORE(y + 2 * output_stride, sum20);
+         AVX2_STORE(y + 2 * output_stride + AVX2_LANES, sum21);
+         AVX2_STORE(y + 3 * output_stride, sum30);
+         AVX2_STORE(y + 3 * output_stride + AVX2_LANES, sum31);
+      }
+
+      for (; i < num_rows; ++i)
+      {
+         const ann_real* m = matrix + i * matrix_stride;
+         AVX2_VEC sum0 = AVX2_ZERO(), sum1 = AVX2_ZERO();
+
+         for (size_t k = 0; k < size; ++k)
+         {
+            const ann_real* x = input + k * input_stride + c;
+            const AVX2_VEC w = AVX2_SET1(m[k]);
+            sum0 = AVX2_FMADD(w, AVX2_LOAD(x), sum0);
+            sum1 = AVX2_FMADD(w, AVX2_LOAD(x + AVX2_LANES), sum1);
+         }
+
+         AVX2_STORE(output + i * output_stride + c, sum0);
+         AVX2_STORE(output + i * output_stride + c + AVX2_LANES, sum1);
+      }
+   }
+
+   scalar_matrix_product(output + c, output_stride, matrix, matrix_stride, input + c, 
+                         input_stride, num_rows, size, num_columns - c);
+   return;
+}
+
+SIMD_TARGET("avx2,fma")
+static void avx2_relu(ann_real* data,
+                      const size_t size)
+{
+   const AVX2_VEC zero = AVX2_ZERO();
+   size_t i = 0;
+
+   for (; i + AVX2_LANES <= size; i += AVX2_LANES)
+   {
+      AVX2_STORE(data + i, AVX2_MAX(AVX2_LOAD(data + i), zero));
+   }
+   scalar_relu(data + i, size - i);
+   return;
+}
+
+SIMD_TARGET("avx2,fma")
+static void avx2_delta_relu(ann_real* error,
+                            const ann_real* output,
+                            const size_t size)
+{
+   const AVX2_VEC zero = AVX2_ZERO();
+   size_t i = 0;
+
+   for (; i + AVX2_LANES <= size; i += AVX2_LANES)
+   {
+      const AVX2_VEC mask = AVX2_CMPGT(AVX2_LOAD(output + i), zero);
+      AVX2_STORE(error + i, AVX2_AND(AVX2_LOAD(error + i), mask));
+   }
+   scalar_delta_relu(error + i, output + i, size - i);
+   return;
+}
+
+SIMD_TARGET("avx2,fma")
+static int32_t avx2_dot_u8s8(const uint8_t* a,
+                             const int8_t* b,
+                             const size_t size)
+{
+   const __m256i ones = _mm256_set1_epi16(1);
+   __m256i sum0 = _mm256_setzero_si256(), sum1 = _mm256_setzero_si256();
+   size_t i = 0;
+
+   for (; i + 64 <= size; i += 64)
+   {
+      const __m256i x0 = _mm256_loadu_si256((const __m256i*)(a + i));
+      const __m256i x1 = _mm256_loadu_si256((const __m256i*)(a + i + 32));
+      const __m256i w0 = _mm256_loadu_si256((const __m256i*)(b + i));
+      const __m256i w1 = _mm256_loadu_si256((const __m256i*)(b + i + 32));
+      sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_maddubs_epi16(x0, w0), ones));
+      sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(_mm256_maddubs_epi16(x1, w1), ones));
+   }
+   for (; i + 32 <= size; i += 32)
+   {
+      const __m256i x = _mm256_loadu_si256((const __m256i*)(a + i));
+      const __m256i w = _mm256_loadu_si256((const __m256i*)(b + i));
+      sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+   }
+
+   const __m256i sum256 = _mm256_add_epi32(sum0, sum1);
+   __m128i sum = _mm_add_epi32(_mm256_castsi256_si128(sum256), 
+                               _mm256_extracti128_si256(sum256, 1));
+   sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+   sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+   return _mm_cvtsi128_si32(sum) + scalar_dot_u8s8(a + i, b + i, size - i);
+}
+
+/**************************************************************************************************
+* avx2_*_fp16: Krnor fr skalrprodukten mellan vikter i halv precision och ann_real, dr
+*              vikterna breddas vid laddning via F16C-instruktionen vcvtph2ps. Anvnds enbart
+*              ifall processorn stdjer F16C, annars anvnds den skalra krnan.
+**************************************************************************************************/
+SIMD_TARGET("avx2,fma,f16c")
+static inline AVX2_VEC avx2_load_fp16(const uint16_t* a)
+{
+#ifdef ANN_SINGLE_PRECISION
+   return _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)a));
+#else
+   return _mm256_cvtps_pd(_mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)a)));
+#endif
+}
+
+SIMD_TARGET("avx2,fma")
+static inline AVX2_VEC avx2_load_bf16(const uint16_t* a)
+{
+#ifdef ANN_SINGLE_PRECISION
+   const __m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)a));
+   return _mm256_castsi256_ps(_mm256_slli_epi32(x, 16));
+#else
+   const __m128i x = _mm_loadl_epi64((const __m128i*)a);
+   return _mm256_cvtps_pd(_mm_castsi128_ps(_mm_unpacklo_epi16(_mm_setzero_si128(), x)));
+#endif
+}
+
+SIMD_TARGET("avx2,fma,f16c")
+static ann_real avx2_dot_fp16(const uint16_t* a,
+                              const ann_real* b,
+                              const size_t size)
+{
+   AVX2_VEC sum0 = AVX2_ZERO(), sum1 = AVX2_ZERO();
+   size_t i = 0;
+
+   for (; i + 2 * AVX2_LANES <= size; i += 2 * AVX2_LANES)
+   {
+      sum0 = AVX2_FMADD(avx2_load_fp16(a + i), AVX2_LOAD(b + i), sum0);
+      sum1 = AVX2_FMADD(avx2_load_fp16(a + i + AVX2_LANES), AVX2_LOAD(b + i + AVX2_LANES), sum1);
+   }
+   for (; i + AVX2_LANES <= size; i += AVX2_LANES)
+   {
+      sum0 = AVX2_FMADD(avx2_load_fp16(a + i), AVX2_LOAD(b + i), sum0);
+   }
+   return avx2_sum(AVX2_ADD(sum0, sum1)) + scalar_dot_fp16(a + i, b + i, size - i);
+}
+
+SIMD_TARGET("avx2,fma")
+static ann_real avx2_dot_bf16(const uint16_t* a,
+                              const ann_real* b,
+                              const size_t size)
+{
+   AVX2_VEC sum0 = AVX2_ZERO(), sum1 = AVX2_ZERO();
+   size_t i = 0;
+
+   for (; i + 2 * AVX2_LANES <= size; i += 2 * AVX2_LANES)
+   {
+      sum0 = AVX2_FMADD(avx2_load_bf16(a + i), AVX2_LOAD(b + i), sum0);
+      sum1 = AVX2_FMADD(avx2_load_bf16(a + i + AVX2_LANES), AVX2_LOAD(b + i + AVX2_LANES), sum1);
+   }
+   for (; i + AVX2_LANES <= size; i += AVX2_LANES)
+   {
+      sum0 = AVX2_FMADD(avx2_load_bf16(a + i), AVX2_LOAD(b + i), sum0);
+   }
+   return avx2_sum(AVX2_ADD(sum0, sum1)) + scalar_dot_bf16(a + i, b + i, size - i);
+}
+
+/**************************************************************************************************
+* avx2_*_ps / avx2_encode_*: Krnor fr konvertering till flyttal p 16 bitar, tta vrden t
+*                            gngen. Vid dubbel precision avrundas vrdena frst till enkel
+*                            precision. Konvertering till bf16 avrundas till nrmaste vrde via
+*                            heltalsaritmetik, dr NaN bevaras som tyst NaN.
+**************************************************************************************************/
+SIMD_TARGET("avx2,fma")
+static inline __m256 avx2_load_ps(const ann_real* input)
+{
+#ifdef ANN_SINGLE_PRECISION
+   return _mm256_loadu_ps(input);
+#else
+   return _mm256_set_m128(_mm256_cvtpd_ps(_mm256_loadu_pd(input + 4)), 
+                          _mm256_cvtpd_ps(_mm256_loadu_pd(input)));
+#endif
+}
+
+SIMD_TARGET("avx2,fma")
+static inline __m128i avx2_bf16_from_ps(const __m256 x)
+{
+   const __m256i bits = _mm256_castps_si256(x);
+   const __m256i odd = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+   const __m256i rounded = _mm256_srli_epi32(
+      _mm256_add_epi32(_mm256_add_epi32(bits, _mm256_set1_epi32(0x7fff)), odd), 16);
+   const __m256i quiet = _mm256_or_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x40));
+   const __m256i nan = _mm256_cmpgt_epi32(_mm256_and_si256(bits, _mm256_set1_epi32(0x7fffffff)),
+                                          _mm256_set1_epi32(0x7f800000));
+   const __m256i result = _mm256_blendv_epi8(rounded, quiet, nan);
+   return _mm_packus_epi32(_mm256_castsi256_si128(result), _mm256_extracti128_si256(result, 1));
+}
+
+SIMD_TARGET("avx2,fma,f16c")
+static void avx2_encode_fp16(uint16_t* output,
+                             const ann_real* input,
+                             const size_t size)
+{
+   size_t i = 0;
+
+   for (; i + 8 <= size; i += 8)
+   {
+      const __m128i x = _mm256_cvtps_ph(avx2_load_ps(input + i), _MM_FROUND_TO_NEAREST_INT);
+      _mm_storeu_si128((__m128i*)(output + i), x);
+   }
+   scalar_encode_fp16(output + i, input + i, size - i);
+   return;
+}
+
+SIMD_TARGET("avx2,fma")
+static void avx2_encode_bf16(uint16_t* output,
+                             const ann_real* input,
+                             const size_t size)
+{
+   size_t i = 0;
+
+   for (; i + 8 <= size; i += 8)
+   {
+      _mm_storeu_si128((__m128i*)(output + i), avx2_bf16_from_ps(avx2_load_ps(input + i)));
+   }
+   scalar_encode_bf16(output + i, input + i, size - i);
+   return;
+}
+
+/**************************************************************************************************
+* AVX-512: Krnor fr 512-bitars vektorer. Resterande element i slutet av varje flt hanteras
+*          via maskerade laddningar och lagringar.
+**************************************************************************************************/
+SIMD_TARGET("avx512f")
+static inline AVX512_MASK avx512_mask(const size_t remaining)
+{
+   return remaining < AVX512_LANES ? (AVX512_MASK)((1u << remaining) - 1) : (AVX512_MASK)~0u;
+}
+
+SIMD_TARGET("avx512f")
+static ann_real avx512_dot(const ann_real* a,
+                           const ann_real* b,
+                           const size_t size)
+{
+   AVX512_VEC sum0 = AVX512_ZERO(), sum1 = AVX512_ZERO();
+   AVX512_VEC sum2 = AVX512_ZERO(), sum3 = AVX512_ZERO();
+   size_t i = 0;
+
+   for (; i + 4 * AVX512_LANES <= size; i += 4 * AVX512_LANES)
+   {
+      sum0 = AVX512_FMADD(AVX512_LOAD(a + i), AVX512_LOAD(b + i), sum0);
+      sum1 = AVX512_FMADD(AVX512_LOAD(a + i + AVX512_LANES), 
+                          AVX512_LOAD(b + i + AVX512_LANES), sum1);
+      sum2 = AVX512_FMADD(AVX512_LOAD(a + i + 2 * AVX512_LANES), 
+                          AVX512_LOAD(b + i + 2 * AVX512_LANES), sum2);
+      sum3 = AVX512_FMADD(AVX512_LOAD(a + i + 3 * AVX512_LANES), 
+                          AVX512_LOAD(b + i + 3 * AVX512_LANES), sum3);
+   }
+   for (; i + AVX512_LANES <= size; i += AVX512_LANES)
+   {
+      sum0 = AVX512_FMADD(AVX512_LOAD(a + i), AVX512_LOAD(b + i), sum0);
+   }
+   if (i < size)
+   {
+      const AVX512_MASK mask = avx512_mask(size - i);
+      sum1 = AVX512_FMADD(AVX512_MASKZ_LOAD(mask, a + i), AVX512_MASKZ_LOAD(mask, b + i), sum1);
+   }
+
+   return AVX512_SUM(AVX512_ADD(AVX512_ADD(sum0, sum1), AVX512_ADD(sum2, sum3)));
+}
+
+SIMD_TARGET("avx512f")
+static void avx512_dot_4(const ann_real* weights,
+                         const ann_real* input,
+                         const size_t input_stride,
+                         const size_t size,
+                         ann_real* sums)
+{
+   const ann_real* x0 = input;
+   const ann_real* x1 = x0 + input_stride;
+   const ann_real* x2 = x1 + input_stride;
+   const ann_real* x3 = x2 + input_stride;
+   AVX512_VEC sum0 = AVX512_ZERO(), sum1 = AVX512_ZERO();
+   AVX512_VEC sum2 = AVX512_ZERO(), sum3 = AVX512_ZERO();
+
+   for (size_t i = 0; i < size; i += AVX512_LANES)
+   {
+      const AVX512_MASK mask = avx512_mask(size - i);
+      const AVX512_VEC w = AVX512_MASKZ_LOAD(mask, weights + i);
+      sum0 = AVX512_FMADD(AVX512_MASKZ_LOAD(mask, x0 + i), w, sum0);
+      sum1 = AVX512_FMADD(AVX512_MASKZ_LOAD(mask, x1 + i), w, sum1);
+      sum2 = AVX512_FMADD(AVX512_MASKZ_LOAD(mask, x2 + i), w, sum2);
+      sum3 = AVX512_FMADD(AVX512_MASKZ_LOAD(mask, x3 + i), w, sum3);
+   }
+
+   sums[0] = AVX512_SUM(sum0);
+   sums[1] = AVX512_SUM(sum1);
+   sums[2] = AVX512_SUM(sum2);
+   sums[3] = AVX512_SUM(sum3);
+   return;
+}
+
+SIMD_TARGET("avx512f")
+static void avx512_axpy(ann_real* y,
+                        const ann_real a,
+                        const ann_real* x,
+                        const size_t size)
+{
+   const AVX512_VEC va = AVX512_SET1(a);
+   size_t i = 0;
+
+   for (; i + AVX512_LANES <= size; i += AVX512_LANES)
+   {
+      AVX512_STORE(y + i, AVX512_FMADD(va, AVX512_LOAD(x + i), AVX512_LOAD(y + i)));
+   }
+   if (i < size)
+   {
+      const AVX512_MASK mask = avx512_mask(size - i);
+      AVX512_MASK_STORE(y + i, mask, AVX512_FMADD(va, AVX512_MASKZ_LOAD(mask, x + i),
+                                                  AVX512_MASKZ_LOAD(mask, y + i)));
+   }
+   return;
+}
+
+SIMD_TARGET("avx512f")
+static void avx512_axpy_update(ann_real* y,
+                               const ann_real e,
+                               ann_real* w,
+                               const ann_real a,
+                               const ann_real* x,
+                               const size_t size)
+{
+   const AVX512_VEC ve = AVX512_SET1(e);
+   const AVX512_VEC va = AVX512_SET1(a);
+   size_t i = 0;
+
+   for (; i + AVX512_LANES <= size; i += AVX512_LANES)
+   {
+      const AVX512_VEC vw = AVX512_LOAD(w + i);
+      AVX512_STORE(y + i, AVX512_FMADD(ve, vw, AVX512_LOAD(y + i)));
+      AVX512_STORE(w + i, AVX512_FMADD(va, AVX512_LOAD(x + i), vw));
+   }
+   if (i < size)
+   {
+      const AVX512_MASK mask = avx512_mask(size - i);
+      const AVX512_VEC vw = AVX512_MASKZ_LOAD(mask, w + i);
+      AVX512_MASK_STORE(y + i, mask, AVX512_FMADD(ve, vw, AVX512_MASKZ_LOAD(mask, y + i)));
+      AVX512_MASK_STORE(w + i, mask, AVX512_FMADD(va, AVX512_MASKZ_LOAD(mask, x + i), vw));
+   }
+   return;
+}
+
+SIMD_TARGET("avx512f")
+static void avx512_transpose_product(ann_real* output,
+                                     const ann_real* matrix,
+                                     const size_t stride,
+                                     const ann_real* vector,
+                                     const size_t num_rows,
+                                     const size_t num_columns)
+{
+   size_t j = 0;
+
+   for (size_t i = 0; i < num_columns; ++i)
+   {
+      output[i] = 0;
+   }
+
+   for (; j + 4 <= num_rows; j += 4)
+   {
+      const ann_real* r0 = matrix + j * stride;
+      const ann_real* r1 = r0 + stride;
+      const ann_real* r2 = r1 + stride;
+      const ann_real* r3 = r2 + stride;
+      const AVX512_VEC v0 = AVX512_SET1(vector[j]), v1 = AVX512_SET1(vector[j + 1]);
+      const AVX512_VEC v2 = AVX512_SET1(vector[j + 2]), v3 = AVX512_SET1(vector[j + 3]);
+      size_t i = 0;
+
+      for (; i + AVX512_LANES <= num_columns; i += AVX512_LANES)
+      {
+         AVX512_VEC sum = AVX512_FMADD(v0, AVX512_LOAD(r0 + i), AVX512_LOAD(output + i));
+         sum = AVX512_FMADD(v1, AVX512_LOAD(r1 + i), sum);
+         sum = AVX512_FMADD(v2, AVX512_LOAD(r2 + i), sum);
+         sum = AVX512_FMADD(v3, AVX512_LOAD(r3 + i), sum);
+         AVX512_STORE(output + i, sum);
+      }
+      if (i < num_columns)
+      {
+         const AVX512_MASK mask = avx512_mask(num_columns - i);
+         AVX512_VEC sum = AVX512_FMADD(v0, AVX512_MASKZ_LOAD(mask, r0 + i), 
+                                       AVX512_MASKZ_LOAD(mask, output + i));
+         sum = AVX512_FMADD(v1, AVX512_MASKZ_LOAD(mask, r1 + i), sum);
+         sum = AVX512_FMADD(v2, AVX512_MASKZ_LOAD(mask, r2 + i), sum);
+         sum = AVX512_FMADD(v3, AVX512_MASKZ_LOAD(mask, r3 + i), sum);
+         AVX512_MASK_STORE(output + i, mask, sum);
+      }
+   }
+
+   for (; j < num_rows; ++j)
+   {
+      avx512_axpy(output, vector[j], matrix + j * stride, num_columns);
+   }
+   return;
+}
+
+SIMD_TARGET("avx512f")
+static void avx512_matrix_product(ann_real* output,
+                                  const size_t output_stride,
+                                  const ann_real* matrix,
+                                  const size_t matrix_stride,
+                                  const ann_real* input,
+                                  const size_t input_stride,
+                                  const size_t num_rows,
+                                  const size_t size,
+                                  const size_t num_columns)
+{
+   for (size_t c = 0; c < num_columns; c += 2 * AVX512_LANES)
+   {
+      const size_t remaining = num_columns - c;
+      const AVX512_MASK mask0 = avx512_mask(remaining);
+      const AVX512_MASK mask1 = remaining > AVX512_LANES ? 
+         avx512_mask(remaining - AVX512_LANES) : 0;
+      size_t i = 0;
+
+      for (; i + 4 <= num_rows; i += 4)
+      {
+         const ann_real* m0 = matrix + i * matrix_stride;
+         const ann_real* m1 = m0 + matrix_stride;
+         const ann_real* m2 = m1 + matrix_stride;
+         const ann_real* m3 = m2 + matrix_stride;
+         ann_real* y = output + i * output_stride + c;
+         AVX512_VEC sum00 = AVX512_ZERO(), sum01 = AVX512_ZERO();
+         AVX512_VEC sum10 = AVX512_ZERO(), sum11 = AVX512_ZERO();
+         AVX512_VEC sum20 = AVX512_ZERO(), sum21 = AVX512_ZERO();
+         AVX512_VEC sum30 = AVX512_ZERO(), sum31 = AVX512_ZERO();
+
+         for (size_t k = 0; k < size; ++k)
+         {
+            const ann_real* x = input + k * input_stride + c;
+            const AVX512_VEC x0 = AVX512_MASKZ_LOAD(mask0, x);
+            const AVX512_VEC x1 = AVX512_MASKZ_LOAD(mask1, x + AVX512_LANES);
+            AVX512_VEC w = AVX512_SET1(m0[k]);
+            sum00 = AVX512_FMADD(w, x0, sum00);
+            sum01 = AVX512_FMADD(w, x1, sum01);
+            w = AVX512_SET1(m1[k]);
+            sum10 = AVX512_FMADD(w, x0, sum10);
+            sum11 = AVX512_FMADD(w, x1, sum11);
+            w = AVX512_SET1(m2[k]);
+            sum20 = AVX512_FMADD(w, x0, sum20);
+            sum21 = AVX512_FMADD(w, x1, sum21);
+            w = AVX512_SET1(m3[k]);
+            sum30 = AVX512_FMADD(w, x0, sum30);
+            sum31 = AVX512_FMADD(w, x1, sum31);
+         }
+
+         AVX512_MASK_STORE(y, mask0, sum00);
+         AVX512_MASK_STORE(y + AVX512_LANES, mask1, sum01);
+         AVX512_MASK_STORE(y + output_stride, mask0, sum10);
+         AVX512_MASK_STORE(y + output_stride + AVX512_LANES, mask1, sum11);
+         AVX512_MASK_STORE(y + 2 * output_stride, mask0, sum20);
+         AVX512_MASK_STORE(y + 2 * output_stride + AVX512_LANES, mask1, sum21);
+         AVX512_MASK_STORE(y + 3 * output_stride, mask0, sum30);
+         AVX512_MASK_STORE(y + 3 * output_stride + AVX512_LANES, mask1, sum31);
+      }
+
+      for (; i < num_rows; ++i)
+      {
+         const ann_real* m = matrix + i * matrix_stride;
+         ann_real* y = output + i * output_stride + c;
+         AVX512_VEC sum0 = AVX512_ZERO(), sum1 = AVX512_ZERO();
+
+         for (size_t k = 0; k < size; ++k)
+         {
+            const ann_real* x = input + k * input_stride + c;
+            const AVX512_VEC w = AVX512_SET1(m[k]);
+            sum0 = AVX512_FMADD(w, AVX512_MASKZ_LOAD(mask0, x), sum0);
+            sum1 = AVX512_FMADD(w, AVX512_MASKZ_LOAD(mask1, x + AVX512_LANES), sum1);
+         }
+
+         AVX512_MASK_STORE(y, mask0, sum0);
+         AVX512_MASK_STORE(y + AVX512_LANES, mask1, sum1);
+      }
+   }
+   return;
+}
+
+SIMD_TARGET("avx512f")
+static void avx512_relu(ann_real* data,
+                        const size_t size)
+{
+   const AVX512_VEC zero = AVX512_ZERO();
+
+   for (size_t i = 0; i < size; i += AVX512_LANES)
+   {
+      const AVX512_MASK mask = avx512_mask(size - i);
+      AVX512_MASK_STORE(data + i, mask, AVX512_MAX(AVX512_MASKZ_LOAD(mask, data + i), zero));
+   }
+   return;
+}
+
+SIMD_TARGET("avx512f")
+static void avx512_delta_relu(ann_real* error,
+                              const ann_real* output,
+                              const size_t size)
+{
+   const AVX512_VEC zero = AVX512_ZERO();
+
+   for (size_t i = 0; i < size; i += AVX512_LANES)
+   {
+      const AVX512_MASK mask = avx512_mask(size - i);
+      const AVX512_MASK active = AVX512_MASK_CMPGT(mask, AVX512_MASKZ_LOAD(mask, output + i), 
+                                                   zero);
+      AVX512_MASK_STORE(error + i, mask, AVX512_MASKZ_LOAD(active, error + i));
+   }
+   return;
+}
+
+/**************************************************************************************************
+* avx512_dot_u8s8: Krna fr skalrprodukten mellan 8-bitars heltal via VNNI-instruktionen
+*                  vpdpbusd, som multiplicerar 64 par och ackumulerar direkt i 32 bitar. Anvnds
+*                  enbart ifall processorn stdjer AVX-512 VNNI, annars anvnds AVX2-krnan.
+**************************************************************************************************/
+SIMD_TARGET("avx512f,avx512bw,avx512vnni")
+static int32_t avx512_dot_u8s8(const uint8_t* a,
+                               const int8_t* b,
+                               const size_t size)
+{
+   __m512i sum0 = _mm512_setzero_si512(), sum1 = _mm512_setzero_si512();
+   size_t i = 0;
+
+   for (; i + 128 <= size; i += 128)
+   {
+      sum0 = _mm512_dpbusd_epi32(sum0, _mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+      sum1 = _mm512_dpbusd_epi32(sum1, _mm512_loadu_si512(a + i + 64), 
+                                 _mm512_loadu_si512(b + i + 64));
+   }
+   for (; i < size; i += 64)
+   {
+      const __mmask64 mask = size - i < 64 ? ((__mmask64)1 << (size - i)) - 1 : ~(__mmask64)0;
+      sum0 = _mm512_dpbusd_epi32(sum0, _mm512_maskz_loadu_epi8(mask, a + i), 
+                                 _mm512_maskz_loadu_epi8(mask, b + i));
+   }
+   return _mm512_reduce_add_epi32(_mm512_add_epi32(sum0, sum1));
+}
+
+SIMD_TARGET("avx512f,f16c")
+static inline AVX512_VEC avx512_load_fp16(const uint16_t* a)
+{
+#ifdef ANN_SINGLE_PRECISION
+   return _mm512_cvtph_ps(_mm256_loadu_si256((const __m256i*)a));
+#else
+   return _mm512_cvtps_pd(_mm256_cvtph_ps(_mm_loadu_si128((const __m128i*)a)));
+#endif
+}
+
+SIMD_TARGET("avx512f")
+static inline AVX512_VEC avx512_load_bf16(const uint16_t* a)
+{
+#ifdef ANN_SINGLE_PRECISION
+   const __m512i x = _mm512_cvtepu16_epi32(_mm256_loadu_si256((const __m256i*)a));
+   return _mm512_castsi512_ps(_mm512_slli_epi32(x, 16));
+#else
+   const __m256i x = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)a));
+   return _mm512_cvtps_pd(_mm256_castsi256_ps(_mm256_slli_epi32(x, 16)));
+#endif
+}
+
+SIMD_TARGET("avx512f,f16c")
+static ann_real avx512_dot_fp16(const uint16_t* a,
+                                const ann_real* b,
+                                const size_t size)
+{
+   AVX512_VEC sum0 = AVX512_ZERO(), sum1 = AVX512_ZERO();
+   size_t i = 0;
+
+   for (; i + 2 * AVX512_LANES <= size; i += 2 * AVX512_LANES)
+   {
+      sum0 = AVX512_FMADD(avx512_load_fp16(a + i), AVX512_LOAD(b + i), sum0);
+      sum1 = AVX512_FMADD(avx512_load_fp16(a + i + AVX512_LANES), 
+                          AVX512_LOAD(b + i + AVX512_LANES), sum1);
+   }
+   for (; i + AVX512_LANES <= size; i += AVX512_LANES)
+   {
+      sum0 = AVX512_FMADD(avx512_load_fp16(a + i), AVX512_LOAD(b + i), sum0);
+   }
+   return AVX512_SUM(AVX512_ADD(sum0, sum1)) + scalar_dot_fp16(a + i, b + i, size - i);
+}
+
+SIMD_TARGET("avx512f")
+static ann_real avx512_dot_bf16(const uint16_t* a,
+                                const ann_real* b,
+                                const size_t size)
+{
+   AVX512_VEC sum0 = AVX512_ZERO(), sum1 = AVX512_ZERO();
+   size_t i = 0;
+
+   for (; i + 2 * AVX512_LANES <= size; i += 2 * AVX512_LANES)
+   {
+      sum0 = AVX512_FMADD(avx512_load_bf16(a + i), AVX512_LOAD(b + i), sum0);
+      sum1 = AVX512_FMADD(avx512_load_bf16(a + i + AVX512_LANES), 
+                          AVX512_LOAD(b + i + AVX512_LANES), sum1);
+   }
+   for (; i + AVX512_LANES <= size; i += AVX512_LANES)
+   {
+      sum0 = AVX512_FMADD(avx512_load_bf16(a + i), AVX512_LOAD(b + i), sum0);
+   }
+   return AVX512_SUM(AVX512_ADD(sum0, sum1)) + scalar_dot_bf16(a + i, b + i, size - i);
+}
+
+/**************************************************************************************************
+* cpuid: Lser processorinformation fr angivet lv och dellv via instruktionen cpuid.
+*        Registren eax, ebx, ecx och edx lagras i angivet flt i denna ordning.
+**************************************************************************************************/
+static void cpuid(unsigned int* registers,
+                  const unsigned int leaf,
+                  const unsigned int subleaf)
+{
+#if defined(_MSC_VER)
+   __cpuidex((int*)registers, (int)leaf, (int)subleaf);
+#else
+   __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+   return;
+}
+
+/**************************************************************************************************
+* xgetbv: Returnerar innehllet i register XCR0, som anger vilka vektorregister operativsystemet
+*         sparar vid kontextbyten. Fr endast anropas ifall processorn stdjer OSXSAVE.
+**************************************************************************************************/
+static uint64_t xgetbv(void)
+{
+#if defined(_MSC_VER)
+   return (uint64_t)_xgetbv(0);
+#else
+   uint32_t eax, edx;
+   __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+   return ((uint64_t)edx << 32) | eax;
+#endif
+}
+
+/**************************************************************************************************
+* simd_detect_vnni: Indikerar ifall processorn stdjer AVX-512 BW samt VNNI, som krvs av
+*                   krnan avx512_dot_u8s8. Anropas enbart d AVX-512 redan har detekterats,
+*                   vilket innebr att operativsystemet sparar motsvarande register.
+**************************************************************************************************/
+static bool simd_detect_vnni(void)
+{
+   unsigned int registers[4] = { 0 };
+   cpuid(registers, 7, 0);
+   return (registers[1] & (1u << 30)) && (registers[2] & (1u << 11));
+}
+
+/**************************************************************************************************
+* simd_detect_f16c: Indikerar ifall processorn stdjer F16C, som krvs av krnorna fr vikter i
+*                   halv precision (fp16). Anropas enbart d AVX2 eller AVX-512 redan har
+*                   detekterats.
+**************************************************************************************************/
+static bool simd_detect_f16c(void)
+{
+   unsigned int registers[4] = { 0 };
+   cpuid(registers, 1, 0);
+   return registers[2] & (1u << 29);
+}
+
+#endif /* SIMD_X86 */
+
+/**************************************************************************************************
+* simd_detect: Returnerar den bredaste instruktionsuppsttning som bde processorn och
+*              operativsystemet stdjer. Std fr AVX2 och AVX-512 krver ven att
+*              operativsystemet sparar motsvarande register, vilket kontrolleras via XCR0.
+**************************************************************************************************/
+enum simd_level simd_detect(void)
+{
+   enum simd_level level = SIMD_LEVEL_SCALAR;
+#ifdef SIMD_X86
+   unsigned int registers[4] = { 0 };
+   cpuid(registers, 0, 0);
+   const unsigned int max_leaf = registers[0];
+   if (max_leaf < 1) return level;
+
+   cpuid(registers, 1, 0);
+   const bool sse2 = registers[3] & (1u << 26);
+   const bool fma = registers[2] & (1u << 12);
+   const bool osxsave = registers[2] & (1u << 27);
+   const bool avx = registers[2] & (1u << 28);
+   if (sse2) level = SIMD_LEVEL_SSE2;
+   if (!osxsave || !avx || max_leaf < 7) return level;
+
+   const uint64_t xcr0 = xgetbv();
+   cpuid(registers, 7, 0);
+   const bool avx2 = registers[1] & (1u << 5);
+   const bool avx512f = registers[1] & (1u << 16);
+
+   if (avx2 && fma && (xcr0 & 0x06) == 0x06) level = SIMD_LEVEL_AVX2;
+   if (avx512f && (xcr0 & 0xe6) == 0xe6) level = SIMD_LEVEL_AVX512;
+#endif
+   return level;
+}
+
+/**************************************************************************************************
+* simd_init: Vljer berkningskrnor fr den bredaste instruktionsuppsttning som stds av
+*            aktuell processor. Valet genomfrs exakt en gng via call_once, ven vid samtidiga
+*            anrop frn flera trdar. Funktionen anropas av lagrens konstruktorer, s att
+*            krnorna r valda innan ngot ntverk kan starta trdar som anropar dem. Vid direkt
+*            anvndning av krnorna, utan ngot lager, br funktionen anropas vid programstart.
+**************************************************************************************************/
+void simd_init(void)
+{
+   call_once(&init_flag, &simd_init_once);
+   return;
+}
+
+/**************************************************************************************************
+* simd_get_level: Returnerar den instruktionsuppsttning som berkningskrnorna anvnder.
+**************************************************************************************************/
+enum simd_level simd_get_level(void)
+{
+   simd_init();
+   return current_level;
+}
+
+/**************************************************************************************************
+* simd_set_level: Vljer berkningskrnor fr angiven instruktionsuppsttning, exempelvis fr
+*                 att jmfra prestanda eller resultat mellan olika implementeringar. Ifall
+*                 angiven instruktionsuppsttning inte stds av processorn vljs den bredaste
+*                 som stds. Funktionspekarna skrivs om, varfr funktionen inte fr anropas
+*                 medan andra trdar anvnder krnorna. Returnerar vald instruktionsuppsttning.
+*
+*                 - level: nskad instruktionsuppsttning.
+**************************************************************************************************/
+enum simd_level simd_set_level(const enum simd_level level)
+{
+   const enum simd_level supported = simd_detect();
+   simd_init();
+   simd_apply_level(level < supported ? level : supported);
+   return current_level;
+}
+
+/**************************************************************************************************
+* simd_level_name: Returnerar namnet p angiven instruktionsuppsttning som en textstrng.
+*
+*                  - level: Aktuell instruktionsuppsttning.
+**************************************************************************************************/
+const char* simd_level_name(const enum simd_level level)
+{
+   switch (level)
+   {
+      case SIMD_LEVEL_SSE2:   return "SSE2";
+      case SIMD_LEVEL_AVX2:   return "AVX2";
+      case SIMD_LEVEL_AVX512: return "AVX-512";
+      default:                return "scalar";
+   }
+}
+
+/**************************************************************************************************
+* simd_init_once: Vljer berkningskrnor fr den bredaste instruktionsuppsttning som stds av
+*                 aktuell processor. Anropas endast via call_once i simd_init.
+**************************************************************************************************/
+static void simd_init_once(void)
+{
+   simd_apply_level(simd_detect());
+   return;
+}
+
+/**************************************************************************************************
+* simd_apply_level: Stter samman berkningskrnorna fr angiven instruktionsuppsttning i en
+*                   lokal tabell, varefter varje funktionspekare tilldelas exakt en gng.
+*
+*                   - level: Instruktionsuppsttning som stds av processorn.
+**************************************************************************************************/
+static void simd_apply_level(const enum simd_level level)
+{
+   struct simd_kernels kernels = scalar_kernels;
+
+#ifdef SIMD_X86
+   if (level == SIMD_LEVEL_SSE2)
+   {
+      kernels.dot = &sse2_dot;
+      kernels.dot_4 = &sse2_dot_4;
+      kernels.axpy = &sse2_axpy;
+      kernels.axpy_update = &sse2_axpy_update;
+      kernels.transpose_product = &sse2_transpose_product;
+      kernels.matrix_product = &sse2_matrix_product;
+      kernels.relu = &sse2_relu;
+      kernels.delta_relu = &sse2_delta_relu;
+      kernels.dot_u8s8 = &sse2_dot_u8s8;
+      kernels.dot_bf16 = &sse2_dot_bf16;
+   }
+   else if (level == SIMD_LEVEL_AVX2)
+   {
+      kernels.dot = &avx2_dot;
+      kernels.dot_4 = &avx2_dot_4;
+      kernels.axpy = &avx2_axpy;
+      kernels.axpy_update = &avx2_axpy_update;
+      kernels.transpose_product = &avx2_transpose_product;
+      kernels.matrix_product = &avx2_matrix_product;
+      kernels.relu = &avx2_relu;
+      kernels.delta_relu = &avx2_delta_relu;
+      kernels.dot_u8s8 = &avx2_dot_u8s8;
+      if (simd_detect_f16c()) kernels.dot_fp16 = &avx2_dot_fp16;
+      kernels.dot_bf16 = &avx2_dot_bf16;
+      if (simd_detect_f16c()) kernels.encode_fp16 = &avx2_encode_fp16;
+      kernels.encode_bf16 = &avx2_encode_bf16;
+   }
+   else if (level == SIMD_LEVEL_AVX512)
+   {
+      kernels.dot = &avx512_dot;
+      kernels.dot_4 = &avx512_dot_4;
+      kernels.axpy = &avx512_axpy;
+      kernels.axpy_update = &avx512_axpy_update;
+      kernels.transpose_product = &avx512_transpose_product;
+      kernels.matrix_product = &avx512_matrix_product;
+      kernels.relu = &avx512_relu;
+      kernels.delta_relu = &avx512_delta_relu;
+      kernels.dot_u8s8 = simd_detect_vnni() ? &avx512_dot_u8s8 : &avx2_dot_u8s8;
+      if (simd_detect_f16c()) kernels.dot_fp16 = &avx512_dot_fp16;
+      kernels.dot_bf16 = &avx512_dot_bf16;
+      if (simd_detect_f16c()) kernels.encode_fp16 = &avx2_encode_fp16;
+      kernels.encode_bf16 = &avx2_encode_bf16;
+   }
+#endif
+
+   simd_dot = kernels.dot;
+   simd_dot_4 = kernels.dot_4;
+   simd_axpy = kernels.axpy;
+   simd_axpy_update = kernels.axpy_update;
+   simd_transpose_product = kernels.transpose_product;
+   simd_matrix_product = kernels.matrix_product;
+   simd_relu = kernels.relu;
+   simd_delta_relu = kernels.delta_relu;
+   simd_dot_u8s8 = kernels.dot_u8s8;
+   simd_dot_fp16 = kernels.dot_fp16;
+   simd_dot_bf16 = kernels.dot_bf16;
+   simd_encode_fp16 = kernels.encode_fp16;
+   simd_encode_bf16 = kernels.encode_bf16;
+   current_level = level;
+   return;
+}
@@ -0,0 +1,95 @@
+/**************************************************************************************************
+* simd.h: Innehller vektoriserade berkningskrnor fr dense-lagrens inre loopar. Varje krna
+*         finns i en skalr version samt i versioner fr SSE2, AVX2 (med FMA) och AVX-512.
+*         Vilken version som anvnds vljs en gng under krning via cpuid, dr den bredaste
+*         instruktionsuppsttning som processorn och operativsystemet stdjer anvnds. Krnorna
+*         anropas via funktionspekare, som pekar p de skalra krnorna tills simd_init har
+*         anropats. Valet grs exakt en gng och sker nr det frsta lagret skapas. Samtliga
+*         flyttalskrnor arbetar med flyttalstypen ann_real, allts med enkel eller dubbel
+*         precision beroende p hur programmet har kompilerats. Drtill finns en heltalskrna
+*         fr 8-bitars skalrprodukter, som anvnds vid kvantiserad inferens, samt krnor fr
+*         skalrprodukter med vikter lagrade som flyttal p 16 bitar (fp16 eller bf16), vilka
+*         breddas till ann_real vid laddning, samt motsvarande konvertering till 16 bitar.
+**************************************************************************************************/
+#ifndef SIMD_H_
+#define SIMD_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include <threads.h>
+
+/**************************************************************************************************
+* simd_level: Instruktionsuppsttningar som berkningskrnorna finns implementerade fr, ordnade
+*             frn smalast till bredast.
+**************************************************************************************************/
+enum simd_level
+{
+   SIMD_LEVEL_SCALAR, /* Skalr implementering, anvnds som reserv p samtliga plattformar. */
+   SIMD_LEVEL_SSE2,   /* 128-bitars vektorer. */
+   SIMD_LEVEL_AVX2,   /* 256-bitars vektorer med FMA. */
+   SIMD_LEVEL_AVX512  /* 512-bitars vektorer (AVX-512F). */
+};
+
+/* Externa funktioner: */
+void simd_init(void);
+enum simd_level simd_detect(void);
+enum simd_level simd_get_level(void);
+enum simd_level simd_set_level(const enum simd_level level);
+const char* simd_level_name(const enum simd_level level);
+
+/* Funktionspekare: */
+extern ann_real (*simd_dot)(const ann_real* a,
+                            const ann_real* b,
+                            const size_t size);
+extern void (*simd_dot_4)(const ann_real* weights,
+                          const ann_real* input,
+                          const size_t input_stride,
+                          const size_t size,
+                          ann_real* sums);
+extern void (*simd_axpy)(ann_real* y,
+                         const ann_real a,
+                         const ann_real* x,
+                         const size_t size);
+extern void (*simd_axpy_update)(ann_real* y,
+                                const ann_real e,
+                                ann_real* w,
+                                const ann_real a,
+                                const ann_real* x,
+                                const size_t size);
+extern void (*simd_transpose_product)(ann_real* output,
+                                      const ann_real* matrix,
+                                      const size_t stride,
+                                      const ann_real* vector,
+                                      const size_t num_rows,
+                                      const size_t num_columns);
+extern void (*simd_matrix_product)(ann_real* output,
+                                   const size_t output_stride,
+                                   const ann_real* matrix,
+                                   const size_t matrix_stride,
+                                   const ann_real* input,
+                                   const size_t input_stride,
+                                   const size_t num_rows,
+                                   const size_t size,
+                                   const size_t num_columns);
+extern void (*simd_relu)(ann_real* data,
+                         const size_t size);
+extern void (*simd_delta_relu)(ann_real* error,
+                               const ann_real* output,
+                               const size_t size);
+extern int32_t (*simd_dot_u8s8)(const uint8_t* a,
+                                const int8_t* b,
+                                const size_t size);
+extern ann_real (*simd_dot_fp16)(const uint16_t* a,
+                                 const ann_real* b,
+                                 const size_t size);
+extern ann_real (*simd_dot_bf16)(const uint16_t* a,
+                                 const ann_real* b,
+                                 const size_t size);
+extern void (*simd_encode_fp16)(uint16_t* output,
+                                const ann_real* input,
+                                const size_t size);
+extern void (*simd_encode_bf16)(uint16_t* output,
+                                const ann_real* input,
+                                const size_t size);
+
+#endif /* SIMD_H_ */
@@ -0,0 +1,141 @@
+/**************************************************************************************************
+* sparse_vector.c: Innehller funktionsdefinitioner som anvnds fr implementering av glesa
+*                  vektorer innehllande flyttal.
+**************************************************************************************************/
+#include "sparse_vector.h"
+
+/**************************************************************************************************
+* sparse_vector_new: Initierar angiven gles vektor.
+*
+*                    - self: Pekare till vektorn.
+**************************************************************************************************/
+void sparse_vector_new(struct sparse_vector* self)
+{
+   self->indices = 0;
+   self->values = 0;
+   self->size = 0;
+   self->capacity = 0;
+   return;
+}
+
+/**************************************************************************************************
+* sparse_vector_delete: Tmmer innehllet i angiven gles vektor.
+*
+*                       - self: Pekare till vektorn.
+**************************************************************************************************/
+void sparse_vector_delete(struct sparse_vector* self)
+{
+   free(self->indices);
+   free(self->values);
+   self->indices = 0;
+   self->values = 0;
+   self->size = 0;
+   self->capacity = 0;
+   return;
+}
+
+/**************************************************************************************************
+* sparse_vector_ptr_new: Returnerar en pekare till en ny heapallokerad tom gles vektor.
+**************************************************************************************************/
+struct sparse_vector* sparse_vector_ptr_new(void)
+{
+   struct sparse_vector* self = (struct sparse_vector*)malloc(sizeof(struct sparse_vector));
+   if (!self) return 0;
+   sparse_vector_new(self);
+   return self;
+}
+
+/**************************************************************************************************
+* sparse_vector_ptr_delete: Frigr minne fr angiven heapallokerad gles vektor och stter
+*                           vektorpekaren till null.
+*
+*                           - self: Adressen till vektorpekaren.
+**************************************************************************************************/
+void sparse_vector_ptr_delete(struct sparse_vector** self)
+{
+   sparse_vector_delete(*self);
+   free(*self);
+   *self = 0;
+   return;
+}
+
+/**************************************************************************************************
+* sparse_vector_push: Lgger till ett element med angivet index och vrde i angiven gles vektor.
+*                     Ifall kapaciteten inte rcker frdubblas den. Vid misslyckad
+*                     minnesallokering returneras 1, annars 0.
+*
+*                     - self : Pekare till vektorn.
+*                     - index: Elementets index.
+*                     - value: Elementets vrde.
+**************************************************************************************************/
+int sparse_vector_push(struct sparse_vector* self,
+                       const uint32_t index,
+                       const double value)
+{
+   if (self->size == self->capacity &&
+       sparse_vector_reserve(self, self->capacity ? 2 * self->capacity : 4))
+   {
+      return 1;
+   }
+
+   self->indices[self->size] = index;
+   self->values[self->size++] = value;
+   return 0;
+}
+
+/**************************************************************************************************
+* sparse_vector_reserve: Reserverar minne fr minst angivet antal element i angiven gles vektor.
+*                        Vid misslyckad minnesallokering returneras 1 och befintliga element
+*                        lmnas orrda, annars 0.
+*
+*                        - self        : Pekare till vektorn.
+*                        - new_capacity: Antalet element som minne skall reserveras fr.
+**************************************************************************************************/
+int sparse_vector_reserve(struct sparse_vector* self,
+                          const size_t new_capacity)
+{
+   uint32_t* indices = 0;
+   double* values = 0;
+   if (new_capacity <= self->capacity) return 0;
+
+   indices = (uint32_t*)realloc(self->indices, sizeof(uint32_t) * new_capacity);
+   if (!indices) return 1;
+   self->indices = indices;
+
+   values = (double*)realloc(self->values, sizeof(double) * new_capacity);
+   if (!values) return 1;
+   self->values = values;
+   self->capacity = new_capacity;
+   return 0;
+}
+
+/**************************************************************************************************
+* sparse_vector_print: Skriver ut index och vrde fr samtliga element i angiven gles vektor via
+*                      angiven utstrm, dr standardutenheten stdout anvnds som default fr
+*                      utskrift i terminalen.
+*
+*                      - self   : Pekare till vektorn.
+*                      - ostream: Pekare till angiven utstrm.
+**************************************************************************************************/
+void sparse_vector_print(const struct sparse_vector* self,
+                         FILE* ostream)
+{
+   if (!self->size) return;
+   if (!ostream) ostream = stdout;
+   fprintf(ostream, "--------------------------------------------------------------------------\n");
+
+   for (size_t i = 0; i < self->size; ++i)
+   {
+      fprintf(ostream, "%u: %g\n", (unsigned int)self->indices[i], self->values[i]);
+   }
+
+   fprintf(ostream, "--------------------------------------------------------------------------\n\n");
+   return;
+}
+
+/**************************************************************************************************
+* sparse_vector_clear: Tmmer innehllet i angiven gles vektor.
+*
+*                      - self: Pekare till vektorn.
+**************************************************************************************************/
+void (*sparse_vector_clear)(struct sparse_vector* self) = &sparse_vector_delete;
@@ -0,0 +1,43 @@
+/**************************************************************************************************
+* sparse_vector.h: Implementering av glesa vektorer fr lagring av flyttal via strukten
+*                  sparse_vector samt motsvarande externa funktioner. Enbart element skilda frn
+*                  noll lagras, i form av elementets index samt vrde, vilket lmpar sig fr
+*                  breda insignaler dr nstan samtliga element r noll.
+**************************************************************************************************/
+#ifndef SPARSE_VECTOR_H_
+#define SPARSE_VECTOR_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include <string.h>
+
+/**************************************************************************************************
+* sparse_vector: Gles vektor innehllande tv dynamiska flt av samma storlek, ett fr index och
+*                ett fr motsvarande vrden. Elementen behver inte lagras i ngon viss ordning.
+*                Ifall samma index frekommer flera gnger summeras vrdena.
+**************************************************************************************************/
+struct sparse_vector
+{
+   uint32_t* indices; /* Pekare till flt innehllande elementens index. */
+   double* values;    /* Pekare till flt innehllande elementens vrden. */
+   size_t size;       /* Antalet lagrade element. */
+   size_t capacity;   /* Antalet element som flten rymmer. */
+};
+
+/* Externa funktioner: */
+void sparse_vector_new(struct sparse_vector* self);
+void sparse_vector_delete(struct sparse_vector* self);
+struct sparse_vector* sparse_vector_ptr_new(void);
+void sparse_vector_ptr_delete(struct sparse_vector** self);
+int sparse_vector_push(struct sparse_vector* self,
+                       const uint32_t index,
+                       const double value);
+int sparse_vector_reserve(struct sparse_vector* self,
+                          const size_t new_capacity);
+void sparse_vector_print(const struct sparse_vector* self,
+                         FILE* ostream);
+
+/* Funktionspekare: */
+extern void (*sparse_vector_clear)(struct sparse_vector* self);
+
+#endif /* SPARSE_VECTOR_H_ */
@@ -2,12 +2,116 @@
 * training_data.c: Innehller funktionsdefinitioner som anvnds fr inlsning samt lagring av
 *                  trningsdata fr neurala ntverk.
 **************************************************************************************************/
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L /* Krvs fr fseeko, ftello och off_t vid kompilering med c11. */
+#endif
+
 #include "training_data.h"
+#include "training_data_file.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TRAINING_DATA_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define TRAINING_DATA_PREFETCH(address) ((void)(address))
+#endif
+
+/**************************************************************************************************
+* text_rows: Radbuffert fr rader som tolkas ur en textfil innan de flyttas till en
+*            trningsdatabehllare.
+**************************************************************************************************/
+struct text_rows
+{
+   ann_real* in;    /* Radernas indata, lagrad radvis. */
+   ann_real* out;   /* Radernas utdata, lagrad radvis. */
+   size_t size;     /* Antalet rader. */
+   size_t capacity; /* Antalet rader som det finns allokerat minne fr. */
+};
+
+/**************************************************************************************************
+* text_chunk: Del av en textfil som tolkas av en egen trd vid flertrdad inlsning via
+*             funktionen training_data_load_text_threaded. Delen omfattar samtliga rader vars
+*             frsta tecken ligger i intervallet [begin, end).
+**************************************************************************************************/
+struct text_chunk
+{
+   const char* filepath;   /* Filskvg till textfilen. */
+   uint64_t begin;         /* Position i filen dr delen brjar, rknat i byte. */
+   uint64_t end;           /* Position direkt efter delen, rknat i byte. */
+   size_t num_inputs;      /* Antalet insignaler per rad. */
+   size_t num_outputs;     /* Antalet utsignaler per rad. */
+   struct text_rows rows;  /* Radbuffert fr delens tolkade rader. */
+   size_t num_skipped;     /* Antalet verhoppade rader i delen. */
+   int error;              /* Indikerar ifall lsning eller minnesallokering misslyckades. */
+   thrd_t thread;          /* Trden som delen tolkas i. */
+   bool started;           /* Indikerar ifall en separat trd har startats. */
+};
 
 /* Statiska funktioner: */
-static void training_data_extract(struct training_data* self, const char* s);
+static int reserve_order(struct training_data* self,
+                         const size_t capacity);
+static void fill_order(struct training_data* self,
+                       const size_t begin,
+                       const size_t end);
+static void swap_order(struct training_data* self,
+                       const size_t i,
+                       const size_t j);
+static ann_real* reserve_matrix(ann_real* matrix,
+                                const bool owned,
+                                const size_t num_rows,
+                                const size_t capacity,
+                                const size_t num_columns);
+static void scatter_row(ann_real* destination,
+                        const size_t size,
+                        const uint32_t* indices,
+                        const double* values,
+                        const size_t num_values);
+static int start_sparse(struct training_data* self);
+static int reserve_values(struct training_data* self,
+                          const size_t capacity);
+static void prefetch_row(const void* row,
+                         const size_t size);
+static void copy_row(ann_real* destination,
+                     const double* source,
+                     const size_t size,
+                     const size_t source_size);
+static int text_rows_reserve(struct text_rows* self,
+                             const size_t capacity,
+                             const size_t num_inputs,
+                             const size_t num_outputs);
+static void text_rows_delete(struct text_rows* self);
+static int text_chunk_run(void* arg);
+static int parse_text(struct text_rows* rows,
+                      FILE* fstream,
+                      const uint64_t begin,
+                      const uint64_t end,
+                      const size_t num_inputs,
+                      const size_t num_outputs,
+                      size_t* num_skipped);
+static int training_data_append_rows(struct training_data* self,
+                                     struct text_rows* rows);
+static size_t estimate_rows(const char* begin,
+                            const char* end,
+                            const size_t file_size);
+static int parse_line(struct text_rows* rows,
+                      const char* begin,
+                      const char* end,
+                      const size_t num_inputs,
+                      const size_t num_outputs,
+                      size_t* num_skipped);
+static const char* parse_number(const char* s,
+                                const char* end,
+                                double* value);
+static int get_file_size(FILE* fstream,
+                         uint64_t* size);
+static int seek_file(FILE* fstream,
+                     const uint64_t position);
 static bool is_digit(const char c);
-static void print_line(const double* data, const size_t size, FILE* ostream);
+static bool is_delimiter(const char c);
+static void print_line(const ann_real* data, const size_t size, FILE* ostream);
+static void print_sparse_line(const uint32_t* indices,
+                              const double* values,
+                              const size_t size,
+                              FILE* ostream);
 
 /**************************************************************************************************
 * training_data_new: Initierar angiven trningsdatabehllare fr lagring av trningsdata till
@@ -21,12 +125,21 @@ void training_data_new(struct training_data* self,
                        const size_t num_inputs, 
                        const size_t num_outputs)
 {
-   double_2d_vector_new(&self->in);
-   double_2d_vector_new(&self->out);
-   uint_vector_new(&self->order);
+   self->in = 0;
+   self->offsets = 0;
+   self->indices = 0;
+   self->values = 0;
+   self->num_values = 0;
+   self->value_capacity = 0;
+   self->out = 0;
+   self->order = 0;
+   self->wide_order = 0;
+   mapped_file_new(&self->file);
    self->sets = 0;
+   self->capacity = 0;
    self->num_inputs = num_inputs;
    self->num_outputs = num_outputs;
+   random_generator_new(&self->generator, random_generator_next(random_generator_local()));
    return;
 }
 
@@ -37,10 +150,7 @@ void training_data_new(struct training_data* self,
 **************************************************************************************************/
 void training_data_delete(struct training_data* self)
 {
-   double_2d_vector_delete(&self->in);
-   double_2d_vector_delete(&self->out);
-   uint_vector_delete(&self->order);
-   self->sets = 0;
+   training_data_clear(self);
    self->num_inputs = 0;
    self->num_outputs = 0;
    return;
@@ -79,50 +189,235 @@ void training_data_ptr_delete(struct training_data** self)
 /**************************************************************************************************
 * training_data_clear: Nollstller aktuell trningsdata infr inlsning av ny trningsdata.
 *                      Drmed bibehlls information om antalet noder i ingngslagret samt
-*                      utgngslagret p tillhrande neuralt ntverk.
+*                      utgngslagret p tillhrande neuralt ntverk. Ifall trningsdatan har
+*                      mappats frn en binr fil tas ven mappningen bort.
 * 
 *                      - self: Pekare till trningsdatabehllaren.
 **************************************************************************************************/
 void training_data_clear(struct training_data* self)
 {
-   double_2d_vector_delete(&self->in);
-   double_2d_vector_delete(&self->out);
-   uint_vector_delete(&self->order);
+   if (!self->file.data)
+   {
+      free(self->in);
+      free(self->out);
+   }
+
+   free(self->offsets);
+   free(self->indices);
+   free(self->values);
+   free(self->order);
+   free(self->wide_order);
+   mapped_file_close(&self->file);
+   self->in = 0;
+   self->offsets = 0;
+   self->indices = 0;
+   self->values = 0;
+   self->num_values = 0;
+   self->value_capacity = 0;
+   self->out = 0;
+   self->order = 0;
+   self->wide_order = 0;
    self->sets = 0;
+   self->capacity = 0;
    return;
 }
 
 /**************************************************************************************************
 * training_data_load: Lser in trningsdata till ett neuralt ntverk frn en fil via angiven 
-*                     filskvg och lagrar i angiven trningsdatabehllare.
+*                     filskvg och lagrar i angiven trningsdatabehllare. Ifall behllaren r
+*                     tom och det bredvid textfilen finns en binr kopia (textfilens skvg fljd
+*                     av ".bin") som r nyare n textfilen och har samma antal in- och utsignaler
+*                     minnesmappas kopian i stllet fr att texten tolkas. Annars tolkas texten
+*                     och en ny binr kopia sparas, vilket ignoreras tyst ifall det misslyckas,
+*                     exempelvis p grund av skrivskyddad katalog.
 * 
 *                     - self    : Pekare till trningsdatabehllaren.
 *                     - filepath: Filskvg som trningsdatan skall lsas frn.
 **************************************************************************************************/
 void training_data_load(struct training_data* self, const char* filepath)
 {
-   FILE* fstream = fopen(filepath, "r");
+   char* sidecar_path = self->sets ? 0 : training_data_sidecar_path(filepath);
+
+   if (sidecar_path && training_data_file_is_newer(sidecar_path, filepath) &&
+       !training_data_map(self, sidecar_path))
+   {
+      free(sidecar_path);
+      return;
+   }
+
+   if (!training_data_load_text(self, filepath) && sidecar_path && self->sets)
+   {
+      training_data_save(self, sidecar_path);
+   }
+
+   free(sidecar_path);
+   return;
+}
+
+/**************************************************************************************************
+* training_data_load_text: Tolkar trningsdata frn angiven textfil och lgger till den i
+*                          angiven trningsdatabehllare utan att anvnda eller uppdatera ngon
+*                          binr kopia. Filen lses in i stora block, dr varje fullstndig rad
+*                          tolkas direkt i blocket. Tal separeras med blanksteg, tabbar,
+*                          kommatecken eller semikolon, vilket medfr att bde blankstegs- och
+*                          CSV-filer kan lsas in. Tomma rader ignoreras, medan rader med fel
+*                          antal tal eller ogiltiga tal hoppas ver och rknas i en varning.
+*                          Ifall filen inte kan ppnas eller minnet tar slut returneras 1,
+*                          annars 0.
+* 
+*                          - self    : Pekare till trningsdatabehllaren.
+*                          - filepath: Filskvg som trningsdatan skall lsas frn.
+**************************************************************************************************/
+int training_data_load_text(struct training_data* self, const char* filepath)
+{
+   return training_data_load_text_threaded(self, filepath, 1);
+}
+
+/**************************************************************************************************
+* training_data_load_text_threaded: Tolkar trningsdata frn angiven textfil p samma stt som
+*                                   training_data_load_text, men frdelat p angivet antal
+*                                   trdar. Filen delas upp i lika stora delar, dr varje rad
+*                                   tillhr den del som radens frsta tecken ligger i, s att
+*                                   delarna i praktiken brjar och slutar vid radbrytningar.
+*                                   Varje trd lser sin del via en egen filstrm och tolkar
+*                                   raderna till en egen radbuffert. Buffertarna flyttas sedan
+*                                   till trningsdatabehllaren i samma ordning som i filen, s
+*                                   att resultatet r identiskt med en enkeltrdad inlsning.
+*                                   Varje del omfattar minst ett block, s sm filer tolkas av
+*                                   frre trdar. Den anropande trden tolkar sjlv den frsta
+*                                   delen, och delar vars trd inte kan startas tolkas ocks av
+*                                   den anropande trden. Ifall filen inte kan ppnas, antalet
+*                                   trdar r noll eller minnet tar slut returneras 1, annars 0.
+* 
+*                                   - self       : Pekare till trningsdatabehllaren.
+*                                   - filepath   : Filskvg som trningsdatan skall lsas frn.
+*                                   - num_threads: Maximalt antal trdar som anvnds.
+**************************************************************************************************/
+int training_data_load_text_threaded(struct training_data* self,
+                                     const char* filepath,
+                                     const size_t num_threads)
+{
+   FILE* fstream = fopen(filepath, "rb");
+   struct text_chunk* chunks = 0;
+   uint64_t file_size = 0;
+   size_t num_chunks = 0, num_skipped = 0;
+   int error = 0;
 
    if (!fstream)
    {
       fprintf(stderr, "Could not open file at path %s!\n\n", filepath);
+      return 1;
    }
-   else
+
+   error = !num_threads || get_file_size(fstream, &file_size);
+   fclose(fstream);
+   if (error) return 1;
+
+   num_chunks = (size_t)(file_size / TRAINING_DATA_BLOCK_SIZE) + 1;
+   if (num_chunks > num_threads) num_chunks = num_threads;
+   chunks = (struct text_chunk*)calloc(num_chunks, sizeof(struct text_chunk));
+   if (!chunks) return 1;
+
+   for (size_t i = 0; i < num_chunks; ++i)
+   {
+      chunks[i].filepath = filepath;
+      chunks[i].begin = file_size * i / num_chunks;
+      chunks[i].end = file_size * (i + 1) / num_chunks;
+      chunks[i].num_inputs = self->num_inputs;
+      chunks[i].num_outputs = self->num_outputs;
+      chunks[i].started = i > 0 && 
+         thrd_create(&chunks[i].thread, text_chunk_run, &chunks[i]) == thrd_success;
+   }
+
+   for (size_t i = 0; i < num_chunks; ++i)
    {
-      char s[100] = { '\0 ' };
-      while (fgets(s, sizeof(s), fstream))
+      if (chunks[i].started)
       {
-         training_data_extract(self, s);
+         thrd_join(chunks[i].thread, 0);
       }
-      fclose(fstream);
+      else
+      {
+         text_chunk_run(&chunks[i]);
+      }
+      if (chunks[i].error) error = 1;
+      num_skipped += chunks[i].num_skipped;
+   }
+
+   for (size_t i = 0; i < num_chunks && !error; ++i)
+   {
+      error = training_data_append_rows(self, &chunks[i].rows);
+   }
+
+   if (num_skipped)
+   {
+      fprintf(stderr, "Could not extract %zu datapoints out of %zu lines!\n\n", 
+              self->num_inputs + self->num_outputs, num_skipped);
+   }
+
+   for (size_t i = 0; i < num_chunks; ++i)
+   {
+      text_rows_delete(&chunks[i].rows);
    }
-   return;
 
+   free(chunks);
+   return error;
 }
 
 /**************************************************************************************************
-* training_data_set: Lgger till trningsdata till neuralt ntverk via data lagrat i var sin
-*                    tvdimensionella vektor och lagrar i angiven trningsdatabehllare.
+* training_data_load_text_range: Tolkar de rader i angiven textfil vars frsta tecken ligger i
+*                                angivet intervall och lgger till dem i angiven
+*                                trningsdatabehllare, p samma stt som
+*                                training_data_load_text. Genom att tolka en fil i p varandra
+*                                fljande intervall kan filen lsas in del fr del, exempelvis
+*                                nr den r fr stor fr att rymmas i minnet. Ifall filen inte
+*                                kan ppnas eller minnet tar slut returneras 1, annars 0.
+*
+*                                - self    : Pekare till trningsdatabehllaren.
+*                                - filepath: Filskvg som trningsdatan skall lsas frn.
+*                                - begin   : Position i filen dr intervallet brjar, i byte.
+*                                - end     : Position direkt efter intervallet, i byte.
+**************************************************************************************************/
+int training_data_load_text_range(struct training_data* self,
+                                  const char* filepath,
+                                  const uint64_t begin,
+                                  const uint64_t end)
+{
+   struct text_chunk chunk;
+   int error = 0;
+
+   memset(&chunk, 0, sizeof(chunk));
+   chunk.filepath = filepath;
+   chunk.begin = begin;
+   chunk.end = end;
+   chunk.num_inputs = self->num_inputs;
+   chunk.num_outputs = self->num_outputs;
+
+   if (text_chunk_run(&chunk))
+   {
+      fprintf(stderr, "Could not read file at path %s!\n\n", filepath);
+      error = 1;
+   }
+   else
+   {
+      error = training_data_append_rows(self, &chunk.rows);
+   }
+
+   if (chunk.num_skipped)
+   {
+      fprintf(stderr, "Could not extract %zu datapoints out of %zu lines!\n\n", 
+              self->num_inputs + self->num_outputs, chunk.num_skipped);
+   }
+
+   text_rows_delete(&chunk.rows);
+   return error;
+}
+
+/**************************************************************************************************
+* training_data_set: Erstter trningsdatan i angiven trningsdatabehllare med data lagrat i var
+*                    sin tvdimensionella vektor. Raderna konverteras till ntverkets flyttalstyp
+*                    ann_real och kopieras till behllarens matriser, dr rader med frre element
+*                    n antalet in- respektive utsignaler fylls ut med nollor. Ifall minnet tar
+*                    slut lmnas behllaren tom.
 * 
 *                    - self     : Pekare till trningsdatabehllaren.
 *                    - train_in : Pekare till vektor innehllande trningsuppsttningarnas indata.
@@ -132,42 +427,371 @@ void training_data_set(struct training_data* self,
                        const struct double_2d_vector* train_in, 
                        const struct double_2d_vector* train_out)
 {
+   const size_t num_sets = train_in->size < train_out->size ? train_in->size : train_out->size;
    training_data_clear(self);
-   self->sets = train_in->size;
+   if (training_data_reserve(self, num_sets)) return;
 
-   double_2d_vector_resize(&self->in, self->sets);
-   double_2d_vector_resize(&self->out, self->sets);
-   uint_vector_resize(&self->order, self->sets);
+   for (size_t i = 0; i < num_sets; ++i)
+   {
+      const struct double_vector* in = &train_in->data[i];
+      const struct double_vector* out = &train_out->data[i];
+      copy_row(self->in + i * self->num_inputs, in->data, self->num_inputs, in->size);
+      copy_row(self->out + i * self->num_outputs, out->data, self->num_outputs, out->size);
+   }
 
-   self->in = *train_in;
-   self->out = *train_out;
+   fill_order(self, 0, num_sets);
+   self->sets = num_sets;
+   return;
+}
 
-   for (size_t i = 0; i < self->sets; ++i)
+/**************************************************************************************************
+* training_data_append: Lgger till angivet antal trningsuppsttningar, lagrade radvis i tv
+*                       matriser med num_inputs respektive num_outputs flyttal av typen ann_real
+*                       per rad, till slutet av angiven trningsdatabehllare. Ifall kapaciteten
+*                       inte rcker frdubblas den, s att upprepade tillgg kostar amorterat
+*                       konstant tid per uppsttning. Vid misslyckad minnesallokering, eller ifall
+*                       behllaren innehller glesa uppsttningar, returneras 1 och befintlig
+*                       trningsdata lmnas orrd, annars 0.
+*
+*                       - self    : Pekare till trningsdatabehllaren.
+*                       - in      : Pekare till matrisen med indata.
+*                       - out     : Pekare till matrisen med utdata.
+*                       - num_sets: Antalet trningsuppsttningar som skall lggas till.
+**************************************************************************************************/
+int training_data_append(struct training_data* self,
+                         const ann_real* in,
+                         const ann_real* out,
+                         const size_t num_sets)
+{
+   const size_t doubled = 2 * self->capacity;
+   const size_t required = self->sets + num_sets;
+   if (self->offsets) return 1;
+   if (!num_sets) return 0;
+
+   if (required > self->capacity && 
+       training_data_reserve(self, required > doubled ? required : doubled))
    {
-      self->order.data[i] = i;
+      return 1;
    }
-   return;
+
+   memcpy(self->in + self->sets * self->num_inputs, in, 
+          sizeof(ann_real) * num_sets * self->num_inputs);
+   memcpy(self->out + self->sets * self->num_outputs, out, 
+          sizeof(ann_real) * num_sets * self->num_outputs);
+   fill_order(self, self->sets, self->sets + num_sets);
+   self->sets += num_sets;
+   return 0;
+}
+
+/**************************************************************************************************
+* training_data_append_sparse: Lgger till en trningsuppsttning med gles indata till slutet av
+*                              angiven trningsdatabehllare. Indatans element skilda frn noll
+*                              kopieras till behllarens CSR-flt, medan utdatan konverteras till
+*                              ann_real och lagras ttt som vanligt. Den frsta glesa
+*                              uppsttningen i en tom behllare gr behllaren gles. Ifall
+*                              behllaren redan innehller tta uppsttningar, ifall ett index inte
+*                              understiger antalet insignaler eller vid misslyckad
+*                              minnesallokering returneras 1 och befintlig trningsdata lmnas
+*                              orrd, annars 0.
+*
+*                              - self  : Pekare till trningsdatabehllaren.
+*                              - input : Pekare till den glesa vektorn med indata.
+*                              - output: Pekare till flt med num_outputs flyttal utdata.
+**************************************************************************************************/
+int training_data_append_sparse(struct training_data* self,
+                                const struct sparse_vector* input,
+                                const double* output)
+{
+   const size_t doubled = 2 * self->capacity;
+   size_t begin = 0;
+
+   for (size_t i = 0; i < input->size; ++i)
+   {
+      if (input->indices[i] >= self->num_inputs) return 1;
+   }
+
+   if (start_sparse(self)) return 1;
+
+   if (self->sets == self->capacity &&
+       training_data_reserve(self, doubled ? doubled : 1))
+   {
+      return 1;
+   }
+
+   begin = self->offsets[self->sets];
+   if (reserve_values(self, begin + input->size)) return 1;
+
+   if (input->size)
+   {
+      memcpy(self->indices + begin, input->indices, sizeof(uint32_t) * input->size);
+      memcpy(self->values + begin, input->values, sizeof(double) * input->size);
+   }
+
+   copy_row(self->out + self->sets * self->num_outputs, output, self->num_outputs,
+            self->num_outputs);
+   self->offsets[self->sets + 1] = begin + input->size;
+   self->num_values = begin + input->size;
+   fill_order(self, self->sets, self->sets + 1);
+   self->sets++;
+   return 0;
+}
+
+/**************************************************************************************************
+* training_data_reserve: Reserverar minne fr minst angivet antal trningsuppsttningar i angiven
+*                        trningsdatabehllare, s att uppsttningar kan lggas till utan
+*                        omallokering. Ifall matriserna pekar p en mappad fil kopieras de frst
+*                        till heapen, varefter mappningen tas bort. Ordningsfljden lagras med
+*                        32-bitars index s lnge antalet uppsttningar understiger 2^32, annars
+*                        med index av typen size_t. Fr glesa uppsttningar reserveras enbart
+*                        radernas positioner i CSR-flten, vars element reserveras vid tillgg.
+*                        Vid misslyckad minnesallokering returneras 1 och befintlig trningsdata
+*                        lmnas orrd, annars 0.
+*
+*                        - self    : Pekare till trningsdatabehllaren.
+*                        - num_sets: Antalet trningsuppsttningar som minne skall reserveras fr.
+**************************************************************************************************/
+int training_data_reserve(struct training_data* self,
+                          const size_t num_sets)
+{
+   const bool owned = !self->file.data;
+   ann_real* in = 0;
+   ann_real* out = 0;
+
+   if (num_sets <= self->capacity) return 0;
+   if (reserve_order(self, num_sets)) return 1;
+
+   if (self->offsets)
+   {
+      size_t* offsets = (size_t*)realloc(self->offsets, sizeof(size_t) * (num_sets + 1));
+      if (!offsets) return 1;
+      self->offsets = offsets;
+   }
+   else
+   {
+      in = reserve_matrix(self->in, owned, self->sets, num_sets, self->num_inputs);
+      if (!in) return 1;
+      if (owned) self->in = in;
+   }
+
+   out = reserve_matrix(self->out, owned, self->sets, num_sets, self->num_outputs);
+   if (!out)
+   {
+      if (!owned) free(in);
+      return 1;
+   }
+
+   if (!owned) mapped_file_close(&self->file);
+   self->in = in;
+   self->out = out;
+   self->capacity = num_sets;
+   return 0;
+}
+
+/**************************************************************************************************
+* training_data_reset_order: terstller ordningsfljden fr trningsuppsttningarna i angiven
+*                            trningsdatabehllare till den ordning som de lagras i. Minne fr
+*                            ordningsfljden allokeras vid behov. Vid misslyckad minnesallokering
+*                            returneras 1, annars 0.
+*
+*                            - self: Pekare till trningsdatabehllaren.
+**************************************************************************************************/
+int training_data_reset_order(struct training_data* self)
+{
+   if (!self->capacity) return 0;
+   if (!self->order && !self->wide_order && reserve_order(self, self->capacity)) return 1;
+   fill_order(self, 0, self->sets);
+   return 0;
 }
 
 /**************************************************************************************************
 * training_data_shuffle: Randomiserar den inbrdes ordningen p trningsuppsttningarna lagrade
 *                        i angiven trningsdatabehllare via randomisering av deras index.
+*                        Randomiseringen sker enligt Fisher-Yates, dr samtliga ordningsfljder
+*                        r lika sannolika, med behllarens egen slumptalsgenerator. Drmed kan
+*                        behllaren randomiseras frn valfri trd utan att dela tillstnd med
+*                        andra trdar.
 * 
 *                        - self: Pekare till trningsdatabehllaren.
 **************************************************************************************************/
 void training_data_shuffle(struct training_data* self)
 {
-   for (size_t i = 0; i < self->sets; ++i)
+   for (size_t i = self->sets; i > 1; --i)
+   {
+      const size_t r = random_generator_index(&self->generator, i);
+      swap_order(self, i - 1, r);
+   }
+
+   return;
+}
+
+/**************************************************************************************************
+* training_data_index: Returnerar index fr den trningsuppsttning som ligger p angiven
+*                      position i ordningsfljden, allts uppsttningens rad i matriserna.
+*
+*                      - self    : Pekare till trningsdatabehllaren.
+*                      - position: Positionen i ordningsfljden.
+**************************************************************************************************/
+size_t training_data_index(const struct training_data* self,
+                           const size_t position)
+{
+   return self->order ? self->order[position] : self->wide_order[position];
+}
+
+/**************************************************************************************************
+* training_data_gather: Kopierar angivet antal trningsuppsttningar, med brjan p angiven
+*                       position i ordningsfljden, till tv flt lagrade radvis med ntverkets
+*                       flyttalstyp ann_real. Raderna fr uppsttningar som ligger
+*                       TRAINING_DATA_PREFETCH_DISTANCE positioner lngre fram i ordningsfljden
+*                       hmtas i frvg till cacheminnet, s att en slumpmssig ordningsfljd
+*                       inte medfr att varje rad vntar p primrminnet. Glesa rader skrivs
+*                       ut till tta rader, s att samtliga trningsfunktioner kan anvndas.
+*
+*                       - self            : Pekare till trningsdatabehllaren.
+*                       - position        : Position fr den frsta uppsttningen.
+*                       - num_rows        : Antalet uppsttningar som skall kopieras.
+*                       - input           : Pekare till fltet som indatan kopieras till.
+*                       - input_stride    : Avstndet mellan tv rader i fltet fr indata.
+*                       - reference       : Pekare till fltet som utdatan kopieras till.
+*                       - reference_stride: Avstndet mellan tv rader i fltet fr utdata.
+**************************************************************************************************/
+void training_data_gather(const struct training_data* self,
+                          const size_t position,
+                          const size_t num_rows,
+                          ann_real* input,
+                          const size_t input_stride,
+                          ann_real* reference,
+                          const size_t reference_stride)
+{
+   for (size_t i = 0; i < num_rows; ++i)
+   {
+      const size_t k = training_data_index(self, position + i);
+      const size_t ahead = position + i + TRAINING_DATA_PREFETCH_DISTANCE;
+
+      if (ahead < self->sets && !self->offsets)
+      {
+         const size_t next = training_data_index(self, ahead);
+         prefetch_row(self->in + next * self->num_inputs, sizeof(ann_real) * self->num_inputs);
+         prefetch_row(self->out + next * self->num_outputs, 
+                      sizeof(ann_real) * self->num_outputs);
+      }
+
+      if (self->offsets)
+      {
+         const size_t begin = self->offsets[k];
+         scatter_row(input + i * input_stride, self->num_inputs, self->indices + begin,
+                     self->values + begin, self->offsets[k + 1] - begin);
+      }
+      else
+      {
+         memcpy(input + i * input_stride, self->in + k * self->num_inputs, 
+                sizeof(ann_real) * self->num_inputs);
+      }
+      memcpy(reference + i * reference_stride, self->out + k * self->num_outputs, 
+             sizeof(ann_real) * self->num_outputs);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* training_data_gather_sparse: Hmtar den glesa indatan fr trningsuppsttningen p angiven
+*                              position i ordningsfljden utan att kopiera den, samt kopierar
+*                              uppsttningens utdata till ett flt med ntverkets flyttalstyp
+*                              ann_real. Den glesa indatan fr uppsttningen som ligger
+*                              TRAINING_DATA_PREFETCH_DISTANCE positioner lngre fram hmtas i
+*                              frvg till cacheminnet. Fr enbart anropas fr glesa behllare.
+*
+*                              - self     : Pekare till trningsdatabehllaren.
+*                              - position : Uppsttningens position i ordningsfljden.
+*                              - indices  : Pekare till pekaren som radens index lagras i.
+*                              - values   : Pekare till pekaren som radens vrden lagras i.
+*                              - size     : Pekare till variabeln som antalet element lagras i.
+*                              - reference: Pekare till fltet som utdatan kopieras till.
+**************************************************************************************************/
+void training_data_gather_sparse(const struct training_data* self,
+                                 const size_t position,
+                                 const uint32_t** indices,
+                                 const double** values,
+                                 size_t* size,
+                                 ann_real* reference)
+{
+   const size_t k = training_data_index(self, position);
+   const size_t ahead = position + TRAINING_DATA_PREFETCH_DISTANCE;
+
+   if (ahead < self->sets)
    {
-      const size_t r = (size_t)(rand() % self->sets);
-      const size_t temp = self->order.data[i];
-      self->order.data[i] = self->order.data[r];
-      self->order.data[r] = temp;
+      const size_t next = training_data_index(self, ahead);
+      const size_t next_begin = self->offsets[next];
+      const size_t next_size = self->offsets[next + 1] - next_begin;
+      prefetch_row(self->values + next_begin, sizeof(double) * next_size);
+      TRAINING_DATA_PREFETCH(self->indices + next_begin);
+      prefetch_row(self->out + next * self->num_outputs, sizeof(ann_real) * self->num_outputs);
    }
 
+   *indices = self->indices + self->offsets[k];
+   *values = self->values + self->offsets[k];
+   *size = self->offsets[k + 1] - self->offsets[k];
+   memcpy(reference, self->out + k * self->num_outputs, sizeof(ann_real) * self->num_outputs);
    return;
 }
 
+/**************************************************************************************************
+* training_data_is_sparse: Indikerar ifall angiven trningsdatabehllare lagrar gles indata.
+*
+*                          - self: Pekare till trningsdatabehllaren.
+**************************************************************************************************/
+bool training_data_is_sparse(const struct training_data* self)
+{
+   return self->offsets != 0;
+}
+
+/**************************************************************************************************
+* training_data_get_inputs: Kopierar indatan fr samtliga trningsuppsttningar, i den ordning
+*                           som de lagras, till slutet av angiven tvdimensionell vektor, exempelvis
+*                           fr prediktion via ann_predict_range. Vid misslyckad
+*                           minnesallokering returneras 1, annars 0.
+*
+*                           - self  : Pekare till trningsdatabehllaren.
+*                           - inputs: Pekare till vektorn som indatan skall kopieras till.
+**************************************************************************************************/
+int training_data_get_inputs(const struct training_data* self,
+                             struct double_2d_vector* inputs)
+{
+   if (double_2d_vector_reserve(inputs, inputs->size + self->sets)) return 1;
+
+   for (size_t i = 0; i < self->sets; ++i)
+   {
+      struct double_vector row;
+      double_vector_new(&row);
+
+      if (double_vector_resize(&row, self->num_inputs))
+      {
+         double_vector_delete(&row);
+         return 1;
+      }
+
+      if (self->offsets)
+      {
+         memset(row.data, 0, sizeof(double) * self->num_inputs);
+
+         for (size_t j = self->offsets[i]; j < self->offsets[i + 1]; ++j)
+         {
+            row.data[self->indices[j]] += self->values[j];
+         }
+      }
+      else
+      {
+         const ann_real* in = self->in + i * self->num_inputs;
+
+         for (size_t j = 0; j < self->num_inputs; ++j)
+         {
+            row.data[j] = in[j];
+         }
+      }
+      double_2d_vector_push(inputs, &row);
+   }
+   return 0;
+}
+
 /**************************************************************************************************
 * training_data_print: Skriver ut trningsuppsttningar lagrade i angiven trningsdatabehllare
 *                      via angiven utstrm, dr standardutenheten stdout anvnds som default fr
@@ -196,10 +820,20 @@ void training_data_print(const struct training_data* self,
       {
          fprintf(ostream, "Set %zu\n", i + 1);
          fprintf(ostream, "Inputs: ");
-         print_line(self->in.data[i].data, self->num_inputs, ostream);
+
+         if (self->offsets)
+         {
+            const size_t begin = self->offsets[i];
+            print_sparse_line(self->indices + begin, self->values + begin,
+                              self->offsets[i + 1] - begin, ostream);
+         }
+         else
+         {
+            print_line(self->in + i * self->num_inputs, self->num_inputs, ostream);
+         }
 
          fprintf(ostream, "Outputs: ");
-         print_line(self->out.data[i].data, self->num_outputs, ostream);
+         print_line(self->out + i * self->num_outputs, self->num_outputs, ostream);
          if (i < self->sets - 1) fprintf(ostream, "\n");
       }
    }
@@ -209,80 +843,690 @@ void training_data_print(const struct training_data* self,
 }
 
 /**************************************************************************************************
-* training_data_extract: Extraherar trningsdata ur ett textstycke och lagrar i angiven
-*                        trningsdatabehllare ifall angivet datapunkter verensstmmer med 
-*                        antalet noder i ingngslagret samt utgngslagret p tillhrande neuralt
-*                        ntverk. OBS! Se till att textfilen avslutas med en blank rad, annars 
-*                        sker inte inlsning av sista raden.
-* 
-*                        - self: Pekare till trningsdatabehllaren.
-*                        - s   : Pekare till det textstycke som trningsdata skall extraheras ur.
+* reserve_order: Allokerar minne fr ordningsfljden i angiven trningsdatabehllare, s att den
+*                rymmer angivet antal index. Ifall antalet understiger 2^32 anvnds 32-bitars
+*                index, annars index av typen size_t, varvid befintliga 32-bitars index
+*                konverteras. Vid misslyckad minnesallokering returneras 1 och befintlig
+*                ordningsfljd lmnas orrd, annars 0.
+*
+*                - self    : Pekare till trningsdatabehllaren.
+*                - capacity: Antalet index som ordningsfljden skall rymma.
 **************************************************************************************************/
-static void training_data_extract(struct training_data* self, 
-                                  const char* s)
+static int reserve_order(struct training_data* self,
+                         const size_t capacity)
 {
-   char num_str[20] = { '\0 ' };
-   struct double_vector v = { .data = 0, .size = 0 };
-   size_t index = 0;
-   const size_t datapoints = self->num_inputs + self->num_outputs;
+   if ((uint64_t)capacity <= UINT32_MAX && !self->wide_order)
+   {
+      uint32_t* order = (uint32_t*)realloc(self->order, sizeof(uint32_t) * capacity);
+      if (!order) return 1;
+      self->order = order;
+   }
+   else
+   {
+      size_t* wide_order = (size_t*)realloc(self->wide_order, sizeof(size_t) * capacity);
+      if (!wide_order) return 1;
+
+      for (size_t i = 0; self->order && i < self->sets; ++i)
+      {
+         wide_order[i] = self->order[i];
+      }
 
-   for (const char* i = s; *i; ++i)
+      free(self->order);
+      self->order = 0;
+      self->wide_order = wide_order;
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* fill_order: Tilldelar positionerna i angivet intervall av ordningsfljden index fr
+*             motsvarande rader, allts den ordning som uppsttningarna lagras i.
+*
+*             - self : Pekare till trningsdatabehllaren.
+*             - begin: Intervallets frsta position.
+*             - end  : Positionen direkt efter intervallets sista position.
+**************************************************************************************************/
+static void fill_order(struct training_data* self,
+                       const size_t begin,
+                       const size_t end)
+{
+   for (size_t i = begin; i < end; ++i)
    {
-      if (is_digit(*i) || (i == s && *i == '-'))
+      if (self->order) self->order[i] = (uint32_t)i;
+      else self->wide_order[i] = i;
+   }
+   return;
+}
+
+/**************************************************************************************************
+* swap_order: Byter plats p tv index i ordningsfljden fr angiven trningsdatabehllare.
+*
+*             - self: Pekare till trningsdatabehllaren.
+*             - i   : Position fr det frsta indexet.
+*             - j   : Position fr det andra indexet.
+**************************************************************************************************/
+static void swap_order(struct training_data* self,
+                       const size_t i,
+                       const size_t j)
+{
+   if (self->order)
+   {
+      const uint32_t temp = self->order[i];
+      self->order[i] = self->order[j];
+      self->order[j] = temp;
+   }
+   else
+   {
+      const size_t temp = self->wide_order[i];
+      self->wide_order[i] = self->wide_order[j];
+      self->wide_order[j] = temp;
+   }
+   return;
+}
+
+/**************************************************************************************************
+* reserve_matrix: Returnerar en pekare till en matris som rymmer angivet antal rader, dr de
+*                 befintliga raderna behlls. En matris som gs av behllaren omallokeras,
+*                 medan en matris som pekar p en mappad fil kopieras till ett nytt minnesblock
+*                 och lmnas orrd. Vid misslyckad minnesallokering returneras null, varvid
+*                 angiven matris r ofrndrad.
+*
+*                 - matrix     : Pekare till den befintliga matrisen (eller null).
+*                 - owned      : Indikerar ifall matrisen gs av behllaren (allokerad p heapen).
+*                 - num_rows   : Antalet befintliga rader i matrisen.
+*                 - capacity   : Antalet rader som matrisen skall rymma.
+*                 - num_columns: Antalet flyttal per rad.
+**************************************************************************************************/
+static ann_real* reserve_matrix(ann_real* matrix,
+                                const bool owned,
+                                const size_t num_rows,
+                                const size_t capacity,
+                                const size_t num_columns)
+{
+   const size_t size = capacity * num_columns;
+   ann_real* copy = 0;
+
+   if (num_columns && capacity > SIZE_MAX / sizeof(ann_real) / num_columns) return 0;
+   if (owned) return (ann_real*)realloc(matrix, sizeof(ann_real) * (size ? size : 1));
+
+   copy = (ann_real*)malloc(sizeof(ann_real) * (size ? size : 1));
+   if (copy && num_rows && num_columns)
+   {
+      memcpy(copy, matrix, sizeof(ann_real) * num_rows * num_columns);
+   }
+   return copy;
+}
+
+/**************************************************************************************************
+* scatter_row: Skriver ut en gles rad till ett flt av typen ann_real, dr samtliga element som
+*              inte lagras i den glesa raden stts till noll.
+*
+*              - destination: Pekare till fltet som raden skall skrivas till.
+*              - size       : Antalet element i fltet.
+*              - indices    : Pekare till den glesa radens index.
+*              - values     : Pekare till den glesa radens vrden.
+*              - num_values : Antalet element i den glesa raden.
+**************************************************************************************************/
+static void scatter_row(ann_real* destination,
+                        const size_t size,
+                        const uint32_t* indices,
+                        const double* values,
+                        const size_t num_values)
+{
+   memset(destination, 0, sizeof(ann_real) * size);
+
+   for (size_t i = 0; i < num_values; ++i)
+   {
+      destination[indices[i]] += (ann_real)values[i];
+   }
+   return;
+}
+
+/**************************************************************************************************
+* start_sparse: Gr angiven trningsdatabehllare gles, frutsatt att den r tom, genom att
+*               eventuell tt lagring eller mappning tas bort och radernas positioner i
+*               CSR-flten allokeras. Ifall behllaren redan r gles grs ingenting. Ifall
+*               behllaren innehller tta uppsttningar eller vid misslyckad minnesallokering
+*               returneras 1, annars 0.
+*
+*               - self: Pekare till trningsdatabehllaren.
+**************************************************************************************************/
+static int start_sparse(struct training_data* self)
+{
+   if (self->offsets) return 0;
+   if (self->sets) return 1;
+
+   training_data_clear(self);
+   self->offsets = (size_t*)malloc(sizeof(size_t));
+   if (!self->offsets) return 1;
+   self->offsets[0] = 0;
+   return 0;
+}
+
+/**************************************************************************************************
+* reserve_values: Reserverar minne fr minst angivet antal element i CSR-flten fr angiven
+*                 gles trningsdatabehllare. Ifall kapaciteten inte rcker frdubblas den, s
+*                 att upprepade tillgg kostar amorterat konstant tid per element. Vid
+*                 misslyckad minnesallokering returneras 1 och befintliga element lmnas orrda,
+*                 annars 0.
+*
+*                 - self    : Pekare till trningsdatabehllaren.
+*                 - capacity: Antalet element som minne skall reserveras fr.
+**************************************************************************************************/
+static int reserve_values(struct training_data* self,
+                          const size_t capacity)
+{
+   const size_t doubled = 2 * self->value_capacity;
+   const size_t new_capacity = capacity > doubled ? capacity : doubled;
+   uint32_t* indices = 0;
+   double* values = 0;
+   if (capacity <= self->value_capacity) return 0;
+
+   indices = (uint32_t*)realloc(self->indices, sizeof(uint32_t) * new_capacity);
+   if (!indices) return 1;
+   self->indices = indices;
+
+   values = (double*)realloc(self->values, sizeof(double) * new_capacity);
+   if (!values) return 1;
+   self->values = values;
+   self->value_capacity = new_capacity;
+   return 0;
+}
+
+/**************************************************************************************************
+* prefetch_row: Begr att samtliga cacherader som angiven rad upptar hmtas till cacheminnet,
+*               utan att vnta p att hmtningen blir klar. P kompilatorer som saknar std fr
+*               detta ignoreras anropet.
+*
+*               - row : Pekare till radens frsta byte.
+*               - size: Radens storlek i byte.
+**************************************************************************************************/
+static void prefetch_row(const void* row,
+                         const size_t size)
+{
+   const unsigned char* begin = (const unsigned char*)row;
+
+   for (size_t i = 0; i < size; i += ALIGNED_MEMORY_ALIGNMENT)
+   {
+      TRAINING_DATA_PREFETCH(begin + i);
+   }
+   return;
+}
+
+/**************************************************************************************************
+* copy_row: Konverterar flyttal till ntverkets flyttalstyp ann_real och kopierar dem till en
+*           rad i en matris. Ifall kllan innehller frre flyttal n raden fylls resten av raden
+*           ut med nollor.
+*
+*           - destination: Pekare till radens frsta flyttal.
+*           - source     : Pekare till flyttalen som skall kopieras.
+*           - size       : Antalet flyttal i raden.
+*           - source_size: Antalet flyttal i kllan.
+**************************************************************************************************/
+static void copy_row(ann_real* destination,
+                     const double* source,
+                     const size_t size,
+                     const size_t source_size)
+{
+   const size_t num_copied = source_size < size ? source_size : size;
+
+   for (size_t i = 0; i < num_copied; ++i)
+   {
+      destination[i] = (ann_real)source[i];
+   }
+   for (size_t i = num_copied; i < size; ++i)
+   {
+      destination[i] = 0;
+   }
+   return;
+}
+
+/**************************************************************************************************
+* text_chunk_run: Tolkar samtliga rader i angiven del av en textfil till delens radbuffert via
+*                 en egen filstrm. Anvnds som trdfunktion vid flertrdad inlsning.
+*
+*                 - arg: Pekare till delen som skall tolkas.
+**************************************************************************************************/
+static int text_chunk_run(void* arg)
+{
+   struct text_chunk* self = (struct text_chunk*)arg;
+   FILE* fstream = fopen(self->filepath, "rb");
+
+   if (!fstream)
+   {
+      self->error = 1;
+      return 1;
+   }
+
+   self->error = parse_text(&self->rows, fstream, self->begin, self->end, self->num_inputs, 
+                            self->num_outputs, &self->num_skipped);
+   fclose(fstream);
+   return self->error;
+}
+
+/**************************************************************************************************
+* parse_text: Tolkar samtliga rader vars frsta tecken ligger inom angivet intervall i angiven
+*             fil och lgger till dem i angiven radbuffert. Filen lses in i stora block, dr
+*             varje fullstndig rad tolkas direkt i blocket. En rad som strcker sig ver ett
+*             blockslut flyttas till brjan av blocket innan nsta block lses in, och blocket
+*             utkas ifall en enskild rad r lngre n blocket, s raderna kan vara godtyckligt
+*             lnga. Ifall intervallet inte brjar direkt efter en radbrytning hoppas den
+*             pbrjade raden ver, eftersom den tillhr fregende intervall. Vid misslyckad
+*             lsning eller minnesallokering returneras 1, annars 0.
+*
+*             - rows       : Pekare till radbufferten.
+*             - fstream    : Pekare till filstrmmen som lses.
+*             - begin      : Position i filen dr intervallet brjar, rknat i byte.
+*             - end        : Position direkt efter intervallet, rknat i byte.
+*             - num_inputs : Antalet insignaler per rad.
+*             - num_outputs: Antalet utsignaler per rad.
+*             - num_skipped: Pekare till antalet verhoppade rader, som rknas upp vid behov.
+**************************************************************************************************/
+static int parse_text(struct text_rows* rows,
+                      FILE* fstream,
+                      const uint64_t begin,
+                      const uint64_t end,
+                      const size_t num_inputs,
+                      const size_t num_outputs,
+                      size_t* num_skipped)
+{
+   size_t block_size = TRAINING_DATA_BLOCK_SIZE;
+   char* block = (char*)malloc(block_size + 1);
+   uint64_t position = begin ? begin - 1 : 0;
+   size_t used = 0;
+   bool skip_line = begin > 0, first_block = true;
+   int error = !block || seek_file(fstream, position);
+
+   while (!error)
+   {
+      const size_t num_read = fread(block + used, 1, block_size - used, fstream);
+      const char* line = block;
+      const char* newline = 0;
+      char* block_end = block + used + num_read;
+      *block_end = '\0';
+
+      if (first_block)
       {
-         num_str[index++] = *i;
+         const size_t num_rows = rows->size + estimate_rows(block, block_end, 
+                                                            (size_t)(end - begin));
+         text_rows_reserve(rows, num_rows, num_inputs, num_outputs);
+         first_block = false;
       }
-      else
+
+      if (skip_line)
+      {
+         newline = (const char*)memchr(line, '\n', (size_t)(block_end - line));
+         skip_line = !newline;
+         line = newline ? newline + 1 : block_end;
+      }
+
+      while (!error && position + (uint64_t)(line - block) < end && 
+             (newline = (const char*)memchr(line, '\n', (size_t)(block_end - line))))
+      {
+         error = parse_line(rows, line, newline, num_inputs, num_outputs, num_skipped);
+         line = newline + 1;
+      }
+
+      if (error || position + (uint64_t)(line - block) >= end) break;
+      if (!num_read)
       {
-         num_str[index] = '\0';
-         const double number = atof(num_str);
-         double_vector_push(&v, number);
-         index = 0;
+         if (line < block_end)
+         {
+            error = parse_line(rows, line, block_end, num_inputs, num_outputs, num_skipped);
+         }
+         error = error || ferror(fstream);
+         break;
+      }
+
+      used = (size_t)(block_end - line);
+      position += (uint64_t)(line - block);
+      memmove(block, line, used);
+
+      if (used == block_size)
+      {
+         char* copy = (char*)realloc(block, 2 * block_size + 1);
+         error = !copy;
+         if (copy)
+         {
+            block = copy;
+            block_size *= 2;
+         }
       }
    }
 
-   if (v.data && v.size == datapoints)
+   free(block);
+   return error;
+}
+
+/**************************************************************************************************
+* text_rows_reserve: Reserverar minne fr minst angivet antal rader i angiven radbuffert. Vid
+*                    misslyckad minnesallokering returneras 1 och befintliga rader lmnas
+*                    orrda, annars 0.
+*
+*                    - self       : Pekare till radbufferten.
+*                    - capacity   : Antalet rader som minne skall reserveras fr.
+*                    - num_inputs : Antalet insignaler per rad.
+*                    - num_outputs: Antalet utsignaler per rad.
+**************************************************************************************************/
+static int text_rows_reserve(struct text_rows* self,
+                             const size_t capacity,
+                             const size_t num_inputs,
+                             const size_t num_outputs)
+{
+   ann_real* in = 0;
+   ann_real* out = 0;
+   if (capacity <= self->capacity) return 0;
+
+   in = reserve_matrix(self->in, true, self->size, capacity, num_inputs);
+   if (!in) return 1;
+   self->in = in;
+
+   out = reserve_matrix(self->out, true, self->size, capacity, num_outputs);
+   if (!out) return 1;
+   self->out = out;
+   self->capacity = capacity;
+   return 0;
+}
+
+/**************************************************************************************************
+* text_rows_delete: Frigr minnet fr angiven radbuffert.
+*
+*                   - self: Pekare till radbufferten.
+**************************************************************************************************/
+static void text_rows_delete(struct text_rows* self)
+{
+   free(self->in);
+   free(self->out);
+   self->in = 0;
+   self->out = 0;
+   self->size = 0;
+   self->capacity = 0;
+   return;
+}
+
+/**************************************************************************************************
+* training_data_append_rows: Flyttar samtliga rader i angiven radbuffert till slutet av angiven
+*                            trningsdatabehllare, i samma ordning, varefter radbufferten r tom.
+*                            Ifall behllaren r tom vertas buffertens matriser direkt, annars
+*                            kopieras raderna. Vid misslyckad minnesallokering returneras 1 och
+*                            radbufferten lmnas orrd, annars 0.
+*
+*                            - self: Pekare till trningsdatabehllaren.
+*                            - rows: Pekare till radbufferten.
+**************************************************************************************************/
+static int training_data_append_rows(struct training_data* self,
+                                     struct text_rows* rows)
+{
+   const size_t num_rows = rows->size;
+   const size_t num_sets = self->sets + num_rows;
+   if (!num_rows) return 0;
+
+   if (!self->sets && !self->file.data && rows->capacity >= self->capacity)
    {
-      struct double_vector in = { .data = 0, .size = 0 };
-      struct double_vector out = { .data = 0, .size = 0 };
-      double_vector_resize(&in, self->num_inputs);
-      double_vector_resize(&out, self->num_outputs);
+      if (reserve_order(self, rows->capacity)) return 1;
+      free(self->in);
+      free(self->out);
+      self->in = rows->in;
+      self->out = rows->out;
+      self->capacity = rows->capacity;
+      rows->in = 0;
+      rows->out = 0;
+   }
+   else if (training_data_reserve(self, num_sets))
+   {
+      return 1;
+   }
+   else
+   {
+      memcpy(self->in + self->sets * self->num_inputs, rows->in, 
+             sizeof(ann_real) * num_rows * self->num_inputs);
+      memcpy(self->out + self->sets * self->num_outputs, rows->out, 
+             sizeof(ann_real) * num_rows * self->num_outputs);
+   }
+
+   fill_order(self, self->sets, num_sets);
+   self->sets = num_sets;
+   text_rows_delete(rows);
+   return 0;
+}
+
+/**************************************************************************************************
+* estimate_rows: Uppskattar antalet rader i en fil utifrn antalet radbrytningar i filens frsta
+*                block, s att minne fr samtliga rader kan reserveras i frvg.
+*
+*                - begin    : Pekare till brjan av det frsta blocket.
+*                - end      : Pekare direkt efter det frsta blockets sista tecken.
+*                - file_size: Filens storlek i byte (0 om oknd).
+**************************************************************************************************/
+static size_t estimate_rows(const char* begin,
+                            const char* end,
+                            const size_t file_size)
+{
+   const size_t block_size = (size_t)(end - begin);
+   size_t num_lines = 1;
 
-      for (size_t i = 0; i < self->num_inputs; ++i)
+   for (const char* i = begin; (i = (const char*)memchr(i, '\n', (size_t)(end - i))); ++i)
+   {
+      num_lines++;
+   }
+
+   if (!block_size || file_size <= block_size) return num_lines;
+   return (size_t)((double)file_size / block_size * num_lines) + 1;
+}
+
+/**************************************************************************************************
+* parse_line: Tolkar samtliga tal p angiven rad och lgger till raden i angiven radbuffert ifall
+*             antalet tal verensstmmer med antalet in- och utsignaler. Rader som enbart bestr
+*             av skiljetecken ignoreras, medan rader med fel antal tal eller ogiltiga tal rknas
+*             som verhoppade. Vid misslyckad minnesallokering returneras 1, annars 0.
+*
+*             - rows       : Pekare till radbufferten.
+*             - begin      : Pekare till radens frsta tecken.
+*             - end        : Pekare till radbrytningen eller radens slut.
+*             - num_inputs : Antalet insignaler per rad.
+*             - num_outputs: Antalet utsignaler per rad.
+*             - num_skipped: Pekare till antalet verhoppade rader, som rknas upp vid behov.
+**************************************************************************************************/
+static int parse_line(struct text_rows* rows,
+                      const char* begin,
+                      const char* end,
+                      const size_t num_inputs,
+                      const size_t num_outputs,
+                      size_t* num_skipped)
+{
+   const size_t datapoints = num_inputs + num_outputs;
+   ann_real* in = 0;
+   ann_real* out = 0;
+   size_t num_values = 0;
+
+   while (begin < end && is_delimiter(*begin)) ++begin;
+   if (begin == end) return 0;
+
+   if (rows->size == rows->capacity &&
+       text_rows_reserve(rows, rows->capacity ? 2 * rows->capacity : 4, num_inputs, num_outputs))
+   {
+      return 1;
+   }
+
+   in = rows->in + rows->size * num_inputs;
+   out = rows->out + rows->size * num_outputs;
+
+   while (begin < end)
+   {
+      double value = 0;
+      begin = parse_number(begin, end, &value);
+      if (!begin || num_values == datapoints) break;
+
+      if (num_values < num_inputs) in[num_values] = (ann_real)value;
+      else out[num_values - num_inputs] = (ann_real)value;
+      num_values++;
+      while (begin < end && is_delimiter(*begin)) ++begin;
+   }
+
+   if (!begin || begin < end || num_values != datapoints)
+   {
+      (*num_skipped)++;
+      return 0;
+   }
+
+   rows->size++;
+   return 0;
+}
+
+/**************************************************************************************************
+* parse_number: Tolkar ett flyttal med valfritt tecken, decimaldel och exponent (exempelvis
+*               -1.25e-3) i brjan av angiven textstrng. Tal med hgst 19 signifikanta siffror
+*               och en tiopotens som kan representeras exakt berknas direkt, vilket ger ett
+*               korrekt avrundat resultat. vriga tal, exempelvis tal med mnga siffror, stora
+*               exponenter, inf eller nan, tolkas via strtod. Talet mste avslutas av ett
+*               skiljetecken eller radslutet. Returnerar en pekare direkt efter talet, eller
+*               null ifall inget giltigt tal kunde tolkas.
+*
+*               - s    : Pekare till talets frsta tecken.
+*               - end  : Pekare till radens slut, dr tecknet end pekar p inte fr vara en siffra.
+*               - value: Pekare till variabeln som det tolkade talet skall lagras i.
+**************************************************************************************************/
+static const char* parse_number(const char* s,
+                                const char* end,
+                                double* value)
+{
+   static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 
+                                    1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 
+                                    1e20, 1e21, 1e22 };
+   const char* begin = s;
+   char* stop = 0;
+   uint64_t mantissa = 0;
+   int exponent = 0;
+   size_t num_digits = 0;
+   bool negative = false, truncated = false;
+
+   if (s < end && (*s == '-' || *s == '+')) negative = *s++ == '-';
+
+   for (; s < end && is_digit(*s); ++s, ++num_digits)
+   {
+      if (mantissa < UINT64_C(1000000000000000000))
       {
-         in.data[i] = v.data[i];
+         mantissa = mantissa * 10 + (uint64_t)(*s - '0');
       }
-      for (size_t i = 0; i < self->num_outputs; ++i)
+      else
       {
-         out.data[i] = v.data[i + self->num_inputs];
+         exponent++;
+         truncated = true;
       }
+   }
 
-      double_2d_vector_push(&self->in, &in);
-      double_2d_vector_push(&self->out, &out);
-      uint_vector_push(&self->order, self->sets++);
+   if (s < end && *s == '.')
+   {
+      for (++s; s < end && is_digit(*s); ++s, ++num_digits)
+      {
+         if (mantissa < UINT64_C(1000000000000000000)) 
+         {
+            mantissa = mantissa * 10 + (uint64_t)(*s - '0');
+            exponent--;
+         }
+         else truncated = true;
+      }
    }
-   else
+
+   if (num_digits && s < end && (*s == 'e' || *s == 'E'))
+   {
+      const char* t = s + 1;
+      bool negative_exponent = false;
+      int e = 0;
+      if (t < end && (*t == '-' || *t == '+')) negative_exponent = *t++ == '-';
+      if (t < end && is_digit(*t))
+      {
+         for (; t < end && is_digit(*t); ++t)
+         {
+            if (e < 100000) e = e * 10 + (*t - '0');
+         }
+         exponent += negative_exponent ? -e : e;
+         s = t;
+      }
+   }
+
+   if (num_digits && (s == end || is_delimiter(*s)))
    {
-      fprintf(stderr, "Could not extract %zu datapoints out of current line!\n\n", datapoints);
+      if (!mantissa)
+      {
+         *value = negative ? -0.0 : 0.0;
+         return s;
+      }
+      if (!truncated && mantissa <= (UINT64_C(1) << 53) && exponent >= -22 && exponent <= 22)
+      {
+         const double number = exponent < 0 ? (double)mantissa / powers[-exponent] : 
+            (double)mantissa * powers[exponent];
+         *value = negative ? -number : number;
+         return s;
+      }
    }
 
-   double_vector_clear(&v);
-   return;
+   *value = strtod(begin, &stop);
+   if (stop == begin || stop > end || (stop < end && !is_delimiter(*stop))) return 0;
+   return stop;
+}
+
+/**************************************************************************************************
+* get_file_size: Lser av storleken p filen som angiven filstrm r kopplad till, ven fr
+*                filer strre n 2 GB. Filpositionen terstlls till filens brjan. Vid
+*                misslyckande returneras 1, annars 0.
+*
+*                - fstream: Pekare till filstrmmen.
+*                - size   : Pekare till variabeln som filstorleken i byte skall lagras i.
+**************************************************************************************************/
+static int get_file_size(FILE* fstream,
+                         uint64_t* size)
+{
+#if defined(_WIN32)
+   const int64_t position = _fseeki64(fstream, 0, SEEK_END) ? -1 : _ftelli64(fstream);
+#elif defined(__unix__) || defined(__APPLE__)
+   const int64_t position = fseeko(fstream, 0, SEEK_END) ? -1 : (int64_t)ftello(fstream);
+#else
+   const int64_t position = fseek(fstream, 0, SEEK_END) ? -1 : (int64_t)ftell(fstream);
+#endif
+   if (position < 0 || seek_file(fstream, 0)) return 1;
+   *size = (uint64_t)position;
+   return 0;
 }
 
 /**************************************************************************************************
-* is_digit: Indikerar ifall angivet tecken utgr en siffra eller ett decimaltecken (punkt).
+* seek_file: Flyttar filpositionen fr angiven filstrm till angiven position, ven fr filer
+*            strre n 2 GB. Vid misslyckande returneras 1, annars 0.
+*
+*            - fstream : Pekare till filstrmmen.
+*            - position: Den nya filpositionen, rknat i byte frn filens brjan.
+**************************************************************************************************/
+static int seek_file(FILE* fstream,
+                     const uint64_t position)
+{
+#if defined(_WIN32)
+   return _fseeki64(fstream, (int64_t)position, SEEK_SET) != 0;
+#elif defined(__unix__) || defined(__APPLE__)
+   return fseeko(fstream, (off_t)position, SEEK_SET) != 0;
+#else
+   return fseek(fstream, (long)position, SEEK_SET) != 0;
+#endif
+}
+
+/**************************************************************************************************
+* is_digit: Indikerar ifall angivet tecken utgr en siffra.
 * 
 *           - c: Det tecken som skall kontrolleras.
 **************************************************************************************************/
 static bool is_digit(const char c)
 {
-   const char* s = "0123456789.";
-   for (const char* i = s; *i; ++i)
-   {
-      if (c == *i) return true;
-   }
-   return false;
+   return c >= '0' && c <= '9';
+}
+
+/**************************************************************************************************
+* is_delimiter: Indikerar ifall angivet tecken skiljer tv tal t i en textfil, allts utgr ett
+*               blanksteg, en tabb, ett kommatecken, ett semikolon eller en vagnretur.
+* 
+*               - c: Det tecken som skall kontrolleras.
+**************************************************************************************************/
+static bool is_delimiter(const char c)
+{
+   return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r';
 }
 
 /**************************************************************************************************
@@ -291,9 +1535,9 @@ static bool is_digit(const char c)
 *             - self   : Pekare till vektorn innehllande flyttalen som skall skrivas ut.
 *             - ostream: Pekare till angiven utstrm.
 **************************************************************************************************/
-static void print_line(const double* data, const size_t size, FILE* stream)
+static void print_line(const ann_real* data, const size_t size, FILE* stream)
 {
-   for (const double* i = data; i < data + size; ++i)
+   for (const ann_real* i = data; i < data + size; ++i)
    {
       fprintf(stream, "%g ", *i);
    }
@@ -301,3 +1545,26 @@ static void print_line(const double* data, const size_t size, FILE* stream)
    fprintf(stream, "\n");
    return;
 }
+
+/**************************************************************************************************
+* print_sparse_line: Skriver ut index och vrde fr samtliga element i en gles rad p en enda
+*                    rad via angiven utstrm.
+*
+*                    - indices: Pekare till radens index.
+*                    - values : Pekare till radens vrden.
+*                    - size   : Antalet element i raden.
+*                    - ostream: Pekare till angiven utstrm.
+**************************************************************************************************/
+static void print_sparse_line(const uint32_t* indices,
+                              const double* values,
+                              const size_t size,
+                              FILE* ostream)
+{
+   for (size_t i = 0; i < size; ++i)
+   {
+      fprintf(ostream, "%u:%g ", (unsigned int)indices[i], values[i]);
+   }
+
+   fprintf(ostream, "\n");
+   return;
+}
@@ -2,7 +2,17 @@
 * training_data.h: Innehller funktionalitet fr inlsning och lagring av trningsdata till
 *                  neurala ntverk. Trningsdatan kan bde lsas in frn en fil eller via
 *                  tilldelning frn tvdimensionella flt innehllande flyttal. Ordningen p
-*                  trningsdatan kan ocks randomiseras, vilket br gras vid trning.
+*                  trningsdatan kan ocks randomiseras, vilket br gras vid trning. Vid
+*                  inlsning frn en textfil sparas en binr kopia bredvid textfilen, vilken
+*                  minnesmappas i stllet fr att texten tolkas vid efterfljande inlsningar.
+*                  Trningsuppsttningarna lagras radvis i tv sammanhngande matriser, en fr
+*                  indata och en fr utdata, s att trningen lser raderna utan att flja en
+*                  pekare per rad. Matriserna lagras med ntverkets flyttalstyp ann_real, dr talen
+*                  konverteras vid inlsning, s att enkel precision ven halverar trningsdatans
+*                  minnestgng. Alternativt kan indatan lagras glest i CSR-format (compressed
+*                  sparse row), dr enbart element skilda frn noll lagras, vilket lmpar sig fr
+*                  breda insignaler dr nstan samtliga element r noll. En behllare innehller
+*                  antingen enbart tta eller enbart glesa uppsttningar.
 **************************************************************************************************/
 #ifndef TRAINING_DATA_H_
 #define TRAINING_DATA_H_
@@ -10,7 +20,15 @@
 /* Inkluderingsdirektiv: */
 #include "def.h"
 #include "double_2d_vector.h"
-#include "uint_vector.h"
+#include "mapped_file.h"
+#include "random_generator.h"
+#include "sparse_vector.h"
+#include <string.h>
+#include <threads.h>
+
+/* Makrodefinitioner: */
+#define TRAINING_DATA_BLOCK_SIZE        1048576 /* Blockstorlek i byte vid lsning av text. */
+#define TRAINING_DATA_PREFETCH_DISTANCE 8       /* Antal rader som hmtas i frvg. */
 
 /**************************************************************************************************
 * training_data: Strukt fr lagring av trningsuppsttningar samt deras index fr randomisering
@@ -18,12 +36,21 @@
 **************************************************************************************************/
 struct training_data
 {
-   struct double_2d_vector in;  /* Indata. */
-   struct double_2d_vector out; /* Utdata (referensvrden). */
-   struct uint_vector order;    /* Ordningsfljd fr trningsuppsttningarna. */
-   size_t sets;                 /* Antalet trningsuppsttningar. */
-   size_t num_inputs;           /* Antalet insignaler i ntverket. */
-   size_t num_outputs;          /* Antalet utsignaler i ntverket. */
+   ann_real* in;                      /* Indata, lagrad radvis med num_inputs flyttal per rad. */
+   size_t* offsets;                   /* Gles indata: varje rads brjan i indices och values. */
+   uint32_t* indices;                 /* Gles indata: index fr element skilda frn noll. */
+   double* values;                    /* Gles indata: vrden fr element skilda frn noll. */
+   size_t num_values;                 /* Gles indata: antalet lagrade element. */
+   size_t value_capacity;             /* Gles indata: antalet element som det finns minne fr. */
+   ann_real* out;                     /* Utdata (referensvrden), num_outputs flyttal per rad. */
+   uint32_t* order;                   /* Ordning vid frre n 2^32 uppsttningar (annars null). */
+   size_t* wide_order;                /* Ordning vid 2^32 uppsttningar eller fler (annars null). */
+   size_t sets;                       /* Antalet trningsuppsttningar. */
+   size_t capacity;                   /* Antalet uppsttningar som det finns allokerat minne fr. */
+   size_t num_inputs;                 /* Antalet insignaler i ntverket. */
+   size_t num_outputs;                /* Antalet utsignaler i ntverket. */
+   struct mapped_file file;           /* Mappad binr fil som matriserna pekar p (om ngon). */
+   struct random_generator generator; /* Slumptalsgenerator fr randomisering av ordningen. */
 };
 
 /* Externa funktioner: */
@@ -37,10 +64,47 @@ void training_data_ptr_delete(struct training_data** self);
 void training_data_clear(struct training_data* self);
 void training_data_load(struct training_data* self,
                         const char* filepath);
+int training_data_load_text(struct training_data* self,
+                            const char* filepath);
+int training_data_load_text_threaded(struct training_data* self,
+                                     const char* filepath,
+                                     const size_t num_threads);
+int training_data_load_text_range(struct training_data* self,
+                                  const char* filepath,
+                                  const uint64_t begin,
+                                  const uint64_t end);
 void training_data_set(struct training_data* self, 
                        const struct double_2d_vector* train_in, 
                        const struct double_2d_vector* train_out);
+int training_data_append(struct training_data* self,
+                         const ann_real* in,
+                         const ann_real* out,
+                         const size_t num_sets);
+int training_data_append_sparse(struct training_data* self,
+                                const struct sparse_vector* input,
+                                const double* output);
+int training_data_reserve(struct training_data* self,
+                          const size_t num_sets);
+int training_data_reset_order(struct training_data* self);
 void training_data_shuffle(struct training_data* self);
+size_t training_data_index(const struct training_data* self,
+                           const size_t position);
+void training_data_gather(const struct training_data* self,
+                          const size_t position,
+                          const size_t num_rows,
+                          ann_real* input,
+                          const size_t input_stride,
+                          ann_real* reference,
+                          const size_t reference_stride);
+void training_data_gather_sparse(const struct training_data* self,
+                                 const size_t position,
+                                 const uint32_t** indices,
+                                 const double** values,
+                                 size_t* size,
+                                 ann_real* reference);
+bool training_data_is_sparse(const struct training_data* self);
+int training_data_get_inputs(const struct training_data* self,
+                             struct double_2d_vector* inputs);
 void training_data_print(const struct training_data* self, 
                          FILE* ostream);
 
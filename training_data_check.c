@@ -0,0 +1,270 @@
+/**************************************************************************************************
+* training_data_check.c: Fristende kontroll av den blockbaserade tolkningen av textfiler med
+*                        trningsdata, dr varje inlst tal jmfrs bit fr bit med resultatet
+*                        frn strtod. Frst tolkas en fil med utvalda tal, exempelvis exponenter,
+*                        tal som brjar med decimalpunkt, -0 samt mantissor lngre n 2^53, i
+*                        flera filformat (blanksteg, tabbar, CSV, semikolon, CRLF samt en sista
+*                        rad utan radbrytning). Drefter tolkas slumpmssigt genererade rader,
+*                        bde enkeltrdat och frdelat p sju trdar. Koden kompileras endast d
+*                        TRAINING_DATA_CHECK r definierat, s att den inte pverkar vriga
+*                        program som byggs via *.c. Kompilera och kr exempelvis via fljande
+*                        kommandon, dr ett valfritt fr och antal slumpmssiga rader kan passeras
+*                        som argument:
+*                        $ gcc $(ls *.c | grep -v main.c) -o training_data_check -Wall
+*                          -DTRAINING_DATA_CHECK
+*                        $ ./training_data_check [seed] [rows]
+**************************************************************************************************/
+#ifdef TRAINING_DATA_CHECK
+
+#include "training_data.h"
+
+/* Makrodefinitioner: */
+#define NUM_COLUMNS    8                          /* Antalet tal per rad (sju in, ett ut). */
+#define NUM_ROWS       20000                      /* Default-antal slumpmssiga rader. */
+#define NUM_THREADS    7                          /* Antalet trdar vid flertrdad tolkning. */
+#define MAX_TOKEN_SIZE 64                         /* Strsta lngd p ett genererat tal. */
+#define CHECK_FILEPATH "training_data_check.txt"  /* Temporr fil som tolkas. */
+
+/**************************************************************************************************
+* expected_values: Frvntade tal fr samtliga rader, berknade via strtod.
+**************************************************************************************************/
+struct expected_values
+{
+   ann_real* data;  /* Frvntade tal, NUM_COLUMNS per rad. */
+   size_t size;     /* Antalet lagrade tal. */
+   size_t capacity; /* Antalet tal som det finns allokerat minne fr. */
+};
+
+/* Statiska variabler: */
+static const char* const special_numbers[] =
+{
+   "0", "-0", "+0", "0.0", "-0.0", ".5", "-.5", "+.25", "5.", "-5.", "00012", "007.50",
+   "1e0", "1e10", "1E-5", "-2.5e+3", "1e22", "1e23", "1e-22", "1e-23", "2e308", "4e-320",
+   "9007199254740992", "9007199254740993", "9007199254740995", "18446744073709551615",
+   "123456789012345678901234567890", "1.000000000000000000001", "0.1", "0.2", "0.3",
+   "0.30000000000000004", "3.141592653589793238462643383279", "2.2250738585072014e-308",
+   "1.7976931348623157e308", "4.9406564584124654e-324", "0.000000000000000000000000001234",
+   "12345678901234567890e-30", "7.0e-10", "-123.456e7", "1e-400", "1e400", "99999999999999999999"
+};
+
+/* Statiska funktioner: */
+static int check_file(const char* contents,
+                      const struct expected_values* expected,
+                      const size_t num_threads);
+static int expected_values_push(struct expected_values* self,
+                                const char* token);
+static void random_token(char* token,
+                         struct random_generator* generator);
+static const char* random_delimiter(struct random_generator* generator);
+
+/**************************************************************************************************
+* main: Genomfr kontrollen med utvalda tal i flera filformat fljt av kontrollen med
+*       slumpmssiga rader. Vid frsta avvikelse returneras 1, annars 0.
+*
+*       - argc: Antalet argument.
+*       - argv: Argumenten, dr ett eventuellt fr och antal rader passeras.
+**************************************************************************************************/
+int main(int argc, char** argv)
+{
+   static const char* const delimiters[] = { " ", "\t", ",", ", ", ";", " ,\t" };
+   static const char* const newlines[] = { "\n", "\r\n" };
+   const uint64_t seed = argc > 1 ? strtoull(argv[1], 0, 10) : 1;
+   const size_t num_rows = argc > 2 ? (size_t)strtoull(argv[2], 0, 10) : NUM_ROWS;
+   const size_t num_special = sizeof(special_numbers) / sizeof(special_numbers[0]);
+   const size_t line_size = NUM_COLUMNS * (MAX_TOKEN_SIZE + 4) + 2;
+   struct expected_values expected = { 0, 0, 0 };
+   struct random_generator generator;
+   char* contents = 0;
+   size_t length = 0;
+   int error = 0;
+
+   random_generator_new(&generator, seed);
+
+   for (size_t d = 0; d < sizeof(delimiters) / sizeof(delimiters[0]) && !error; ++d)
+   {
+      for (size_t n = 0; n < sizeof(newlines) / sizeof(newlines[0]) && !error; ++n)
+      {
+         const size_t num_lines = (num_special + NUM_COLUMNS - 1) / NUM_COLUMNS;
+         contents = (char*)malloc(num_lines * line_size + 1);
+         if (!contents) return 1;
+         length = 0;
+         expected.size = 0;
+
+         for (size_t i = 0; i < num_lines * NUM_COLUMNS; ++i)
+         {
+            const char* token = special_numbers[i % num_special];
+            const bool last = i + 1 == num_lines * NUM_COLUMNS;
+            length += (size_t)sprintf(contents + length, "%s%s", token,
+                                      (i + 1) % NUM_COLUMNS ? delimiters[d] :
+                                      last && n ? "" : newlines[n]);
+            if (expected_values_push(&expected, token)) error = 1;
+         }
+
+         if (!error && (check_file(contents, &expected, 1) ||
+                        check_file(contents, &expected, NUM_THREADS)))
+         {
+            fprintf(stderr, "training_data_check: avvikelse fr utvalda tal (format %zu, %zu)\n",
+                    d, n);
+            error = 1;
+         }
+         free(contents);
+      }
+   }
+
+   contents = error ? 0 : (char*)malloc(num_rows * line_size + 1);
+   length = 0;
+   expected.size = 0;
+   if (!error && !contents) error = 1;
+
+   for (size_t i = 0; i < num_rows && !error; ++i)
+   {
+      const char* newline = random_generator_index(&generator, 4) ? "\n" : "\r\n";
+
+      for (size_t j = 0; j < NUM_COLUMNS && !error; ++j)
+      {
+         char token[MAX_TOKEN_SIZE];
+         random_token(token, &generator);
+         length += (size_t)sprintf(contents + length, "%s%s", token,
+                                   j + 1 < NUM_COLUMNS ? random_delimiter(&generator) :
+                                   i + 1 < num_rows ? newline : "");
+         if (expected_values_push(&expected, token)) error = 1;
+      }
+   }
+
+   if (!error && (check_file(contents, &expected, 1) ||
+                  check_file(contents, &expected, NUM_THREADS)))
+   {
+      fprintf(stderr, "training_data_check: avvikelse fr slumpmssiga rader (seed %llu)\n",
+              (unsigned long long)seed);
+      error = 1;
+   }
+
+   if (!error)
+   {
+      printf("training_data_check: %zu utvalda och %zu slumpmssiga tal identiska med strtod "
+             "(seed %llu)\n", num_special, num_rows * NUM_COLUMNS, (unsigned long long)seed);
+   }
+
+   free(contents);
+   free(expected.data);
+   remove(CHECK_FILEPATH);
+   return error;
+}
+
+/**************************************************************************************************
+* check_file: Skriver angivet innehll till en temporr fil, tolkar filen med angivet antal
+*             trdar och jmfr samtliga inlsta tal bit fr bit med frvntade tal. Vid
+*             avvikelse, eller ifall filen inte kan skrivas eller tolkas, returneras 1, annars 0.
+*
+*             - contents   : Pekare till filens innehll.
+*             - expected   : Pekare till frvntade tal.
+*             - num_threads: Antalet trdar som filen tolkas med.
+**************************************************************************************************/
+static int check_file(const char* contents,
+                      const struct expected_values* expected,
+                      const size_t num_threads)
+{
+   const size_t num_rows = expected->size / NUM_COLUMNS;
+   struct training_data data;
+   FILE* ostream = fopen(CHECK_FILEPATH, "wb");
+   int error = !ostream;
+
+   if (ostream)
+   {
+      const size_t length = strlen(contents);
+      error = fwrite(contents, 1, length, ostream) != length;
+      error = fclose(ostream) || error;
+   }
+   if (error) return 1;
+
+   training_data_new(&data, NUM_COLUMNS - 1, 1);
+   error = (num_threads > 1 ? training_data_load_text_threaded(&data, CHECK_FILEPATH, num_threads) :
+            training_data_load_text(&data, CHECK_FILEPATH)) || data.sets != num_rows;
+
+   for (size_t i = 0; i < num_rows && !error; ++i)
+   {
+      const ann_real* row = expected->data + i * NUM_COLUMNS;
+
+      if (memcmp(data.in + i * (NUM_COLUMNS - 1), row, sizeof(ann_real) * (NUM_COLUMNS - 1)) ||
+          memcmp(data.out + i, row + NUM_COLUMNS - 1, sizeof(ann_real)))
+      {
+         fprintf(stderr, "training_data_check: rad %zu avviker (%zu trdar)\n", i, num_threads);
+         error = 1;
+      }
+   }
+
+   training_data_delete(&data);
+   return error;
+}
+
+/**************************************************************************************************
+* expected_values_push: Tolkar angivet tal via strtod och lgger till det bland frvntade tal.
+*                       Vid misslyckad minnesallokering returneras 1, annars 0.
+*
+*                       - self : Pekare till frvntade tal.
+*                       - token: Pekare till talet i textform.
+**************************************************************************************************/
+static int expected_values_push(struct expected_values* self,
+                                const char* token)
+{
+   if (self->size == self->capacity)
+   {
+      const size_t capacity = self->capacity ? 2 * self->capacity : 1024;
+      ann_real* data = (ann_real*)realloc(self->data, sizeof(ann_real) * capacity);
+      if (!data) return 1;
+      self->data = data;
+      self->capacity = capacity;
+   }
+
+   self->data[self->size++] = (ann_real)strtod(token, 0);
+   return 0;
+}
+
+/**************************************************************************************************
+* random_token: Genererar ett slumpmssigt tal i textform med valfritt tecken, en heltalsdel
+*               och en decimaldel med totalt 1 - 25 siffror (dr heltalsdelen kan saknas, s att
+*               talet brjar med decimalpunkt) samt en valfri exponent i intervallet [-40, 40].
+*
+*               - token    : Pekare till fltet som talet skrivs till (minst MAX_TOKEN_SIZE tecken).
+*               - generator: Pekare till slumptalsgeneratorn.
+**************************************************************************************************/
+static void random_token(char* token,
+                         struct random_generator* generator)
+{
+   const size_t num_digits = 1 + random_generator_index(generator, 25);
+   const size_t num_integer = random_generator_index(generator, num_digits + 1);
+   const size_t sign = random_generator_index(generator, 4);
+   size_t length = 0;
+
+   if (sign == 1) token[length++] = '-';
+   else if (sign == 2) token[length++] = '+';
+
+   for (size_t i = 0; i < num_digits; ++i)
+   {
+      if (i == num_integer) token[length++] = '.';
+      token[length++] = (char)('0' + random_generator_index(generator, 10));
+   }
+
+   if (!random_generator_index(generator, 3))
+   {
+      const int exponent = (int)random_generator_index(generator, 81) - 40;
+      length += (size_t)sprintf(token + length, "%c%+d",
+                                random_generator_index(generator, 2) ? 'e' : 'E', exponent);
+   }
+
+   token[length] = '\0';
+   return;
+}
+
+/**************************************************************************************************
+* random_delimiter: Returnerar ett slumpmssigt valt skiljetecken mellan tv tal.
+*
+*                   - generator: Pekare till slumptalsgeneratorn.
+**************************************************************************************************/
+static const char* random_delimiter(struct random_generator* generator)
+{
+   static const char* const delimiters[] = { " ", "  ", "\t", ",", ", ", ";", " ; " };
+   return delimiters[random_generator_index(generator, sizeof(delimiters) / sizeof(delimiters[0]))];
+}
+
+#endif /* TRAINING_DATA_CHECK */
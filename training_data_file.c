@@ -0,0 +1,398 @@
+/**************************************************************************************************
+* training_data_file.c: Innehller funktionsdefinitioner som anvnds fr att spara och lsa in
+*                       trningsdata i binrt format.
+**************************************************************************************************/
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L /* Krvs fr st_mtim i struct stat vid kompilering med -std=c11. */
+#endif
+
+#include "training_data_file.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#define TRAINING_DATA_FILE_WIN32
+#elif defined(__unix__) || defined(__APPLE__)
+#include <sys/stat.h>
+#define TRAINING_DATA_FILE_POSIX
+#endif
+
+/* Statiska funktioner: */
+static int training_data_file_write(const struct training_data* self,
+                                    FILE* ostream);
+static int write_matrix(const ann_real* matrix,
+                        const size_t num_rows,
+                        const size_t num_columns,
+                        FILE* ostream);
+static int write_padding(const size_t position,
+                         FILE* ostream);
+static int training_data_file_validate(const struct mapped_file* file,
+                                       const size_t num_inputs,
+                                       const size_t num_outputs);
+static int get_modification_time(const char* filepath,
+                                 uint64_t* time);
+
+static uint64_t round_up(const uint64_t value,
+                         const uint64_t alignment);
+
+/**************************************************************************************************
+* training_data_save: Sparar trningsuppsttningarna i angiven trningsdatabehllare till angiven
+*                     fil i binrt format. Filen skrivs frst till en temporr fil, som sedan
+*                     erstter angiven fil, s att en avbruten skrivning aldrig lmnar en
+*                     halvfrdig fil efter sig. Uppsttningarnas ordningsfljd sparas inte.
+*                     Filformatet lagrar enbart tt indata, s en behllare med gles indata
+*                     sparas inte. Returnerar 0 vid lyckad skrivning, annars 1.
+*
+*                     - self    : Pekare till trningsdatabehllaren.
+*                     - filepath: Pekare till filskvgen som trningsdatan skall sparas till.
+**************************************************************************************************/
+int training_data_save(const struct training_data* self,
+                       const char* filepath)
+{
+   const size_t length = strlen(filepath);
+   char* temporary_path = (char*)malloc(length + 5);
+   FILE* ostream = 0;
+   int error = 0;
+
+   if (training_data_is_sparse(self) || !temporary_path)
+   {
+      free(temporary_path);
+      return 1;
+   }
+
+   memcpy(temporary_path, filepath, length);
+   memcpy(temporary_path + length, ".tmp", 5);
+
+   ostream = fopen(temporary_path, "wb");
+   error = !ostream || training_data_file_write(self, ostream);
+   if (ostream && fclose(ostream)) error = 1;
+
+   if (!error)
+   {
+#ifdef _WIN32
+      remove(filepath);
+#endif
+      error = rename(temporary_path, filepath) != 0;
+   }
+   if (error)
+   {
+      remove(temporary_path);
+   }
+
+   free(temporary_path);
+   return error;
+}
+
+/**************************************************************************************************
+* training_data_map: Minnesmappar angiven binr trningsdatafil och erstter trningsdatan i
+*                    angiven trningsdatabehllare med filens innehll. Behllarens matriser
+*                    pekar direkt p de mappade sidorna, s enbart ordningsfljden allokeras.
+*                    Matriserna fr skrivas till (copy-on-write). Ifall uppsttningar lggs till
+*                    kopieras matriserna frst till heapen, varefter mappningen tas bort.
+*                    Mappningen tas ven bort nr trningsdatan tms. Ifall filen saknas, r
+*                    skadad eller har ett annat antal in- eller utsignaler n behllaren
+*                    returneras 1 och befintlig trningsdata lmnas orrd, annars returneras 0.
+*
+*                    - self    : Pekare till trningsdatabehllaren.
+*                    - filepath: Pekare till filskvgen som trningsdatan skall lsas frn.
+**************************************************************************************************/
+int training_data_map(struct training_data* self,
+                      const char* filepath)
+{
+   const struct training_data_file_header* header = 0;
+   unsigned char* data = 0;
+   struct training_data mapped;
+
+   training_data_new(&mapped, self->num_inputs, self->num_outputs);
+   mapped.generator = self->generator;
+   if (training_data_file_open(&mapped.file, filepath, self->num_inputs, self->num_outputs))
+   {
+      return 1;
+   }
+
+   header = (const struct training_data_file_header*)mapped.file.data;
+   data = (unsigned char*)mapped.file.data;
+   mapped.in = (ann_real*)(data + header->input_offset);
+   mapped.out = (ann_real*)(data + header->output_offset);
+   mapped.sets = (size_t)header->num_sets;
+   mapped.capacity = mapped.sets;
+
+   if (training_data_reset_order(&mapped))
+   {
+      training_data_delete(&mapped);
+      return 1;
+   }
+
+   training_data_clear(self);
+   *self = mapped;
+   return 0;
+}
+
+/**************************************************************************************************
+* training_data_file_open: Minnesmappar angiven binr trningsdatafil utan att kopiera eller
+*                          allokera ngot fr dess innehll. Filens huvud
+*                          (struct training_data_file_header) ligger i brjan av den mappade
+*                          filen och anger var matriserna ligger. Ifall filen saknas, r skadad
+*                          eller har ett annat antal in- eller utsignaler n angivet returneras
+*                          1, varvid ingen fil r mappad, annars 0.
+*
+*                          - file       : Pekare till den mappade filen.
+*                          - filepath   : Pekare till filskvgen.
+*                          - num_inputs : Frvntat antal insignaler.
+*                          - num_outputs: Frvntat antal utsignaler.
+**************************************************************************************************/
+int training_data_file_open(struct mapped_file* file,
+                            const char* filepath,
+                            const size_t num_inputs,
+                            const size_t num_outputs)
+{
+   if (mapped_file_open(file, filepath)) return 1;
+
+   if (training_data_file_validate(file, num_inputs, num_outputs))
+   {
+      mapped_file_close(file);
+      return 1;
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* training_data_convert: Lser in trningsdata frn angiven textfil och sparar den i binrt
+*                        format till angiven mlfil. Returnerar 0 vid lyckad konvertering,
+*                        annars 1.
+*
+*                        - source_path: Pekare till filskvgen fr textfilen.
+*                        - target_path: Pekare till filskvgen fr den binra filen.
+*                        - num_inputs : Antalet insignaler per trningsuppsttning.
+*                        - num_outputs: Antalet utsignaler per trningsuppsttning.
+**************************************************************************************************/
+int training_data_convert(const char* source_path,
+                          const char* target_path,
+                          const size_t num_inputs,
+                          const size_t num_outputs)
+{
+   struct training_data data;
+   int error = 0;
+   training_data_new(&data, num_inputs, num_outputs);
+   error = training_data_load_text(&data, source_path) || training_data_save(&data, target_path);
+   training_data_delete(&data);
+   return error;
+}
+
+/**************************************************************************************************
+* training_data_sidecar_path: Returnerar en heapallokerad filskvg till den cachade binra
+*                             kopian av angiven textfil, vilken utgrs av textfilens skvg
+*                             fljd av TRAINING_DATA_FILE_SUFFIX. Skvgen frigrs via free.
+*                             Vid misslyckad minnesallokering returneras null.
+*
+*                             - filepath: Pekare till textfilens filskvg.
+**************************************************************************************************/
+char* training_data_sidecar_path(const char* filepath)
+{
+   const size_t length = strlen(filepath);
+   const size_t suffix_length = sizeof(TRAINING_DATA_FILE_SUFFIX);
+   char* sidecar_path = (char*)malloc(length + suffix_length);
+   if (!sidecar_path) return 0;
+   memcpy(sidecar_path, filepath, length);
+   memcpy(sidecar_path + length, TRAINING_DATA_FILE_SUFFIX, suffix_length);
+   return sidecar_path;
+}
+
+/**************************************************************************************************
+* training_data_file_is_newer: Indikerar ifall angiven fil existerar och har ndrats senare n,
+*                              eller samtidigt som, angiven referensfil. Ifall referensfilen
+*                              saknas rcker det att filen existerar.
+*
+*                              - filepath      : Pekare till filskvgen som kontrolleras.
+*                              - reference_path: Pekare till filskvgen fr referensfilen.
+**************************************************************************************************/
+bool training_data_file_is_newer(const char* filepath,
+                                 const char* reference_path)
+{
+   uint64_t time = 0, reference_time = 0;
+   if (get_modification_time(filepath, &time)) return false;
+   if (get_modification_time(reference_path, &reference_time)) return true;
+   return time >= reference_time;
+}
+
+/**************************************************************************************************
+* training_data_file_size: Lser av storleken p angiven fil i byte, ven fr filer strre n
+*                          2 GB. Vid misslyckande, exempelvis ifall filen saknas, returneras 1,
+*                          annars 0.
+*
+*                          - filepath: Pekare till filskvgen.
+*                          - size    : Pekare till variabeln som storleken skall lagras i.
+**************************************************************************************************/
+int training_data_file_size(const char* filepath,
+                            uint64_t* size)
+{
+#if defined(TRAINING_DATA_FILE_WIN32)
+   WIN32_FILE_ATTRIBUTE_DATA attributes;
+   if (!GetFileAttributesExA(filepath, GetFileExInfoStandard, &attributes)) return 1;
+   *size = ((uint64_t)attributes.nFileSizeHigh << 32) | attributes.nFileSizeLow;
+   return 0;
+#elif defined(TRAINING_DATA_FILE_POSIX)
+   struct stat status;
+   if (stat(filepath, &status)) return 1;
+   *size = (uint64_t)status.st_size;
+   return 0;
+#else
+   (void)filepath;
+   (void)size;
+   return 1;
+#endif
+}
+
+/**************************************************************************************************
+* training_data_file_write: Skriver huvud, indatamatris samt utdatamatris via angiven utstrm,
+*                           dr varje matris brjar p en position som r justerad mot
+*                           ALIGNED_MEMORY_ALIGNMENT. Returnerar 0 vid lyckad skrivning,
+*                           annars 1.
+*
+*                           - self   : Pekare till trningsdatabehllaren.
+*                           - ostream: Pekare till utstrmmen som trningsdatan skrivs till.
+**************************************************************************************************/
+static int training_data_file_write(const struct training_data* self,
+                                    FILE* ostream)
+{
+   const uint64_t input_size = sizeof(ann_real) * self->sets * self->num_inputs;
+   struct training_data_file_header header;
+   int error = 0;
+
+   memcpy(header.magic, TRAINING_DATA_FILE_MAGIC, sizeof(header.magic));
+   header.version = TRAINING_DATA_FILE_VERSION;
+   header.byte_order = TRAINING_DATA_FILE_BYTE_ORDER;
+   header.real_size = sizeof(ann_real);
+   header.alignment = ALIGNED_MEMORY_ALIGNMENT;
+   header.num_sets = self->sets;
+   header.num_inputs = self->num_inputs;
+   header.num_outputs = self->num_outputs;
+   header.input_offset = round_up(sizeof(header), ALIGNED_MEMORY_ALIGNMENT);
+   header.output_offset = round_up(header.input_offset + input_size, ALIGNED_MEMORY_ALIGNMENT);
+
+   error = fwrite(&header, sizeof(header), 1, ostream) != 1;
+   error = error || write_padding(sizeof(header), ostream);
+   error = error || write_matrix(self->in, self->sets, self->num_inputs, ostream);
+   error = error || write_padding((size_t)(header.input_offset + input_size), ostream);
+   error = error || write_matrix(self->out, self->sets, self->num_outputs, ostream);
+   return error;
+}
+
+/**************************************************************************************************
+* write_matrix: Skriver angiven matris, lagrad radvis utan utfyllnad mellan raderna, via angiven
+*               utstrm. Returnerar 0 vid lyckad skrivning, annars 1.
+*
+*               - matrix     : Pekare till matrisens frsta flyttal.
+*               - num_rows   : Antalet rader i matrisen.
+*               - num_columns: Antalet flyttal per rad.
+*               - ostream    : Pekare till utstrmmen.
+**************************************************************************************************/
+static int write_matrix(const ann_real* matrix,
+                        const size_t num_rows,
+                        const size_t num_columns,
+                        FILE* ostream)
+{
+   const size_t size = num_rows * num_columns;
+   if (!size) return 0;
+   return fwrite(matrix, sizeof(ann_real), size, ostream) != size;
+}
+
+/**************************************************************************************************
+* write_padding: Skriver nollor frn angiven position i filen fram till nsta position som r
+*                justerad mot ALIGNED_MEMORY_ALIGNMENT. Returnerar 0 vid lyckad skrivning,
+*                annars 1.
+*
+*                - position: Aktuell position i filen, rknat i byte.
+*                - ostream : Pekare till utstrmmen.
+**************************************************************************************************/
+static int write_padding(const size_t position,
+                         FILE* ostream)
+{
+   const unsigned char padding[ALIGNED_MEMORY_ALIGNMENT] = { 0 };
+   const size_t num_padding = (size_t)round_up(position, ALIGNED_MEMORY_ALIGNMENT) - position;
+   if (!num_padding) return 0;
+   return fwrite(padding, 1, num_padding, ostream) != num_padding;
+}
+
+/**************************************************************************************************
+* training_data_file_validate: Kontrollerar att angiven mappad fil innehller giltig trningsdata
+*                              med angivet antal in- och utsignaler, allts att huvudet r
+*                              korrekt, att flyttalstyp och byteordning verensstmmer, att
+*                              matriserna r justerade samt att de ryms i filen. Returnerar 0
+*                              fr en giltig fil, annars 1.
+*
+*                              - file       : Pekare till den mappade filen.
+*                              - num_inputs : Frvntat antal insignaler.
+*                              - num_outputs: Frvntat antal utsignaler.
+**************************************************************************************************/
+static int training_data_file_validate(const struct mapped_file* file,
+                                       const size_t num_inputs,
+                                       const size_t num_outputs)
+{
+   const struct training_data_file_header* header =
+      (const struct training_data_file_header*)file->data;
+   const uint64_t max_elements = file->size / sizeof(ann_real);
+
+   if (file->size < sizeof(struct training_data_file_header)) return 1;
+   if (memcmp(header->magic, TRAINING_DATA_FILE_MAGIC, sizeof(header->magic))) return 1;
+   if (header->version != TRAINING_DATA_FILE_VERSION) return 1;
+   if (header->byte_order != TRAINING_DATA_FILE_BYTE_ORDER) return 1;
+   if (header->real_size != sizeof(ann_real)) return 1;
+   if (header->alignment != ALIGNED_MEMORY_ALIGNMENT) return 1;
+   if (header->num_inputs != num_inputs || header->num_outputs != num_outputs) return 1;
+   if (header->input_offset % ALIGNED_MEMORY_ALIGNMENT) return 1;
+   if (header->output_offset % ALIGNED_MEMORY_ALIGNMENT) return 1;
+   if (num_inputs && header->num_sets > max_elements / num_inputs) return 1;
+   if (num_outputs && header->num_sets > max_elements / num_outputs) return 1;
+   if (header->input_offset > file->size || header->output_offset > file->size) return 1;
+   if (sizeof(ann_real) * header->num_sets * num_inputs > file->size - header->input_offset)
+   {
+      return 1;
+   }
+   return sizeof(ann_real) * header->num_sets * num_outputs > file->size - header->output_offset;
+}
+
+/**************************************************************************************************
+* get_modification_time: Lser av tidpunkten d angiven fil senast ndrades, med hgsta
+*                        upplsning som plattformen tillhandahller. Vid misslyckande,
+*                        exempelvis ifall filen saknas, returneras 1, annars 0.
+*
+*                        - filepath: Pekare till filskvgen.
+*                        - time    : Pekare till variabeln som tidpunkten skall lagras i.
+**************************************************************************************************/
+static int get_modification_time(const char* filepath,
+                                 uint64_t* time)
+{
+#if defined(TRAINING_DATA_FILE_WIN32)
+   WIN32_FILE_ATTRIBUTE_DATA attributes;
+   if (!GetFileAttributesExA(filepath, GetFileExInfoStandard, &attributes)) return 1;
+   *time = ((uint64_t)attributes.ftLastWriteTime.dwHighDateTime << 32) |
+      attributes.ftLastWriteTime.dwLowDateTime;
+   return 0;
+#elif defined(TRAINING_DATA_FILE_POSIX)
+   struct stat status;
+   if (stat(filepath, &status)) return 1;
+#if defined(__APPLE__)
+   *time = (uint64_t)status.st_mtimespec.tv_sec * 1000000000 +
+      (uint64_t)status.st_mtimespec.tv_nsec;
+#else
+   *time = (uint64_t)status.st_mtim.tv_sec * 1000000000 + (uint64_t)status.st_mtim.tv_nsec;
+#endif
+   return 0;
+#else
+   (void)filepath;
+   (void)time;
+   return 1;
+#endif
+}
+
+/**************************************************************************************************
+* round_up: Returnerar angivet vrde avrundat uppt till en jmn multipel av angiven justering.
+*
+*           - value    : Vrdet som skall avrundas.
+*           - alignment: Justeringen som vrdet skall avrundas till.
+**************************************************************************************************/
+static uint64_t round_up(const uint64_t value,
+                         const uint64_t alignment)
+{
+   return (value + alignment - 1) / alignment * alignment;
+}
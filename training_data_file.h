@@ -0,0 +1,65 @@
+/**************************************************************************************************
+* training_data_file.h: Innehller funktionalitet fr att spara och lsa in trningsdata i ett
+*                       versionshanterat binrt filformat. Filen bestr av ett huvud fljt av
+*                       tv sammanhngande matriser, en med indata och en med utdata, dr varje
+*                       rad motsvarar en trningsuppsttning. Matriserna lagras med flyttalstypen
+*                       ann_real och justeras mot cacheradsgrnser. Vid inlsning minnesmappas
+*                       filen och trningsdatans matriser pekar direkt p de mappade sidorna,
+*                       vilket medfr att ingen text behver tolkas och att datan lses in frn
+*                       disk frst nr den anvnds.
+**************************************************************************************************/
+#ifndef TRAINING_DATA_FILE_H_
+#define TRAINING_DATA_FILE_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "training_data.h"
+#include "mapped_file.h"
+#include <string.h>
+
+/* Makrodefinitioner: */
+#define TRAINING_DATA_FILE_MAGIC      "ANNTDATA" /* Identifierar filformatet (tta tecken). */
+#define TRAINING_DATA_FILE_VERSION    1          /* Aktuell version av filformatet. */
+#define TRAINING_DATA_FILE_BYTE_ORDER 0x01020304 /* Anvnds fr att upptcka byteordning. */
+#define TRAINING_DATA_FILE_SUFFIX     ".bin"     /* Filndelse fr cachad binr kopia. */
+
+/**************************************************************************************************
+* training_data_file_header: Huvud i brjan av en binr trningsdatafil. Samtliga heltal lagras
+*                            med skrivande vrds byteordning, vilket kontrolleras via fltet
+*                            byte_order vid inlsning. Matriserna lagras radvis utan utfyllnad
+*                            mellan raderna.
+**************************************************************************************************/
+struct training_data_file_header
+{
+   char magic[8];           /* Identifierar filformatet, TRAINING_DATA_FILE_MAGIC. */
+   uint32_t version;        /* Filformatets version. */
+   uint32_t byte_order;     /* TRAINING_DATA_FILE_BYTE_ORDER. */
+   uint32_t real_size;      /* Storleken p flyttalstypen ann_real i byte. */
+   uint32_t alignment;      /* Justering av matriserna i byte. */
+   uint64_t num_sets;       /* Antalet trningsuppsttningar (rader). */
+   uint64_t num_inputs;     /* Antalet insignaler per uppsttning. */
+   uint64_t num_outputs;    /* Antalet utsignaler per uppsttning. */
+   uint64_t input_offset;   /* Indatamatrisens position i filen, rknat i byte. */
+   uint64_t output_offset;  /* Utdatamatrisens position i filen, rknat i byte. */
+};
+
+/* Externa funktioner: */
+int training_data_save(const struct training_data* self,
+                       const char* filepath);
+int training_data_map(struct training_data* self,
+                      const char* filepath);
+int training_data_file_open(struct mapped_file* file,
+                            const char* filepath,
+                            const size_t num_inputs,
+                            const size_t num_outputs);
+int training_data_convert(const char* source_path,
+                          const char* target_path,
+                          const size_t num_inputs,
+                          const size_t num_outputs);
+char* training_data_sidecar_path(const char* filepath);
+bool training_data_file_is_newer(const char* filepath,
+                                 const char* reference_path);
+int training_data_file_size(const char* filepath,
+                            uint64_t* size);
+
+#endif /* TRAINING_DATA_FILE_H_ */
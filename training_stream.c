@@ -0,0 +1,271 @@
+/**************************************************************************************************
+* training_stream.c: Innehller funktionsdefinitioner som anvnds fr strmmande inlsning av
+*                    trningsdata.
+**************************************************************************************************/
+#include "training_stream.h"
+
+/* Statiska funktioner: */
+static int training_stream_fill(struct training_stream* self);
+static int training_stream_open_binary(struct training_stream* self,
+                                       const char* filepath);
+static bool is_binary_file(const char* filepath);
+static void discard_rows(struct mapped_file* file,
+                         const ann_real* rows,
+                         const size_t size);
+
+/**************************************************************************************************
+* training_stream_open: ppnar angiven fil fr strmmande inlsning av trningsdata med angivet
+*                       antal in- och utsignaler. Ifall filen r en binr trningsdatafil, eller
+*                       ifall det bredvid textfilen finns en binr kopia som r nyare n
+*                       textfilen, minnesmappas den binra filen. Annars tolkas textfilen del
+*                       fr del. Minne fr blandningsbufferten allokeras direkt. Ifall filen
+*                       inte kan ppnas, buffertstorleken r noll eller minnet tar slut
+*                       returneras 1, annars 0.
+*
+*                       - self       : Pekare till den strmmande kllan.
+*                       - filepath   : Filskvg som trningsdatan skall lsas frn.
+*                       - num_inputs : Antalet insignaler per uppsttning.
+*                       - num_outputs: Antalet utsignaler per uppsttning.
+*                       - buffer_size: Blandningsbuffertens storlek i antal uppsttningar.
+**************************************************************************************************/
+int training_stream_open(struct training_stream* self,
+                         const char* filepath,
+                         const size_t num_inputs,
+                         const size_t num_outputs,
+                         const size_t buffer_size)
+{
+   char* sidecar_path = 0;
+   const size_t length = strlen(filepath);
+
+   self->filepath = 0;
+   mapped_file_new(&self->file);
+   self->in = 0;
+   self->out = 0;
+   self->position = 0;
+   self->size = 0;
+   self->buffer_size = buffer_size;
+   training_data_new(&self->pool, num_inputs, num_outputs);
+
+   if (!buffer_size || training_data_reserve(&self->pool, buffer_size))
+   {
+      training_stream_close(self);
+      return 1;
+   }
+
+   if (!training_stream_open_binary(self, filepath)) return 0;
+   sidecar_path = training_data_sidecar_path(filepath);
+
+   if (sidecar_path && training_data_file_is_newer(sidecar_path, filepath) &&
+       !training_stream_open_binary(self, sidecar_path))
+   {
+      free(sidecar_path);
+      return 0;
+   }
+
+   free(sidecar_path);
+   self->filepath = (char*)malloc(length + 1);
+
+   if (!self->filepath || training_data_file_size(filepath, &self->size))
+   {
+      fprintf(stderr, "Could not open file at path %s!\n\n", filepath);
+      training_stream_close(self);
+      return 1;
+   }
+
+   memcpy(self->filepath, filepath, length + 1);
+   return 0;
+}
+
+/**************************************************************************************************
+* training_stream_close: Stnger angiven strmmande klla och frigr dess minne.
+*
+*                        - self: Pekare till den strmmande kllan.
+**************************************************************************************************/
+void training_stream_close(struct training_stream* self)
+{
+   free(self->filepath);
+   mapped_file_close(&self->file);
+   training_data_delete(&self->pool);
+   self->filepath = 0;
+   self->in = 0;
+   self->out = 0;
+   self->position = 0;
+   self->size = 0;
+   self->buffer_size = 0;
+   return;
+}
+
+/**************************************************************************************************
+* training_stream_rewind: Spolar tillbaka angiven strmmande klla till filens brjan infr en
+*                         ny epok. Uppsttningar som finns kvar i blandningsbufferten kastas.
+*
+*                         - self: Pekare till den strmmande kllan.
+**************************************************************************************************/
+void training_stream_rewind(struct training_stream* self)
+{
+   self->position = 0;
+   self->pool.sets = 0;
+   return;
+}
+
+/**************************************************************************************************
+* training_stream_read: Plockar ut upp till angivet antal uppsttningar i slumpmssig ordning ur
+*                       blandningsbufferten och kopierar dem till tv flt lagrade radvis med
+*                       ntverkets flyttalstyp ann_real. S fort bufferten r halvtom fylls den
+*                       p med nsta del av filen. Frre uppsttningar n begrt, eller inga
+*                       alls, innebr att epoken r slut. Vid misslyckad lsning eller
+*                       minnesallokering returneras 1, annars 0.
+*
+*                       - self            : Pekare till den strmmande kllan.
+*                       - input           : Pekare till fltet som indatan kopieras till.
+*                       - input_stride    : Avstndet mellan tv rader i fltet fr indata.
+*                       - reference       : Pekare till fltet som utdatan kopieras till.
+*                       - reference_stride: Avstndet mellan tv rader i fltet fr utdata.
+*                       - max_rows        : Maximalt antal uppsttningar som skall kopieras.
+*                       - num_rows        : Pekare till variabeln som antalet kopierade
+*                                           uppsttningar lagras i.
+**************************************************************************************************/
+int training_stream_read(struct training_stream* self,
+                         ann_real* input,
+                         const size_t input_stride,
+                         ann_real* reference,
+                         const size_t reference_stride,
+                         const size_t max_rows,
+                         size_t* num_rows)
+{
+   struct training_data* pool = &self->pool;
+   const size_t num_inputs = pool->num_inputs;
+   const size_t num_outputs = pool->num_outputs;
+   *num_rows = 0;
+
+   while (*num_rows < max_rows)
+   {
+      size_t r = 0, last = 0;
+
+      if (pool->sets <= self->buffer_size / 2 && self->position < self->size &&
+          training_stream_fill(self))
+      {
+         return 1;
+      }
+      if (!pool->sets) break;
+
+      r = random_generator_index(&pool->generator, pool->sets);
+      last = pool->sets - 1;
+      memcpy(input + *num_rows * input_stride, pool->in + r * num_inputs,
+             sizeof(ann_real) * num_inputs);
+      memcpy(reference + *num_rows * reference_stride, pool->out + r * num_outputs,
+             sizeof(ann_real) * num_outputs);
+
+      memcpy(pool->in + r * num_inputs, pool->in + last * num_inputs,
+             sizeof(ann_real) * num_inputs);
+      memcpy(pool->out + r * num_outputs, pool->out + last * num_outputs,
+             sizeof(ann_real) * num_outputs);
+      pool->sets--;
+      (*num_rows)++;
+   }
+   return 0;
+}
+
+/**************************************************************************************************
+* training_stream_fill: Lser in nsta del av filen till blandningsbufferten. Frn en binr fil
+*                       kopieras s mnga rader att bufferten blir full, varefter de kopierade
+*                       radernas sidor frigrs, s att den mappade filen inte vxer i minnet.
+*                       Frn en textfil tolkas nsta TRAINING_STREAM_CHUNK_SIZE byte. Vid
+*                       misslyckad lsning eller minnesallokering returneras 1, annars 0.
+*
+*                       - self: Pekare till den strmmande kllan.
+**************************************************************************************************/
+static int training_stream_fill(struct training_stream* self)
+{
+   struct training_data* pool = &self->pool;
+
+   if (!self->filepath)
+   {
+      const uint64_t remaining = self->size - self->position;
+      const size_t space = self->buffer_size - pool->sets;
+      const size_t num_sets = remaining < space ? (size_t)remaining : space;
+      const ann_real* in = self->in + self->position * pool->num_inputs;
+      const ann_real* out = self->out + self->position * pool->num_outputs;
+      const int error = training_data_append(pool, in, out, num_sets);
+
+      discard_rows(&self->file, in, sizeof(ann_real) * num_sets * pool->num_inputs);
+      discard_rows(&self->file, out, sizeof(ann_real) * num_sets * pool->num_outputs);
+      self->position += num_sets;
+      return error;
+   }
+   else
+   {
+      const uint64_t begin = self->position;
+      const uint64_t remaining = self->size - self->position;
+      self->position += remaining < TRAINING_STREAM_CHUNK_SIZE ?
+         remaining : TRAINING_STREAM_CHUNK_SIZE;
+      return training_data_load_text_range(pool, self->filepath, begin, self->position);
+   }
+}
+
+/**************************************************************************************************
+* training_stream_open_binary: Minnesmappar angiven binr trningsdatafil som klla, frutsatt
+*                              att filen brjar med filformatets identifierare och har rtt
+*                              antal in- och utsignaler. Vid misslyckande returneras 1,
+*                              annars 0.
+*
+*                              - self    : Pekare till den strmmande kllan.
+*                              - filepath: Pekare till filskvgen.
+**************************************************************************************************/
+static int training_stream_open_binary(struct training_stream* self,
+                                       const char* filepath)
+{
+   const struct training_data_file_header* header = 0;
+   const unsigned char* data = 0;
+
+   if (!is_binary_file(filepath) ||
+       training_data_file_open(&self->file, filepath, self->pool.num_inputs,
+                               self->pool.num_outputs))
+   {
+      return 1;
+   }
+
+   header = (const struct training_data_file_header*)self->file.data;
+   data = (const unsigned char*)self->file.data;
+   self->in = (const ann_real*)(data + header->input_offset);
+   self->out = (const ann_real*)(data + header->output_offset);
+   self->size = header->num_sets;
+   return 0;
+}
+
+/**************************************************************************************************
+* is_binary_file: Indikerar ifall angiven fil brjar med identifieraren fr binra
+*                 trningsdatafiler. Enbart filens frsta byte lses, s att en stor textfil
+*                 aldrig lses in i ondan.
+*
+*                 - filepath: Pekare till filskvgen.
+**************************************************************************************************/
+static bool is_binary_file(const char* filepath)
+{
+   char magic[sizeof(TRAINING_DATA_FILE_MAGIC) - 1];
+   FILE* fstream = fopen(filepath, "rb");
+   bool binary = false;
+   if (!fstream) return false;
+
+   binary = fread(magic, 1, sizeof(magic), fstream) == sizeof(magic) &&
+      !memcmp(magic, TRAINING_DATA_FILE_MAGIC, sizeof(magic));
+   fclose(fstream);
+   return binary;
+}
+
+/**************************************************************************************************
+* discard_rows: Frigr de fysiska sidorna fr angivna rader i angiven mappad fil, vilka redan
+*               har kopierats till blandningsbufferten.
+*
+*               - file: Pekare till den mappade filen.
+*               - rows: Pekare till radernas frsta flyttal.
+*               - size: Radernas storlek i byte.
+**************************************************************************************************/
+static void discard_rows(struct mapped_file* file,
+                         const ann_real* rows,
+                         const size_t size)
+{
+   const size_t offset = (size_t)((const unsigned char*)rows - (const unsigned char*)file->data);
+   mapped_file_discard(file, offset, size);
+   return;
+}
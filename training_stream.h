@@ -0,0 +1,57 @@
+/**************************************************************************************************
+* training_stream.h: Innehller funktionalitet fr strmmande inlsning av trningsdata som r
+*                    fr stor fr att rymmas i minnet via strukten training_stream samt
+*                    motsvarande externa funktioner. Trningsdatan lses del fr del frn en
+*                    textfil eller en binr trningsdatafil, dr en binr fil minnesmappas och
+*                    lses sekventiellt. Eftersom hela trningsdatan aldrig finns i minnet kan
+*                    ordningen inte randomiseras fullt ut. I stllet anvnds en blandningsbuffert
+*                    av valbar storlek, som fylls p sekventiellt frn filen och frn vilken
+*                    uppsttningar plockas ut i slumpmssig ordning. Ju strre buffert, desto
+*                    bttre blandning, dr en buffert som rymmer hela trningsdatan motsvarar
+*                    en fullstndig randomisering.
+**************************************************************************************************/
+#ifndef TRAINING_STREAM_H_
+#define TRAINING_STREAM_H_
+
+/* Inkluderingsdirektiv: */
+#include "def.h"
+#include "training_data.h"
+#include "training_data_file.h"
+#include "mapped_file.h"
+
+/* Makrodefinitioner: */
+#define TRAINING_STREAM_CHUNK_SIZE 16777216 /* Antalet byte text som tolkas t gngen. */
+
+/**************************************************************************************************
+* training_stream: Strmmande klla fr trningsdata med en blandningsbuffert, som fylls p
+*                  frn filen s fort den r halvtom.
+**************************************************************************************************/
+struct training_stream
+{
+   char* filepath;            /* Filskvg till textfilen (null vid binrt format). */
+   struct mapped_file file;   /* Mappad binr trningsdatafil (vid binrt format). */
+   const ann_real* in;        /* Den mappade filens indatamatris (vid binrt format). */
+   const ann_real* out;       /* Den mappade filens utdatamatris (vid binrt format). */
+   uint64_t position;         /* Nsta rad (binrt format) eller byte (text) som skall lsas. */
+   uint64_t size;             /* Antalet rader (binrt format) eller byte (text) i filen. */
+   struct training_data pool; /* Blandningsbuffert med inlsta uppsttningar. */
+   size_t buffer_size;        /* Blandningsbuffertens storlek i antal uppsttningar. */
+};
+
+/* Externa funktioner: */
+int training_stream_open(struct training_stream* self,
+                         const char* filepath,
+                         const size_t num_inputs,
+                         const size_t num_outputs,
+                         const size_t buffer_size);
+void training_stream_close(struct training_stream* self);
+void training_stream_rewind(struct training_stream* self);
+int training_stream_read(struct training_stream* self,
+                         ann_real* input,
+                         const size_t input_stride,
+                         ann_real* reference,
+                         const size_t reference_stride,
+                         const size_t max_rows,
+                         size_t* num_rows);
+
+#endif /* TRAINING_STREAM_H_ */
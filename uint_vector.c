@@ -13,6 +13,7 @@ void uint_vector_new(struct uint_vector* self)
 {
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    return;
 }
 
@@ -26,6 +27,7 @@ void uint_vector_delete(struct uint_vector* self)
    free(self->data);
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    return;
 }
 
@@ -40,6 +42,7 @@ struct uint_vector* uint_vector_ptr_new(const size_t size)
    if (!self) return 0;
    self->data = 0;
    self->size = 0;
+   self->capacity = 0;
    uint_vector_resize(self, size);
    return self;
 }
@@ -60,57 +63,99 @@ void uint_vector_ptr_delete(struct uint_vector** self)
 }
 
 /**************************************************************************************************
-* uint_vector_resize: ndrar storleken / kapaciteten p angiven vektor via omallokering.
+* uint_vector_resize: ndrar storleken p angiven vektor. Ifall den nya storleken verstiger
+*                     kapaciteten reserveras exakt s mycket minne som behvs, annars behlls
+*                     befintligt minne. Vid misslyckad minnesallokering returneras 1, annars 0.
 *
 *                     - self    : Pekare till vektorn.
-*                     - new_size: Vektorns nya storlek efter omallokeringen.
+*                     - new_size: Den nya storleken.
 **************************************************************************************************/
-int uint_vector_resize(struct uint_vector* self, 
+int uint_vector_resize(struct uint_vector* self,
                        const size_t new_size)
 {
-   size_t* copy = (size_t*)realloc(self->data, sizeof(size_t) * new_size);
-   if (!copy) return 1;
-   self->data = copy;
+   if (uint_vector_reserve(self, new_size)) return 1;
    self->size = new_size;
    return 0;
 }
 
 /**************************************************************************************************
-* uint_vector_push: Lgger till ett nytt element lngst bak i angiven vektor.
+* uint_vector_push: Lgger till ett nytt element lngst bak i angiven vektor. Ifall kapaciteten
+*                   inte rcker frdubblas den, vilket medfr att varje tillgg kostar amorterat
+*                   konstant tid. Vid misslyckad minnesallokering returneras 1, annars 0.
 *
 *                   - self       : Pekare till vektorn.
 *                   - new_element: Det nya element som skall lggas till.
 **************************************************************************************************/
-int uint_vector_push(struct uint_vector* self,  
+int uint_vector_push(struct uint_vector* self,
                      const size_t new_element)
 {
-   size_t* copy = (size_t*)realloc(self->data, sizeof(size_t) * (self->size + 1));
-   if (!copy) return 1;
-   copy[self->size++] = new_element;
-   self->data = copy;
+   if (self->size == self->capacity && 
+       uint_vector_reserve(self, self->capacity ? 2 * self->capacity : 4))
+   {
+      return 1;
+   }
+   self->data[self->size++] = new_element;
    return 0;
 }
 
 /**************************************************************************************************
-* uint_vector_pop: Tar bort ett element lngst bak i angiven vektor, om ett sdant finns.
+* uint_vector_pop: Tar bort det sista elementet i angiven vektor, frutsatt att denna inte r tom.
+*                  Minnet behlls fr efterfljande tillgg och frigrs vid behov via
+*                  uint_vector_shrink_to_fit. Ifall vektorn r tom returneras 1, annars 0.
 *
 *                  - self: Pekare till vektorn.
 **************************************************************************************************/
 int uint_vector_pop(struct uint_vector* self)
 {
-   if (self->size <= 1)
-   {
-      uint_vector_delete(self);
-      return 1;
-   }
-   else
+   if (!self->size) return 1;
+   self->size--;
+   return 0;
+}
+
+/**************************************************************************************************
+* uint_vector_reserve: Reserverar minne fr minst angivet antal element i angiven vektor, utan att
+*                      storleken ndras. Vid misslyckad minnesallokering returneras 1, annars 0.
+*
+*                      - self        : Pekare till vektorn.
+*                      - new_capacity: Antalet element som minne skall reserveras fr.
+**************************************************************************************************/
+int uint_vector_reserve(struct uint_vector* self,
+                        const size_t new_capacity)
+{
+   size_t* copy = 0;
+   if (new_capacity <= self->capacity) return 0;
+   copy = (size_t*)realloc(self->data, sizeof(size_t) * new_capacity);
+   if (!copy) return 1;
+   self->data = copy;
+   self->capacity = new_capacity;
+   return 0;
+}
+
+/**************************************************************************************************
+* uint_vector_shrink_to_fit: Minskar kapaciteten p angiven vektor till aktuell storlek, s att
+*                            oanvnt minne frigrs. Vid misslyckad minnesallokering returneras 1
+*                            och befintligt minne behlls, annars returneras 0.
+*
+*                            - self: Pekare till vektorn.
+**************************************************************************************************/
+int uint_vector_shrink_to_fit(struct uint_vector* self)
+{
+   size_t* copy = 0;
+   if (self->size == self->capacity) return 0;
+
+   if (!self->size)
    {
-      size_t* copy = (size_t*)realloc(self->data, sizeof(size_t) * (self->size - 1));
-      if (!copy) return 1;
-      self->data = copy;
-      self->size--;
+      free(self->data);
+      self->data = 0;
+      self->capacity = 0;
       return 0;
    }
+
+   copy = (size_t*)realloc(self->data, sizeof(size_t) * self->size);
+   if (!copy) return 1;
+   self->data = copy;
+   self->capacity = self->size;
+   return 0;
 }
 
 /**************************************************************************************************
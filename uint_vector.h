@@ -14,8 +14,9 @@
 **************************************************************************************************/
 struct uint_vector
 {
-   size_t* data; /* Pekare till dynamiskt flt fr lagring av osignerade heltal. */
-   size_t size;  /* Vektorns storlek (antalet element i fltet). */
+   size_t* data;    /* Pekare till dynamiskt flt fr lagring av osignerade heltal. */
+   size_t size;     /* Vektorns storlek (antalet element i fltet). */
+   size_t capacity; /* Antalet element som fltet rymmer. */
 };
 
 /* Externa funktioner: */
@@ -28,6 +29,9 @@ int uint_vector_resize(struct uint_vector* self,
 int  uint_vector_push(struct uint_vector* self,
                       const size_t new_element);
 int uint_vector_pop(struct uint_vector* self);
+int uint_vector_reserve(struct uint_vector* self,
+                        const size_t new_capacity);
+int uint_vector_shrink_to_fit(struct uint_vector* self);
 void uint_vector_print(const struct uint_vector* self,
                        FILE* ostream);
 size_t* uint_vector_begin(const struct uint_vector* self);